@@ -0,0 +1,169 @@
+// Host benchmark for TempoTracker (src/tempo_tracker.h)
+//
+// Replays MIDI clock arrival traces and reports, for the regression tracker
+// and for the previous 0.9/0.1 EMA over millis() deltas:
+// - convergence: time until the BPM estimate stays within 0.5 BPM (-1 = never)
+// - steady state: RMS and worst BPM error after convergence
+// - phase: RMS error of the predicted beat time (tracker only)
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++11 -Isrc bench/tempo_tracker_bench.cpp -o tempo_bench
+//   ./tempo_bench                  # built-in synthetic BLE traces
+//   ./tempo_bench trace.txt 120    # recorded trace: one arrival (us) per line, true BPM
+
+#include "tempo_tracker.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+struct Trace {
+  const char* name;
+  std::vector<uint32_t> arrivals;  // Microseconds
+  std::vector<uint32_t> ideal;     // True tick times (empty if unknown)
+  std::vector<float> trueBpm;      // Per tick
+};
+
+// Clock sent at 'bpm', delivered in BLE connection events every intervalUs
+// with a little radio jitter - the bunching the BLE callback actually sees
+static Trace makeBLETrace(const char* name, float bpm1, float bpm2, int switchTick,
+                          int ticks, uint32_t intervalUs, uint32_t jitterUs, unsigned seed) {
+  Trace t;
+  t.name = name;
+  srand(seed);
+  double time = 1000000.0;
+  uint64_t lastEvent = 0;
+  uint32_t lastArrival = 0;
+  for (int i = 0; i < ticks; i++) {
+    float bpm = i < switchTick ? bpm1 : bpm2;
+    uint64_t ideal = (uint64_t)time;
+    uint64_t event = ((ideal / intervalUs) + 1) * intervalUs;  // Next connection event
+    // Ticks sharing a connection event arrive together (one callback)
+    uint32_t arrival = event == lastEvent ? lastArrival
+                                          : (uint32_t)(event + (jitterUs ? rand() % jitterUs : 0));
+    lastEvent = event;
+    lastArrival = arrival;
+    t.ideal.push_back((uint32_t)ideal);  // micros() wraps; the tracker must cope
+    t.arrivals.push_back(arrival);
+    t.trueBpm.push_back(bpm);
+    time += 60000000.0 / (bpm * 24.0);
+  }
+  return t;
+}
+
+struct Result {
+  float convergeMs;  // -1 = never
+  float rmsBpm;
+  float maxBpm;
+  float rmsPhaseUs;
+};
+
+static Result summarize(const Trace& t, const std::vector<float>& est, const std::vector<float>& phaseErr) {
+  Result r = {-1.0f, 0.0f, 0.0f, 0.0f};
+  size_t n = est.size();
+  int segmentStart = 0;  // Convergence is measured from the last tempo change
+  for (size_t i = 1; i < n; i++) {
+    if (t.trueBpm[i] != t.trueBpm[i - 1]) segmentStart = i;
+  }
+  size_t converged = n;
+  for (size_t i = n; i-- > (size_t)segmentStart;) {
+    if (fabs(est[i] - t.trueBpm[i]) > 0.5f) break;
+    converged = i;
+  }
+  if (converged < n) {
+    r.convergeMs = (t.arrivals[converged] - t.arrivals[segmentStart]) / 1000.0f;
+  } else {
+    converged = segmentStart + (n - segmentStart) / 2;  // Never settled: judge the second half
+  }
+  {
+    double sum = 0, psum = 0;
+    int count = 0, pcount = 0;
+    for (size_t i = converged; i < n; i++) {
+      float e = fabs(est[i] - t.trueBpm[i]);
+      sum += e * e;
+      if (e > r.maxBpm) r.maxBpm = e;
+      count++;
+      if (i < phaseErr.size() && !std::isnan(phaseErr[i])) {
+        psum += phaseErr[i] * phaseErr[i];
+        pcount++;
+      }
+    }
+    r.rmsBpm = sqrt(sum / count);
+    r.rmsPhaseUs = pcount ? sqrt(psum / pcount) : 0.0f;
+  }
+  return r;
+}
+
+static void run(const Trace& t) {
+  // Average BLE delay - a constant offset, not a phase error
+  double delay = 0;
+  for (size_t i = 0; i < t.ideal.size(); i++) delay += (int32_t)(t.arrivals[i] - t.ideal[i]);
+  int32_t transportUs = t.ideal.empty() ? 0 : (int32_t)(delay / t.ideal.size());
+  
+  // Regression tracker
+  TempoTracker tracker;
+  std::vector<float> est, phaseErr;
+  for (size_t i = 0; i < t.arrivals.size(); i++) {
+    tracker.addTick(t.arrivals[i]);
+    est.push_back(tracker.bpm());
+    // Where does the tracker put the next beat, versus where it really is?
+    TempoEstimate e = tracker.estimate();
+    size_t beat = ((i / 24) + 1) * 24;
+    if (e.locked && !t.ideal.empty() && beat < t.ideal.size()) {
+      phaseErr.push_back((float)(int32_t)(TempoTracker::predict(e, beat) - t.ideal[beat] - transportUs));
+    } else {
+      phaseErr.push_back(NAN);
+    }
+  }
+  Result reg = summarize(t, est, phaseErr);
+
+  // Previous estimator: EMA of 1/(interval_ms * 24) on millis()
+  std::vector<float> ema;
+  float bpm = 0;
+  unsigned long last = 0;
+  int clockCount = 0;
+  for (size_t i = 0; i < t.arrivals.size(); i++) {
+    unsigned long now = t.arrivals[i] / 1000;
+    if (last > 0 && now > last) {
+      float b = 60000.0f / ((now - last) * 24.0f);
+      bpm = clockCount > 24 ? bpm * 0.9f + b * 0.1f : b;
+    }
+    last = now;
+    clockCount++;
+    ema.push_back(bpm);
+  }
+  Result old = summarize(t, ema, std::vector<float>());
+
+  printf("%-26s regression: converge %6.0f ms  rms %6.3f  max %6.3f BPM  phase rms %5.0f us\n",
+         t.name, reg.convergeMs, reg.rmsBpm, reg.maxBpm, reg.rmsPhaseUs);
+  printf("%-26s legacy EMA: converge %6.0f ms  rms %6.3f  max %6.3f BPM\n",
+         "", old.convergeMs, old.rmsBpm, old.maxBpm);
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 3) {
+    Trace t;
+    t.name = argv[1];
+    FILE* f = fopen(argv[1], "r");
+    if (!f) {
+      perror(argv[1]);
+      return 1;
+    }
+    unsigned long us;
+    while (fscanf(f, "%lu", &us) == 1) {
+      t.arrivals.push_back((uint32_t)us);
+      t.trueBpm.push_back((float)atof(argv[2]));
+    }
+    fclose(f);
+    run(t);
+    return 0;
+  }
+
+  const int ticks = 24 * 10000;  // 10,000 beats
+  run(makeBLETrace("120 BPM, 7.5ms interval", 120, 120, 0, ticks, 7500, 500, 1));
+  run(makeBLETrace("120 BPM, 15ms interval", 120, 120, 0, ticks, 15000, 1500, 2));
+  run(makeBLETrace("97.3 BPM, 30ms interval", 97.3f, 97.3f, 0, ticks, 30000, 2000, 3));
+  run(makeBLETrace("120 -> 140 BPM, 15ms", 120, 140, 24 * 16, 24 * 64, 15000, 1500, 4));
+  run(makeBLETrace("174 -> 87 BPM, 11.25ms", 174, 87, 24 * 16, 24 * 64, 11250, 1000, 5));
+  return 0;
+}
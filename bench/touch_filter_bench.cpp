@@ -0,0 +1,215 @@
+// Host benchmark for TouchFilter (src/touch_filter.h)
+//
+// Replays raw XPT2046 sample traces (one reading per 5ms, as the touch task
+// takes them) and reports, for the filter and for the unfiltered readings:
+// - presses/releases: touches seen (a trace's true count is in its name)
+// - still RMS / max: position error in raw units while the finger rests
+// - drag RMS: position error in raw units while the finger moves
+// plus the velocity given to each press.
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++11 -Isrc bench/touch_filter_bench.cpp -o touch_bench
+//   ./touch_bench               # built-in synthetic traces
+//   ./touch_bench trace.txt     # recorded trace: "x y z" per line (z 0 = no touch)
+
+#include "touch_filter.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+struct Sample {
+  uint16_t x, y, z;
+  float trueX, trueY;  // Where the finger really is (NAN if unknown)
+  bool moving;
+};
+
+struct Trace {
+  const char* name;
+  std::vector<Sample> samples;
+};
+
+static float gauss() {
+  float u = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+  float v = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+  return sqrtf(-2.0f * logf(u)) * cosf(6.2831853f * v);
+}
+
+static void addIdle(Trace& t, int samples) {
+  for (int i = 0; i < samples; i++) t.samples.push_back({0, 0, 0, NAN, NAN, false});
+}
+
+// Finger from (x0,y0) to (x1,y1) over 'samples' readings at pressure z, with
+// panel noise, occasional wild readings and pressure dropouts, then resting
+// at (x1,y1) for holdSamples more
+static void addTouch(Trace& t, float x0, float y0, float x1, float y1, int samples, uint16_t z,
+                     float noise, int outlierEvery, int dropoutEvery, int holdSamples = 0) {
+  for (int i = 0; i < samples + holdSamples; i++) {
+    float f = samples > 1 ? (float)(i < samples ? i : samples - 1) / (samples - 1) : 0.0f;
+    float tx = x0 + (x1 - x0) * f;
+    float ty = y0 + (y1 - y0) * f;
+    float rx = tx + gauss() * noise;
+    float ry = ty + gauss() * noise;
+    uint16_t rz = (uint16_t)(z + gauss() * 60.0f);
+    if (i < 3) rz = (uint16_t)(z * (i + 1) / 4);  // Pressure builds up on contact
+    if (outlierEvery && i % outlierEvery == outlierEvery / 2) {
+      rx += (rand() % 2 ? 1 : -1) * 400.0f;
+      ry += (rand() % 2 ? 1 : -1) * 300.0f;
+    }
+    if (dropoutEvery && i % dropoutEvery == dropoutEvery - 1) rz = 0;
+    if (rz < 400) rz = 0;  // The library reports 0 below its threshold
+    bool moving = (x0 != x1 || y0 != y1) && i < samples;
+    t.samples.push_back({(uint16_t)fmaxf(rx, 0.0f), (uint16_t)fmaxf(ry, 0.0f), rz, tx, ty, moving});
+  }
+}
+
+static std::vector<Trace> syntheticTraces() {
+  std::vector<Trace> traces;
+  srand(7);
+
+  Trace rest = {"rest, noisy (1 touch)", {}};
+  addIdle(rest, 20);
+  addTouch(rest, 2000, 2000, 2000, 2000, 400, 1400, 14.0f, 37, 0);
+  addIdle(rest, 20);
+  traces.push_back(rest);
+
+  Trace drag = {"drag (1 touch)", {}};
+  addIdle(drag, 20);
+  addTouch(drag, 500, 800, 3500, 3000, 200, 1200, 10.0f, 0, 0);
+  addIdle(drag, 20);
+  traces.push_back(drag);
+
+  // A drag that stops and rests: the velocity must die out, not overshoot
+  Trace dragHold = {"drag, then rest (1 touch)", {}};
+  addIdle(dragHold, 20);
+  addTouch(dragHold, 3500, 3000, 1000, 1200, 120, 1200, 10.0f, 0, 0, 200);
+  addIdle(dragHold, 20);
+  traces.push_back(dragHold);
+
+  Trace dropouts = {"rest with dropouts (1 touch)", {}};
+  addIdle(dropouts, 20);
+  addTouch(dropouts, 1500, 2500, 1500, 2500, 300, 900, 10.0f, 0, 23);
+  addIdle(dropouts, 20);
+  traces.push_back(dropouts);
+
+  Trace taps = {"taps, light to hard (5 touches)", {}};
+  const uint16_t pressures[] = {600, 900, 1300, 1700, 2200};
+  for (int i = 0; i < 5; i++) {
+    addIdle(taps, 15);
+    addTouch(taps, 1000.0f + i * 400, 2000, 1000.0f + i * 400, 2000, 8, pressures[i], 10.0f, 0, 0);
+  }
+  addIdle(taps, 15);
+  traces.push_back(taps);
+
+  Trace spikes = {"pressure spikes only (0 touches)", {}};
+  for (int i = 0; i < 20; i++) {
+    addIdle(spikes, 30);
+    spikes.samples.push_back({(uint16_t)(rand() % 4000), (uint16_t)(rand() % 4000), 700, NAN, NAN, false});
+  }
+  addIdle(spikes, 30);
+  traces.push_back(spikes);
+
+  return traces;
+}
+
+static bool loadTrace(const char* path, Trace& t) {
+  FILE* f = fopen(path, "r");
+  if (!f) return false;
+  t.name = path;
+  unsigned x, y, z;
+  while (fscanf(f, "%u %u %u", &x, &y, &z) == 3) {
+    t.samples.push_back({(uint16_t)x, (uint16_t)y, (uint16_t)z, NAN, NAN, false});
+  }
+  fclose(f);
+  return !t.samples.empty();
+}
+
+struct Result {
+  int presses = 0, releases = 0;
+  double stillSq = 0, stillMax = 0, dragSq = 0;
+  int stillN = 0, dragN = 0;
+  std::vector<int> velocities;
+};
+
+static void accumulate(Result& r, const Sample& s, float x, float y) {
+  if (std::isnan(s.trueX)) return;
+  double dx = x - s.trueX, dy = y - s.trueY;
+  double e = sqrt(dx * dx + dy * dy);
+  if (s.moving) {
+    r.dragSq += e * e;
+    r.dragN++;
+  } else {
+    r.stillSq += e * e;
+    r.stillN++;
+    if (e > r.stillMax) r.stillMax = e;
+  }
+}
+
+static Result runFilter(const Trace& t, const TouchFilterConfig& config) {
+  TouchFilter filter(config);
+  Result r;
+  for (const Sample& s : t.samples) {
+    TouchFilterEvent e = filter.update(s.x, s.y, s.z);
+    if (e == FILTER_PRESS) {
+      r.presses++;
+      r.velocities.push_back(filter.velocity());
+    }
+    if (e == FILTER_RELEASE) r.releases++;
+    if (filter.isDown() && s.z) accumulate(r, s, filter.x(), filter.y());
+  }
+  return r;
+}
+
+// What updateTouch() did before the filter: every non-zero reading as is
+static Result runRaw(const Trace& t) {
+  Result r;
+  bool down = false;
+  for (const Sample& s : t.samples) {
+    bool touched = s.z > 0;
+    if (touched && !down) r.presses++;
+    if (!touched && down) r.releases++;
+    down = touched;
+    if (touched) accumulate(r, s, s.x, s.y);
+  }
+  return r;
+}
+
+static void print(const char* label, const Result& r) {
+  printf("  %-9s presses %3d  releases %3d", label, r.presses, r.releases);
+  if (r.stillN) printf("  still RMS %6.1f max %6.1f", sqrt(r.stillSq / r.stillN), r.stillMax);
+  if (r.dragN) printf("  drag RMS %6.1f", sqrt(r.dragSq / r.dragN));
+  if (!r.velocities.empty()) {
+    printf("  velocity");
+    for (int v : r.velocities) printf(" %d", v);
+  }
+  printf("\n");
+}
+
+int main(int argc, char** argv) {
+  std::vector<Trace> traces;
+  if (argc > 1) {
+    Trace t;
+    if (!loadTrace(argv[1], t)) {
+      fprintf(stderr, "Cannot read %s\n", argv[1]);
+      return 1;
+    }
+    traces.push_back(t);
+  } else {
+    traces = syntheticTraces();
+  }
+
+  TouchFilterConfig config;
+  TouchFilterConfig median5 = config;
+  median5.medianSize = 5;
+  TouchFilterConfig noTrend = config;
+  noTrend.trendAlpha = 0;
+
+  for (const Trace& t : traces) {
+    printf("%s (%zu samples)\n", t.name, t.samples.size());
+    print("raw", runRaw(t));
+    print("filter", runFilter(t, config));
+    print("median5", runFilter(t, median5));
+    print("no trend", runFilter(t, noTrend));
+  }
+  return 0;
+}
@@ -0,0 +1,136 @@
+// Host replay of touch recordings (src/touch_recording.h)
+//
+// Reads a recording made on the device (/recordings/<name>.txt, see
+// TouchRecorder), plays its touch events through TouchReplay on a virtual
+// clock into the GestureRecognizer, and prints the gestures they make.
+// Given a second recording - a replay of the first, recorded on the device
+// with /touch?action=replay&name=A&save=B - it compares the MIDI output of the
+// two runs: same messages in the same order, and how far their times moved.
+//
+// Build and run from the repository root:
+//   g++ -O2 -std=c++11 -Isrc bench/touch_replay.cpp -o touch_replay
+//   ./touch_replay A.txt          # gestures of a recording
+//   ./touch_replay A.txt B.txt    # ... and MIDI of B against A
+
+#include "touch_recording.h"
+#include "gesture_recognizer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+struct Recording {
+  std::vector<TouchEvent> touches;
+  std::vector<MIDICapture> midi;
+};
+
+static bool load(const char* path, Recording& r) {
+  FILE* f = fopen(path, "r");
+  if (!f) return false;
+  char line[256];
+  TouchEvent touch;
+  MIDICapture midi;
+  while (fgets(line, sizeof(line), f)) {
+    switch (parseRecordingLine(line, touch, midi)) {
+      case RECORDING_TOUCH: r.touches.push_back(touch); break;
+      case RECORDING_MIDI: r.midi.push_back(midi); break;
+      default: break;
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+static const char* gestureName(GestureType type) {
+  static const char* names[] = {"tap", "double tap", "long press", "drag start", "drag", "drag end", "swipe"};
+  return names[type];
+}
+
+static const char* directionName(SwipeDirection d) {
+  static const char* names[] = {"", "left", "right", "up", "down"};
+  return names[d];
+}
+
+static uint32_t virtualNowUs = 0;
+static int drags = 0;
+
+static void onGesture(const TouchGesture& g) {
+  if (g.type == GESTURE_DRAG) {
+    drags++;  // Summarised at the drag's end
+    return;
+  }
+  printf("%9.3f s  %-10s at %3d,%3d", virtualNowUs / 1e6, gestureName(g.type), g.x, g.y);
+  if (g.type == GESTURE_DRAG_END) printf("  %d moves, %+d,%+d px", drags, g.dx, g.dy);
+  if (g.type == GESTURE_SWIPE) printf("  %s at %d px/s", directionName(g.direction), g.velocity);
+  if (g.type == GESTURE_DRAG_END) drags = 0;
+  printf("\n");
+}
+
+// The same path updateTouch() takes, stepped in 20 ms frames like loop()
+static void replayGestures(const Recording& r) {
+  GestureRecognizer gestures;
+  gestures.setCallback(onGesture);
+  TouchReplay replay;
+  replay.begin(r.touches.data(), r.touches.size(), 0);
+
+  TouchEvent event;
+  for (virtualNowUs = 0; !replay.finished(); virtualNowUs += 20000) {
+    while (replay.next(virtualNowUs, event)) {
+      if (event.type == TOUCH_PRESS) gestures.press(event.x, event.y, event.timestampUs);
+      else if (event.type == TOUCH_RELEASE) gestures.release(event.x, event.y, event.timestampUs);
+      else gestures.move(event.x, event.y, event.timestampUs);
+    }
+    gestures.update(virtualNowUs);
+  }
+}
+
+static int compareMIDI(const Recording& expected, const Recording& actual) {
+  size_t n = expected.midi.size() < actual.midi.size() ? expected.midi.size() : actual.midi.size();
+  double sumUs = 0;
+  int32_t worstUs = 0;
+  for (size_t i = 0; i < n; i++) {
+    const MIDICapture& a = expected.midi[i];
+    const MIDICapture& b = actual.midi[i];
+    bool same = a.length == b.length;
+    for (uint8_t k = 0; same && k < a.length; k++) same = a.bytes[k] == b.bytes[k];
+    if (!same) {
+      printf("MIDI differs at message %zu (%.3f s): %02X %02X %02X, replay sent %02X %02X %02X\n", i,
+             a.timestampUs / 1e6, a.bytes[0], a.bytes[1], a.bytes[2], b.bytes[0], b.bytes[1], b.bytes[2]);
+      return 1;
+    }
+    int32_t offsetUs = (int32_t)(b.timestampUs - a.timestampUs);
+    sumUs += offsetUs < 0 ? -offsetUs : offsetUs;
+    if ((offsetUs < 0 ? -offsetUs : offsetUs) > (worstUs < 0 ? -worstUs : worstUs)) worstUs = offsetUs;
+  }
+  if (expected.midi.size() != actual.midi.size()) {
+    printf("MIDI message count differs: %zu recorded, %zu replayed\n", expected.midi.size(), actual.midi.size());
+    return 1;
+  }
+  printf("MIDI matches: %zu messages, timing offset avg %.2f ms, worst %+.2f ms\n", n,
+         n ? sumUs / n / 1000.0 : 0.0, worstUs / 1000.0);
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s recording.txt [replayed.txt]\n", argv[0]);
+    return 2;
+  }
+
+  Recording recording;
+  if (!load(argv[1], recording)) {
+    fprintf(stderr, "Cannot read %s\n", argv[1]);
+    return 2;
+  }
+  printf("%s: %zu touch events, %zu MIDI messages\n", argv[1], recording.touches.size(), recording.midi.size());
+  replayGestures(recording);
+
+  if (argc > 2) {
+    Recording replayed;
+    if (!load(argv[2], replayed)) {
+      fprintf(stderr, "Cannot read %s\n", argv[2]);
+      return 2;
+    }
+    return compareMIDI(recording, replayed);
+  }
+  return 0;
+}
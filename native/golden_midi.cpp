@@ -0,0 +1,172 @@
+#include "golden_midi.h"
+#include "common_definitions.h"
+#include "midi_utils.h"
+#include "touch_recording.h"
+#include "generator_runtime.h"
+#include "latency_trace.h"
+#include "euclidean_mode.h"
+#include "grids_mode.h"
+#include "tb3po_mode.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#define GOLDEN_HEADER "# CYD-MIDI golden MIDI log v1"
+#define GOLDEN_FRAME_MS 20        // One loop() pass
+#define GOLDEN_PLAY_MS 60000
+#define GOLDEN_TAIL_MS 200        // Last note-offs and the STOP
+
+struct GoldenScenario {
+  const char* name;
+  const char* description;
+  AppMode mode;
+  GeneratorEngine engine;
+  void (*setup)();
+  void (*frame)();
+  void (*halfway)();  // Optional change half way through
+};
+
+static std::vector<std::string> lines;
+static uint32_t originUs = 0;
+
+static void drainCapture() {
+  MIDICapture midi;
+  char line[TOUCH_RECORDING_LINE];
+  while (MIDIThread::popCapture(midi)) {
+    if (midi.bytes[0] == 0xF8) continue;  // A clock every 24th of a beat says nothing new
+    formatMIDILine(line, sizeof(line), midi, originUs);
+    lines.push_back(line);
+  }
+}
+
+static void runFrames(uint32_t ms, void (*frame)()) {
+  for (uint32_t t = 0; t < ms; t += GOLDEN_FRAME_MS) {
+    if (frame) frame();
+    drainCapture();
+    LatencyTrace::update();
+    delay(GOLDEN_FRAME_MS);
+  }
+}
+
+// Each setup starts its engine from the defaults of a fresh boot
+static void setupEuclidean() {
+  euclideanState.engineReady = false;
+  initializeEuclideanMode();
+}
+
+static void setupGrids() {
+  grids.engineReady = false;
+  initializeGridsMode();
+  grids.patternX = 40;
+  grids.patternY = 200;
+  regenerateGridsPattern();
+}
+
+static void setupTB3PO() {
+  tb3po.engineReady = false;
+  initializeTB3POMode();
+  tb3po.lockSeed = true;
+  tb3po.seed = 4242;
+  tb3po.density = 10;
+  regenerateTB3POPattern();
+}
+
+static void slowDown() { setBPM(100); }
+
+static const GoldenScenario scenarios[] = {
+  {"euclidean", "Euclidean engine, default voices, 120 BPM", EUCLIDEAN, ENGINE_EUCLIDEAN,
+   setupEuclidean, handleEuclideanMode, nullptr},
+  {"grids", "Grids engine at (40,200), 120 BPM then 100 BPM half way", GRIDS, ENGINE_GRIDS,
+   setupGrids, handleGridsMode, slowDown},
+  {"tb3po", "TB-3PO engine, seed 4242, density 10, 120 BPM", TB3PO, ENGINE_TB3PO,
+   setupTB3PO, handleTB3POMode, nullptr},
+};
+
+static void play(const GoldenScenario& scenario) {
+  lines.clear();
+  setBPM(120);
+  randomSeed(1);
+  currentMode = scenario.mode;
+  scenario.setup();
+
+  MIDIThread::setCapture(true);
+  originUs = micros();
+  GeneratorRuntime::setPlaying(scenario.engine, true);
+  if (scenario.halfway) {
+    runFrames(GOLDEN_PLAY_MS / 2, scenario.frame);
+    scenario.halfway();
+    runFrames(GOLDEN_PLAY_MS / 2, scenario.frame);
+  } else {
+    runFrames(GOLDEN_PLAY_MS, scenario.frame);
+  }
+  GeneratorRuntime::setPlaying(scenario.engine, false);
+  runFrames(GOLDEN_TAIL_MS, nullptr);
+  MIDIThread::setCapture(false);
+  currentMode = MENU;
+}
+
+static std::string goldenPath(const GoldenScenario& scenario) {
+  const char* dir = getenv("CYD_GOLDEN_DIR");
+  return std::string(dir && *dir ? dir : "native/golden") + "/" + scenario.name + ".txt";
+}
+
+static bool writeGolden(const GoldenScenario& scenario) {
+  FILE* f = fopen(goldenPath(scenario).c_str(), "w");
+  if (!f) return false;
+  fprintf(f, "%s\n# %s, %u ms of virtual time\n", GOLDEN_HEADER, scenario.description,
+          GOLDEN_PLAY_MS + GOLDEN_TAIL_MS);
+  for (const std::string& line : lines) fprintf(f, "%s\n", line.c_str());
+  return fclose(f) == 0;
+}
+
+// Prints the first difference; comments and blank lines are skipped
+static bool matchesGolden(const GoldenScenario& scenario) {
+  FILE* f = fopen(goldenPath(scenario).c_str(), "r");
+  if (!f) {
+    printf("  FAILED: no %s (run with --update-golden to write it)\n", goldenPath(scenario).c_str());
+    return false;
+  }
+  char buffer[TOUCH_RECORDING_LINE * 2];
+  size_t i = 0;
+  bool same = true;
+  while (same && fgets(buffer, sizeof(buffer), f)) {
+    buffer[strcspn(buffer, "\r\n")] = '\0';
+    if (buffer[0] == '#' || buffer[0] == '\0') continue;
+    if (i >= lines.size() || lines[i] != buffer) {
+      printf("  FAILED: event %u: expected \"%s\", got \"%s\"\n", (unsigned)i + 1, buffer,
+             i < lines.size() ? lines[i].c_str() : "(end)");
+      same = false;
+    }
+    i++;
+  }
+  fclose(f);
+  if (same && i != lines.size()) {
+    printf("  FAILED: event %u: expected the end, got \"%s\"\n", (unsigned)i + 1, lines[i].c_str());
+    same = false;
+  }
+  return same;
+}
+
+int runGoldenMIDI(bool update) {
+  int failures = 0;
+  for (const GoldenScenario& scenario : scenarios) {
+    auto start = std::chrono::steady_clock::now();
+    Serial.setMuted(true);
+    play(scenario);
+    Serial.setMuted(false);
+    auto hostMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    printf("  %-10s %5u events, %u ms simulated in %u ms\n", scenario.name, (unsigned)lines.size(),
+           GOLDEN_PLAY_MS + GOLDEN_TAIL_MS, (unsigned)hostMs.count());
+    if (update) {
+      if (!writeGolden(scenario)) {
+        printf("  FAILED: cannot write %s\n", goldenPath(scenario).c_str());
+        failures++;
+      }
+    } else if (!matchesGolden(scenario)) {
+      failures++;
+    }
+  }
+  return failures;
+}
@@ -0,0 +1,19 @@
+#ifndef GOLDEN_MIDI_H
+#define GOLDEN_MIDI_H
+
+// Golden-file MIDI regression runs for the native runner
+// - Each scenario plays one background engine through the transport and the
+//   real MIDI task for a minute of virtual time (nativeUseVirtualTime), with
+//   the mode's handler called every frame as loop() would
+// - Everything the MIDI task sent is captured with its event time and
+//   written in the touch recording format (M lines, touch_recording.h),
+//   times from the start of the scenario; the 0xF8 clocks are left out
+// - The log must match native/golden/<scenario>.txt line for line, so a
+//   changed note, velocity or timestamp fails the run
+// Run after MIDIThread::begin(), with the host in virtual time.
+
+// Returns the number of scenarios that differ from their golden log.
+// update writes the logs instead (after an intended change to the output).
+int runGoldenMIDI(bool update);
+
+#endif // GOLDEN_MIDI_H
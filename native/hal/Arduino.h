@@ -0,0 +1,262 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Host stand-in for the ESP32 Arduino core, enough for src/ to build and run
+// on Linux ([env:native] in platformio.ini). Timing is real (steady clock
+// since start) unless nativeUseVirtualTime() is called, output goes to
+// stdout, pins and radios do nothing.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+
+using std::min;
+using std::max;
+using std::abs;
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define sq(x) ((x) * (x))
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+
+#define IRAM_ATTR
+
+typedef uint8_t byte;
+typedef bool boolean;
+typedef uint16_t word;
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// Switch the host to virtual time, before any task or timer is created.
+// Tasks then take turns (the highest-priority task that can run goes until
+// it blocks) and when every task is blocked the clock jumps straight to the
+// next wake-up or esp_timer deadline. A run is exactly repeatable and takes
+// only the CPU time of the code in it. The clock starts at startUs; the
+// calling thread becomes a task of priority 1, like the Arduino loop task.
+// ESP.getCycleCount() stays real, for timing code under test.
+void nativeUseVirtualTime(uint64_t startUs = 1000000);
+bool nativeVirtualTime();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+
+// Deterministic unless reseeded: a host run repeats exactly
+void randomSeed(unsigned long seed);
+long random(long howbig);
+long random(long howsmall, long howbig);
+uint32_t esp_random();
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+// glibc has strlcpy from 2.38; the BSDs and macOS always had it
+#if defined(__GLIBC__)
+#if !__GLIBC_PREREQ(2, 38)
+#define NATIVE_NEEDS_STRLCPY
+size_t strlcpy(char* dst, const char* src, size_t size);
+#endif
+#endif
+
+class String {
+public:
+  String(const char* s = "") : s(s ? s : "") {}
+  String(const std::string& s) : s(s) {}
+  String(char c) : s(1, c) {}
+  String(int v, unsigned char base = DEC) : s(format((long)v, base)) {}
+  String(unsigned int v, unsigned char base = DEC) : s(formatUnsigned(v, base)) {}
+  String(long v, unsigned char base = DEC) : s(format(v, base)) {}
+  String(unsigned long v, unsigned char base = DEC) : s(formatUnsigned(v, base)) {}
+  String(long long v, unsigned char base = DEC) : s(format((long)v, base)) {}
+  String(unsigned long long v, unsigned char base = DEC) : s(formatUnsigned((unsigned long)v, base)) {}
+  String(float v, unsigned int decimals = 2) : s(formatFloat(v, decimals)) {}
+  String(double v, unsigned int decimals = 2) : s(formatFloat(v, decimals)) {}
+
+  const char* c_str() const { return s.c_str(); }
+  unsigned int length() const { return s.length(); }
+  bool isEmpty() const { return s.empty(); }
+  char charAt(unsigned int i) const { return i < s.size() ? s[i] : 0; }
+  char operator[](unsigned int i) const { return charAt(i); }
+
+  int indexOf(char c, unsigned int from = 0) const { return find(s.find(c, from)); }
+  int indexOf(const String& str, unsigned int from = 0) const { return find(s.find(str.s, from)); }
+  int lastIndexOf(char c) const { return find(s.rfind(c)); }
+  String substring(unsigned int from) const { return from < s.size() ? s.substr(from) : ""; }
+  String substring(unsigned int from, unsigned int to) const {
+    return from < s.size() && to > from ? s.substr(from, to - from) : "";
+  }
+  bool startsWith(const String& p) const { return s.compare(0, p.s.size(), p.s) == 0; }
+  bool endsWith(const String& p) const {
+    return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0;
+  }
+  bool equals(const String& o) const { return s == o.s; }
+  long toInt() const { return atol(s.c_str()); }
+  float toFloat() const { return (float)atof(s.c_str()); }
+  void trim() {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    size_t e = s.find_last_not_of(" \t\r\n");
+    s = b == std::string::npos ? "" : s.substr(b, e - b + 1);
+  }
+  void toUpperCase() { for (char& c : s) c = toupper((unsigned char)c); }
+  void toLowerCase() { for (char& c : s) c = tolower((unsigned char)c); }
+  void replace(const String& from, const String& to) {
+    if (from.s.empty()) return;
+    for (size_t i = 0; (i = s.find(from.s, i)) != std::string::npos; i += to.s.size()) {
+      s.replace(i, from.s.size(), to.s);
+    }
+  }
+
+  String& operator+=(const String& o) { s += o.s; return *this; }
+  String& operator+=(const char* o) { s += o; return *this; }
+  String& operator+=(char c) { s += c; return *this; }
+  bool operator==(const String& o) const { return s == o.s; }
+  bool operator==(const char* o) const { return s == o; }
+  bool operator!=(const String& o) const { return s != o.s; }
+  bool operator<(const String& o) const { return s < o.s; }
+
+  friend String operator+(const String& a, const String& b) { return a.s + b.s; }
+  friend String operator+(const String& a, const char* b) { return a.s + b; }
+  friend String operator+(const char* a, const String& b) { return a + b.s; }
+
+private:
+  std::string s;
+
+  static int find(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+  static std::string format(long v, unsigned char base) {
+    if (base == DEC) return std::to_string(v);
+    return formatUnsigned((unsigned long)v, base);
+  }
+  static std::string formatUnsigned(unsigned long v, unsigned char base) {
+    if (base == DEC) return std::to_string(v);
+    const char* digits = "0123456789ABCDEF";
+    std::string out;
+    do { out.insert(out.begin(), digits[v % base]); v /= base; } while (v);
+    return out;
+  }
+  static std::string formatFloat(double v, unsigned int decimals) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+    return buf;
+  }
+};
+
+// Text output shared by Serial, File and the TFT's print()
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(const uint8_t* data, size_t size) = 0;
+
+  size_t write(uint8_t c) { return write(&c, 1); }
+  size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  size_t print(const String& s) { return print(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v, int base = DEC) { return print(String(v, base)); }
+  size_t print(unsigned int v, int base = DEC) { return print(String(v, base)); }
+  size_t print(long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(unsigned long v, int base = DEC) { return print(String(v, base)); }
+  size_t print(double v, int decimals = 2) { return print(String(v, decimals)); }
+  template <typename T> size_t println(const T& v) { return print(v) + println(); }
+  template <typename T> size_t println(const T& v, int format) { return print(v, format) + println(); }
+  size_t println() { return print("\n"); }
+  __attribute__((format(printf, 2, 3))) size_t printf(const char* format, ...) {
+    char buf[512];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    return n > 0 ? print(buf) : 0;
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  virtual int peek() { return -1; }
+  size_t readBytesUntil(char terminator, char* buffer, size_t length) {
+    size_t n = 0;
+    while (n < length && available()) {
+      int c = read();
+      if (c < 0 || c == terminator) break;
+      buffer[n++] = (char)c;
+    }
+    return n;
+  }
+  String readStringUntil(char terminator) {
+    std::string out;
+    while (available()) {
+      int c = read();
+      if (c < 0 || c == terminator) break;
+      out += (char)c;
+    }
+    return out;
+  }
+};
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  void setDebugOutput(bool) {}
+  void flush() { fflush(stdout); }
+  operator bool() const { return true; }
+  using Print::write;
+  size_t write(const uint8_t* data, size_t size) override { return muted ? size : fwrite(data, 1, size, stdout); }
+
+  // Host only: drops the output, e.g. of code inside a timing loop
+  void setMuted(bool m) { muted = m; }
+
+private:
+  bool muted = false;
+};
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+  uint32_t getCycleCount();  // Nanoseconds on the host: there is no cycle counter to share
+  uint32_t getFreeHeap() { return 320 * 1024; }
+  uint32_t getHeapSize() { return 320 * 1024; }
+  uint32_t getCpuFreqMHz() { return 240; }
+  void restart();
+};
+extern EspClass ESP;
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,92 @@
+#ifndef NATIVE_BLEDEVICE_H
+#define NATIVE_BLEDEVICE_H
+
+// Host stand-in for the ESP32 BLE library. There is no radio: the server
+// never connects, and a characteristic's notify() hands its value to
+// BLECharacteristic::onNotify, if the host program set one, so BLE-MIDI
+// output can be captured off-device.
+
+#include <Arduino.h>
+
+typedef void (*NativeNotifyHook)(const uint8_t* data, size_t length);
+
+class BLEDescriptor {};
+class BLE2902 : public BLEDescriptor {};
+
+class BLECharacteristic {
+public:
+  static const uint32_t PROPERTY_READ = 1 << 0;
+  static const uint32_t PROPERTY_WRITE = 1 << 1;
+  static const uint32_t PROPERTY_NOTIFY = 1 << 2;
+  static const uint32_t PROPERTY_WRITE_NR = 1 << 5;
+
+  static NativeNotifyHook onNotify;
+
+  void setValue(const uint8_t* data, size_t length) { value.assign((const char*)data, length); }
+  void setValue(const std::string& v) { value = v; }
+  std::string getValue() const { return value; }
+  void notify() {
+    if (onNotify) onNotify((const uint8_t*)value.data(), value.size());
+  }
+  void addDescriptor(BLEDescriptor*) {}
+  void setCallbacks(class BLECharacteristicCallbacks* cb) { callbacks = cb; }
+
+private:
+  std::string value;
+  class BLECharacteristicCallbacks* callbacks = nullptr;
+};
+
+class BLECharacteristicCallbacks {
+public:
+  virtual ~BLECharacteristicCallbacks() {}
+  virtual void onWrite(BLECharacteristic*) {}
+};
+
+class BLEServer;
+class BLEServerCallbacks {
+public:
+  virtual ~BLEServerCallbacks() {}
+  virtual void onConnect(BLEServer*) {}
+  virtual void onDisconnect(BLEServer*) {}
+};
+
+class BLEService {
+public:
+  BLECharacteristic* createCharacteristic(const char*, uint32_t) { return new BLECharacteristic(); }
+  void start() {}
+};
+
+class BLEAdvertising {
+public:
+  void addServiceUUID(const char*) {}
+  void setScanResponse(bool) {}
+  void setMinPreferred(uint16_t) {}
+  void setMaxPreferred(uint16_t) {}
+  void start() {}
+  void stop() {}
+};
+
+class BLEServer {
+public:
+  void setCallbacks(BLEServerCallbacks* cb) { callbacks = cb; }
+  BLEService* createService(const char*) { return new BLEService(); }
+  BLEAdvertising* getAdvertising() { return &advertising; }
+  void startAdvertising() {}
+  uint32_t getConnectedCount() { return 0; }
+
+private:
+  BLEServerCallbacks* callbacks = nullptr;
+  BLEAdvertising advertising;
+};
+
+class BLEDevice {
+public:
+  static void init(const char*) {}
+  static void deinit(bool = false) {}
+  static BLEServer* createServer() { return new BLEServer(); }
+  static BLEAdvertising* getAdvertising() { static BLEAdvertising advertising; return &advertising; }
+  static void startAdvertising() {}
+  static void setMTU(uint16_t) {}
+};
+
+#endif // NATIVE_BLEDEVICE_H
@@ -0,0 +1,72 @@
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+// Host stand-in for the Arduino FS layer: files live in an ordinary
+// directory (see SD.h), opened through stdio
+
+#include <Arduino.h>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+class File : public Stream {
+public:
+  File() {}
+  File(const std::string& hostPath, const std::string& name, const char* mode);
+  File(const File&) = delete;
+  File& operator=(const File&) = delete;
+  File(File&& other) { *this = static_cast<File&&>(other); }
+  File& operator=(File&& other);
+  ~File() { close(); }
+
+  operator bool() const { return file != nullptr || dir != nullptr; }
+  void close();
+  const char* name() const { return fileName.c_str(); }
+  const char* path() const { return filePath.c_str(); }
+  size_t size() const;
+  bool isDirectory() const { return dir != nullptr; }
+  File openNextFile();
+
+  using Print::write;
+  size_t write(const uint8_t* data, size_t length) override;
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t read(uint8_t* buffer, size_t length);
+  bool seek(uint32_t position);
+  size_t position() const;
+
+private:
+  FILE* file = nullptr;
+  void* dir = nullptr;  // DIR*
+  std::string hostPath, filePath, fileName;
+};
+
+class FS {
+public:
+  explicit FS(const char* root) : root(root) {}
+  File open(const char* path, const char* mode = FILE_READ);
+  File open(const String& path, const char* mode = FILE_READ) { return open(path.c_str(), mode); }
+  bool exists(const char* path);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  bool mkdir(const char* path);
+  bool mkdir(const String& path) { return mkdir(path.c_str()); }
+  bool remove(const char* path);
+  bool remove(const String& path) { return remove(path.c_str()); }
+  bool rmdir(const char* path);
+  bool rmdir(const String& path) { return rmdir(path.c_str()); }
+
+protected:
+  std::string root;
+  std::string hostPath(const char* path) const { return root + (path[0] == '/' ? "" : "/") + path; }
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // NATIVE_FS_H
@@ -0,0 +1,31 @@
+#ifndef NATIVE_SD_H
+#define NATIVE_SD_H
+
+// Host stand-in for the SD card: its root is the directory named by the
+// CYD_SD_ROOT environment variable, "sdcard" in the working directory if
+// unset. begin() creates it, so a host run always has a card.
+
+#include <FS.h>
+#include <SPI.h>
+
+#define CARD_NONE 0
+#define CARD_MMC 1
+#define CARD_SD 2
+#define CARD_SDHC 3
+
+class SDFS : public fs::FS {
+public:
+  SDFS() : fs::FS("sdcard") {}
+  bool begin(uint8_t ssPin = 5, SPIClass& spi = SPI, uint32_t frequency = 4000000);
+  void end() { mounted = false; }
+  uint8_t cardType() const { return mounted ? CARD_SDHC : CARD_NONE; }
+  uint64_t cardSize() const { return 8ULL << 30; }
+  uint64_t totalBytes() const { return 8ULL << 30; }
+  uint64_t usedBytes() const { return 0; }
+
+private:
+  bool mounted = false;
+};
+extern SDFS SD;
+
+#endif // NATIVE_SD_H
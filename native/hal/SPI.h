@@ -0,0 +1,23 @@
+#ifndef NATIVE_SPI_H
+#define NATIVE_SPI_H
+
+// Host stand-in for the SPI bus: every transfer reads back zero
+
+#include <Arduino.h>
+
+#define VSPI 3
+#define HSPI 2
+
+class SPIClass {
+public:
+  explicit SPIClass(uint8_t bus = HSPI) { (void)bus; }
+  void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {
+    (void)sck; (void)miso; (void)mosi; (void)ss;
+  }
+  void end() {}
+  void setFrequency(uint32_t) {}
+  uint8_t transfer(uint8_t) { return 0; }
+};
+extern SPIClass SPI;
+
+#endif // NATIVE_SPI_H
@@ -0,0 +1,212 @@
+#ifndef NATIVE_TFT_ESPI_H
+#define NATIVE_TFT_ESPI_H
+
+// Host stand-in for TFT_eSPI: nothing is shown, but every drawing call and
+// the pixels it would have pushed are counted, so screen code can be run and
+// its drawing cost compared off-device (nativeTFTStats). Fills, images and
+// text are clipped to the viewport; lines and outlines are counted whole.
+
+#include <Arduino.h>
+
+#ifndef TFT_WIDTH
+#define TFT_WIDTH 240
+#endif
+#ifndef TFT_HEIGHT
+#define TFT_HEIGHT 320
+#endif
+
+#define TFT_BLACK       0x0000
+#define TFT_NAVY        0x000F
+#define TFT_DARKGREEN   0x03E0
+#define TFT_DARKCYAN    0x03EF
+#define TFT_MAROON      0x7800
+#define TFT_PURPLE      0x780F
+#define TFT_OLIVE       0x7BE0
+#define TFT_LIGHTGREY   0xD69A
+#define TFT_DARKGREY    0x7BEF
+#define TFT_BLUE        0x001F
+#define TFT_GREEN       0x07E0
+#define TFT_CYAN        0x07FF
+#define TFT_RED         0xF800
+#define TFT_MAGENTA     0xF81F
+#define TFT_YELLOW      0xFFE0
+#define TFT_WHITE       0xFFFF
+#define TFT_ORANGE      0xFDA0
+#define TFT_GREENYELLOW 0xB7E0
+#define TFT_PINK        0xFE19
+#define TFT_BROWN       0x9A60
+#define TFT_GOLD        0xFEA0
+#define TFT_SILVER      0xC618
+#define TFT_SKYBLUE     0x867D
+#define TFT_VIOLET      0x915C
+#define TFT_TRANSPARENT 0x0120
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define MC_DATUM 4
+#define MR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+#define PSRAM_ENABLE 3  // TFT_eSprite::setAttribute()
+
+struct NativeTFTStats {
+  uint32_t calls;   // Drawing calls
+  uint64_t pixels;  // Pixels those calls would have written
+};
+extern NativeTFTStats nativeTFTStats;
+
+class TFT_eSPI : public Print {
+public:
+  TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT) : _init_width(w), _init_height(h) {}
+
+  void init() {}
+  void begin() {}
+  void setRotation(uint8_t r) { rotation = r & 3; }
+  uint8_t getRotation() const { return rotation; }
+  int16_t width() const { return rotation & 1 ? _init_height : _init_width; }
+  int16_t height() const { return rotation & 1 ? _init_width : _init_height; }
+  void invertDisplay(bool) {}
+
+  // vpDatum false: coordinates stay screen coordinates, as the compositor uses it
+  void setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool = true) {
+    vpX = x; vpY = y; vpW = w; vpH = h; viewport = true;
+  }
+  void resetViewport() { viewport = false; }
+
+  void fillScreen(uint32_t) { count(clipped(0, 0, width(), height())); }
+  void drawPixel(int32_t, int32_t, uint32_t) { count(1); }
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t) {
+    count(1 + (uint32_t)max(abs(x1 - x0), abs(y1 - y0)));
+  }
+  void drawFastHLine(int32_t, int32_t, int32_t w, uint32_t) { count(w > 0 ? w : 0); }
+  void drawFastVLine(int32_t, int32_t, int32_t h, uint32_t) { count(h > 0 ? h : 0); }
+  void drawRect(int32_t, int32_t, int32_t w, int32_t h, uint32_t) { count(2 * (uint64_t)(w + h)); }
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t) { count(clipped(x, y, w, h)); }
+  void drawRoundRect(int32_t, int32_t, int32_t w, int32_t h, int32_t, uint32_t) { count(2 * (uint64_t)(w + h)); }
+  void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t, uint32_t) { count(clipped(x, y, w, h)); }
+  void drawCircle(int32_t, int32_t, int32_t r, uint32_t) { count((uint64_t)(6.2832f * r)); }
+  void fillCircle(int32_t, int32_t, int32_t r, uint32_t) { count((uint64_t)(3.1416f * r * r)); }
+  void drawTriangle(int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, uint32_t) { count(0); }
+  void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t) {
+    count((uint64_t)abs((x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0)) / 2);
+  }
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t*) { count(clipped(x, y, w, h)); }
+  void setAddrWindow(int32_t, int32_t, int32_t, int32_t) {}
+  void pushPixels(const void*, uint32_t len) { count(len); }
+
+  // DMA: transfers complete at once
+  bool initDMA(bool = false) { return true; }
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t*, uint16_t* = nullptr) { count(clipped(x, y, w, h)); }
+  void dmaWait() {}
+  bool dmaBusy() { return false; }
+  void startWrite() {}
+  void endWrite() {}
+  void readRect(int32_t, int32_t, int32_t w, int32_t h, uint16_t* data) {
+    if (w > 0 && h > 0) memset(data, 0, sizeof(uint16_t) * w * h);
+  }
+  uint16_t readPixel(int32_t, int32_t) { return 0; }
+
+  void setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+  void setTextColor(uint16_t c, uint16_t bg, bool = false) { textcolor = c; textbgcolor = bg; }
+  void setTextSize(uint8_t s) { textsize = s ? s : 1; }
+  void setTextDatum(uint8_t d) { textdatum = d; }
+  void setTextFont(uint8_t f) { textfont = f; }
+  void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+  int16_t getCursorX() const { return cursorX; }
+  int16_t getCursorY() const { return cursorY; }
+
+  // Glyph metrics of the built-in fonts: 6x8 for font 1, 16 px high otherwise
+  int16_t textWidth(const char* s, uint8_t font) const { return (int16_t)strlen(s) * charWidth(font); }
+  int16_t textWidth(const String& s, uint8_t font) const { return textWidth(s.c_str(), font); }
+  int16_t textWidth(const char* s) const { return textWidth(s, textfont); }
+  int16_t textWidth(const String& s) const { return textWidth(s.c_str(), textfont); }
+  int16_t fontHeight(uint8_t font) const { return (font == 1 ? 8 : 16) * textsize; }
+  int16_t fontHeight() const { return fontHeight(textfont); }
+
+  int16_t drawString(const char* s, int32_t x, int32_t y, uint8_t font) { return text(s, font, (size_t)-1, x, y); }
+  int16_t drawString(const String& s, int32_t x, int32_t y, uint8_t font) { return drawString(s.c_str(), x, y, font); }
+  int16_t drawString(const char* s, int32_t x, int32_t y) { return drawString(s, x, y, textfont); }
+  int16_t drawString(const String& s, int32_t x, int32_t y) { return drawString(s.c_str(), x, y, textfont); }
+  int16_t drawCentreString(const char* s, int32_t x, int32_t y, uint8_t font) { return drawString(s, x, y, font); }
+  int16_t drawCentreString(const String& s, int32_t x, int32_t y, uint8_t font) { return drawString(s.c_str(), x, y, font); }
+  int16_t drawRightString(const char* s, int32_t x, int32_t y, uint8_t font) { return drawString(s, x, y, font); }
+  int16_t drawRightString(const String& s, int32_t x, int32_t y, uint8_t font) { return drawString(s.c_str(), x, y, font); }
+
+  using Print::write;
+  size_t write(const uint8_t* data, size_t size) override {
+    text((const char*)data, textfont, size, cursorX, cursorY);
+    cursorX += (int16_t)(size * charWidth(textfont));
+    return size;
+  }
+
+  uint16_t color565(uint8_t r, uint8_t g, uint8_t b) const {
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+  }
+  uint16_t alphaBlend(uint8_t alpha, uint16_t fg, uint16_t bg) const {
+    uint16_t fr = fg >> 11, fgg = (fg >> 5) & 0x3F, fb = fg & 0x1F;
+    uint16_t br = bg >> 11, bgg = (bg >> 5) & 0x3F, bb = bg & 0x1F;
+    uint16_t r = (fr * alpha + br * (255 - alpha)) / 255;
+    uint16_t g = (fgg * alpha + bgg * (255 - alpha)) / 255;
+    uint16_t b = (fb * alpha + bb * (255 - alpha)) / 255;
+    return (r << 11) | (g << 5) | b;
+  }
+
+protected:
+  int16_t _init_width, _init_height;
+  uint8_t rotation = 0;
+  uint16_t textcolor = TFT_WHITE, textbgcolor = TFT_BLACK;
+  uint8_t textsize = 1, textdatum = TL_DATUM, textfont = 1;
+  int16_t cursorX = 0, cursorY = 0;
+  bool viewport = false;
+  int32_t vpX = 0, vpY = 0, vpW = 0, vpH = 0;
+
+  static uint64_t area(int32_t w, int32_t h) { return w > 0 && h > 0 ? (uint64_t)w * h : 0; }
+  uint64_t clipped(int32_t x, int32_t y, int32_t w, int32_t h) const {
+    if (!viewport) return area(w, h);
+    int32_t x0 = max(x, vpX), y0 = max(y, vpY);
+    int32_t x1 = min(x + w, vpX + vpW), y1 = min(y + h, vpY + vpH);
+    return area(x1 - x0, y1 - y0);
+  }
+  static void count(uint64_t pixels) {
+    nativeTFTStats.calls++;
+    nativeTFTStats.pixels += pixels;
+  }
+  int16_t charWidth(uint8_t font) const { return (font == 1 ? 6 : 8) * textsize; }
+  int16_t text(const char* s, uint8_t font, size_t n, int32_t x, int32_t y) {
+    if (n == (size_t)-1) n = strlen(s);
+    count(clipped(x, y, (int32_t)n * charWidth(font), fontHeight(font)));
+    return (int16_t)(n * charWidth(font));
+  }
+};
+
+// Off-screen buffer; drawing into it is counted like drawing to the screen,
+// pushing it counts its whole area again
+class TFT_eSprite : public TFT_eSPI {
+public:
+  explicit TFT_eSprite(TFT_eSPI*) : TFT_eSPI(0, 0), buffer(nullptr) {}
+  ~TFT_eSprite() { deleteSprite(); }
+
+  void* createSprite(int16_t w, int16_t h) {
+    deleteSprite();
+    buffer = (uint16_t*)calloc((size_t)w * h, sizeof(uint16_t));
+    if (buffer) { _init_width = w; _init_height = h; }
+    return buffer;
+  }
+  void deleteSprite() { free(buffer); buffer = nullptr; _init_width = _init_height = 0; }
+  bool created() const { return buffer != nullptr; }
+  void* getPointer() { return buffer; }
+  void setColorDepth(int8_t) {}
+  void setAttribute(uint8_t, uint8_t) {}
+  void fillSprite(uint32_t) { count(area(_init_width, _init_height)); }
+  void pushSprite(int32_t, int32_t) { count(area(_init_width, _init_height)); }
+  void pushSprite(int32_t, int32_t, uint16_t) { count(area(_init_width, _init_height)); }
+
+private:
+  uint16_t* buffer;
+};
+
+#endif // NATIVE_TFT_ESPI_H
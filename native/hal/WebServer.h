@@ -0,0 +1,107 @@
+#ifndef NATIVE_WEBSERVER_H
+#define NATIVE_WEBSERVER_H
+
+// Host stand-in for the ESP32 WebServer. Nothing listens on a socket; a
+// host program calls request() instead, which runs the matching handler
+// and keeps its reply in lastCode/lastContentType/lastBody.
+
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+#include <map>
+#include <vector>
+
+typedef enum { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS } HTTPMethod;
+typedef enum { UPLOAD_FILE_START, UPLOAD_FILE_WRITE, UPLOAD_FILE_END, UPLOAD_FILE_ABORTED } HTTPUploadStatus;
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+
+struct HTTPUpload {
+  HTTPUploadStatus status;
+  String filename;
+  String name;
+  String type;
+  size_t totalSize;
+  size_t currentSize;
+  uint8_t buf[1436];
+};
+
+class WebServer {
+public:
+  typedef std::function<void()> THandlerFunction;
+
+  explicit WebServer(int port = 80) { (void)port; }
+  void begin() {}
+  void stop() {}
+  void close() {}
+  void handleClient() {}
+
+  void on(const String& uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+  void on(const String& uri, HTTPMethod method, THandlerFunction handler) { routes.push_back({uri, method, handler}); }
+  void on(const String& uri, HTTPMethod method, THandlerFunction handler, THandlerFunction) { on(uri, method, handler); }
+  void onNotFound(THandlerFunction handler) { notFound = handler; }
+
+  // Runs the handler for uri as if a client asked; false if none matched
+  bool request(HTTPMethod method, const String& uri, const std::map<std::string, std::string>& query = {}) {
+    currentMethod = method;
+    args = query;
+    lastCode = 0;
+    lastContentType = "";
+    lastBody = "";
+    for (const Route& route : routes) {
+      if (route.uri == uri && (route.method == HTTP_ANY || route.method == method)) {
+        route.handler();
+        return true;
+      }
+    }
+    if (notFound) notFound();
+    return false;
+  }
+
+  HTTPMethod method() const { return currentMethod; }
+  bool hasArg(const String& name) const { return args.count(name.c_str()) > 0; }
+  String arg(const String& name) const {
+    auto it = args.find(name.c_str());
+    return it == args.end() ? String() : String(it->second);
+  }
+  String uri() const { return ""; }
+  HTTPUpload& upload() { return currentUpload; }
+
+  void send(int code, const char* contentType = nullptr, const String& content = String()) {
+    lastCode = code;
+    lastContentType = contentType ? contentType : "";
+    lastBody = content;
+  }
+  void send(int code, const String& contentType, const String& content) { send(code, contentType.c_str(), content); }
+  void sendHeader(const String&, const String&, bool = false) {}
+  void setContentLength(size_t) {}
+  void sendContent(const String& content) { lastBody += content; }
+  void sendContent(const char* content, size_t length) { lastBody += String(std::string(content, length)); }
+  void sendContent_P(const char* content, size_t length) { sendContent(content, length); }
+  size_t streamFile(File& file, const String& contentType) {
+    lastCode = 200;
+    lastContentType = contentType;
+    std::string body;
+    for (int c; (c = file.read()) >= 0;) body += (char)c;
+    lastBody = String(body);
+    return body.size();
+  }
+
+  int lastCode = 0;
+  String lastContentType;
+  String lastBody;
+
+private:
+  struct Route {
+    String uri;
+    HTTPMethod method;
+    THandlerFunction handler;
+  };
+  std::vector<Route> routes;
+  THandlerFunction notFound;
+  HTTPMethod currentMethod = HTTP_GET;
+  std::map<std::string, std::string> args;
+  HTTPUpload currentUpload = {};
+};
+
+#endif // NATIVE_WEBSERVER_H
@@ -0,0 +1,44 @@
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+// Host stand-in for the ESP32 WiFi library: station mode never connects,
+// access point mode always comes up on 192.168.4.1
+
+#include <Arduino.h>
+
+typedef enum { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+typedef enum { WL_IDLE_STATUS, WL_CONNECTED = 3, WL_DISCONNECTED = 6 } wl_status_t;
+
+class IPAddress {
+public:
+  IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : octets{a, b, c, d} {}
+  String toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+    return buf;
+  }
+
+private:
+  uint8_t octets[4];
+};
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t m) { currentMode = m; return true; }
+  wifi_mode_t getMode() const { return currentMode; }
+  wl_status_t begin(const char* ssid, const char* = nullptr) { stationSSID = ssid; return WL_DISCONNECTED; }
+  wl_status_t status() const { return WL_DISCONNECTED; }
+  bool disconnect(bool = false) { return true; }
+  IPAddress localIP() const { return IPAddress(); }
+  String SSID() const { return stationSSID; }
+  bool softAP(const char*, const char* = nullptr) { return true; }
+  bool softAPdisconnect(bool = false) { return true; }
+  IPAddress softAPIP() const { return IPAddress(192, 168, 4, 1); }
+
+private:
+  wifi_mode_t currentMode = WIFI_OFF;
+  String stationSSID;
+};
+extern WiFiClass WiFi;
+
+#endif // NATIVE_WIFI_H
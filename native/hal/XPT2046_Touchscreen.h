@@ -0,0 +1,37 @@
+#ifndef NATIVE_XPT2046_TOUCHSCREEN_H
+#define NATIVE_XPT2046_TOUCHSCREEN_H
+
+// Host stand-in for the XPT2046 driver. Nothing is touched unless the host
+// program presses the panel itself with press()/release(), in raw
+// controller units (0-4095, z = pressure) as the real one reports them.
+
+#include <Arduino.h>
+
+class TS_Point {
+public:
+  TS_Point() : x(0), y(0), z(0) {}
+  TS_Point(int16_t x, int16_t y, int16_t z) : x(x), y(y), z(z) {}
+  int16_t x, y, z;
+};
+
+class XPT2046_Touchscreen {
+public:
+  XPT2046_Touchscreen(uint8_t csPin, uint8_t irqPin = 255) { (void)csPin; (void)irqPin; }
+  bool begin() { return true; }
+  template <typename SPI> bool begin(SPI&) { return true; }
+  void setRotation(uint8_t r) { rotation = r & 3; }
+  uint8_t getRotation() const { return rotation; }
+
+  TS_Point getPoint() { return point; }
+  bool tirqTouched() { return point.z > 0; }
+  bool touched() { return point.z > 0; }
+
+  void press(int16_t rawX, int16_t rawY, int16_t z = 1000) { point = TS_Point(rawX, rawY, z); }
+  void release() { point = TS_Point(); }
+
+private:
+  volatile uint8_t rotation = 0;
+  TS_Point point;
+};
+
+#endif // NATIVE_XPT2046_TOUCHSCREEN_H
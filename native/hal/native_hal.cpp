@@ -0,0 +1,592 @@
+// Host implementations behind the stand-in headers in native/hal
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <BLEDevice.h>
+#include <SD.h>
+#include <WiFi.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+SPIClass SPI;
+SDFS SD;
+WiFiClass WiFi;
+NativeTFTStats nativeTFTStats = {0, 0};
+NativeNotifyHook BLECharacteristic::onNotify = nullptr;
+
+// ---------------------------------------------------------------------------
+// Time
+
+typedef std::chrono::steady_clock NativeClock;
+static const NativeClock::time_point bootTime = NativeClock::now();
+
+static uint64_t nanosSinceBoot() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(NativeClock::now() - bootTime).count();
+}
+
+// Virtual time (nativeUseVirtualTime): only the task holding the turn runs,
+// and virtualUs only moves while every task is blocked
+static bool simulated = false;
+static uint64_t virtualUs = 0;
+static const uint64_t SIM_FOREVER = UINT64_MAX;
+static bool simWait(uint64_t wakeAtUs, const std::function<bool()>& ready);
+
+static uint64_t microsSinceBoot() { return simulated ? virtualUs : nanosSinceBoot() / 1000; }
+
+unsigned long millis() { return (unsigned long)(uint32_t)(microsSinceBoot() / 1000); }
+unsigned long micros() { return (unsigned long)(uint32_t)microsSinceBoot(); }
+int64_t esp_timer_get_time() { return (int64_t)microsSinceBoot(); }
+
+void delay(uint32_t ms) {
+  if (simulated) simWait(virtualUs + ms * 1000ull, nullptr);
+  else std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+  if (simulated) simWait(virtualUs + us, nullptr);
+  else std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {
+  if (simulated) simWait(virtualUs, nullptr);  // Others that can run go first
+  else std::this_thread::yield();
+}
+
+bool nativeVirtualTime() { return simulated; }
+
+uint32_t EspClass::getCycleCount() { return (uint32_t)nanosSinceBoot(); }
+
+void EspClass::restart() {
+  fflush(stdout);
+  _Exit(0);
+}
+
+// ---------------------------------------------------------------------------
+// Pins, random numbers, helpers
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return LOW; }
+uint16_t analogRead(uint8_t) { return 0; }
+
+static uint32_t randomState = 0x12345678;
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) randomState = (uint32_t)seed;
+}
+
+uint32_t esp_random() {
+  // xorshift32
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+
+long random(long howbig) {
+  return howbig <= 0 ? 0 : (long)(esp_random() % (uint32_t)howbig);
+}
+
+long random(long howsmall, long howbig) {
+  return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  if (inMax == inMin) return outMin;
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+#ifdef NATIVE_NEEDS_STRLCPY
+size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t length = strlen(src);
+  if (size) {
+    size_t n = length < size - 1 ? length : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return length;
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// FreeRTOS
+
+struct NativeTask {
+  std::mutex lock;
+  std::condition_variable wake;
+  uint32_t notifications = 0;
+
+  // Virtual time only
+  UBaseType_t priority = 1;
+  bool waiting = false;
+  uint64_t wakeAtUs = 0;
+  std::function<bool()> ready;  // Wakes it before wakeAtUs when true
+  uint64_t lastTurn = 0;        // Equal priorities take turns
+};
+
+struct NativeTimer;
+static void fireDueTimers();
+static uint64_t nextTimerDue();
+
+static thread_local NativeTask* currentTask = nullptr;
+
+static std::recursive_mutex simLock;  // Timer callbacks run under it and call back in
+static std::condition_variable_any simTurn;
+static std::vector<NativeTask*> simTasks;
+static NativeTask* simRunning = nullptr;
+static uint64_t simTurns = 0;
+
+static bool canRun(NativeTask* task) {
+  return !task->waiting || task->wakeAtUs <= virtualUs || (task->ready && task->ready());
+}
+
+// The task to run next, moving the clock on (and firing timers) until one can
+static NativeTask* simNext() {
+  while (true) {
+    NativeTask* next = nullptr;
+    for (NativeTask* task : simTasks) {
+      if (!canRun(task)) continue;
+      if (!next || task->priority > next->priority ||
+          (task->priority == next->priority && task->lastTurn < next->lastTurn)) {
+        next = task;
+      }
+    }
+    if (next) return next;
+
+    uint64_t soonest = nextTimerDue();
+    for (NativeTask* task : simTasks) soonest = min(soonest, task->wakeAtUs);
+    if (soonest == SIM_FOREVER) {
+      fprintf(stderr, "[Native] Every task is blocked with nothing left to wake it\n");
+      fflush(stdout);
+      _Exit(2);
+    }
+    virtualUs = max(virtualUs, soonest);
+    fireDueTimers();
+  }
+}
+
+static void takeTurn(std::unique_lock<std::recursive_mutex>& guard, NativeTask* self) {
+  simTurn.wait(guard, [self] { return simRunning == self; });
+  self->waiting = false;
+  self->ready = nullptr;
+  self->lastTurn = ++simTurns;
+}
+
+// Block the calling task until wakeAtUs or until ready(); false on timeout
+static bool simWait(uint64_t wakeAtUs, const std::function<bool()>& ready) {
+  std::unique_lock<std::recursive_mutex> guard(simLock);
+  NativeTask* self = currentTask;
+  self->waiting = true;
+  self->wakeAtUs = wakeAtUs;
+  self->ready = ready;
+  simRunning = simNext();
+  if (simRunning != self) simTurn.notify_all();
+  takeTurn(guard, self);
+  return !ready || ready();
+}
+
+void nativeUseVirtualTime(uint64_t startUs) {
+  std::lock_guard<std::recursive_mutex> guard(simLock);
+  virtualUs = startUs;
+  NativeTask* self = xTaskGetCurrentTaskHandle();
+  self->lastTurn = ++simTurns;
+  simTasks.push_back(self);
+  simRunning = self;
+  simulated = true;
+}
+
+static NativeClock::time_point deadline(TickType_t ticks) {
+  return NativeClock::now() + std::chrono::milliseconds(ticks * portTICK_PERIOD_MS);
+}
+
+static uint64_t virtualDeadline(TickType_t ticks) {
+  return ticks == portMAX_DELAY ? SIM_FOREVER : virtualUs + (uint64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t, void* param,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t) {
+  NativeTask* task = new NativeTask();
+  if (handle) *handle = task;
+  if (simulated) {
+    // Runnable, but it starts when the creator blocks
+    std::lock_guard<std::recursive_mutex> guard(simLock);
+    task->priority = priority;
+    simTasks.push_back(task);
+  }
+  std::thread([fn, param, task]() {
+    currentTask = task;
+    if (simulated) {
+      std::unique_lock<std::recursive_mutex> guard(simLock);
+      takeTurn(guard, task);
+    }
+    fn(param);
+    if (simulated) simWait(SIM_FOREVER, nullptr);  // Returned: never runs again
+  }).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* param,
+                       UBaseType_t priority, TaskHandle_t* handle) {
+  return xTaskCreatePinnedToCore(fn, name, stackDepth, param, priority, handle, 0);
+}
+
+void vTaskDelete(TaskHandle_t) {
+  // Threads cannot be killed from outside; the stubs' tasks run until exit
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  if (!currentTask) currentTask = new NativeTask();  // main() or a timer thread
+  return currentTask;
+}
+
+TickType_t xTaskGetTickCount() { return (TickType_t)(microsSinceBoot() / 1000 / portTICK_PERIOD_MS); }
+
+void vTaskDelay(TickType_t ticks) {
+  if (simulated) simWait(virtualDeadline(ticks), nullptr);
+  else std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t period) {
+  *previousWake += period;
+  TickType_t now = xTaskGetTickCount();
+  if ((int32_t)(*previousWake - now) > 0) vTaskDelay(*previousWake - now);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  {
+    std::lock_guard<std::mutex> guard(task->lock);
+    task->notifications++;
+  }
+  task->wake.notify_one();
+  return pdPASS;
+}
+
+// With virtual time the waiting is done outside the object's own lock, which
+// the other tasks may need while this one is blocked
+static BaseType_t waitFor(std::unique_lock<std::mutex>& guard, std::condition_variable& wake,
+                          TickType_t ticksToWait, const std::function<bool()>& ready) {
+  if (simulated) {
+    if (ready()) return pdTRUE;
+    if (!ticksToWait) return pdFALSE;
+    guard.unlock();
+    bool ok = simWait(virtualDeadline(ticksToWait), ready);
+    guard.lock();
+    return ok ? pdTRUE : pdFALSE;
+  }
+  if (ticksToWait == portMAX_DELAY) {
+    wake.wait(guard, ready);
+    return pdTRUE;
+  }
+  return wake.wait_until(guard, deadline(ticksToWait), ready) ? pdTRUE : pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+  NativeTask* task = xTaskGetCurrentTaskHandle();
+  std::unique_lock<std::mutex> guard(task->lock);
+  waitFor(guard, task->wake, ticksToWait, [task] { return task->notifications > 0; });
+
+  uint32_t count = task->notifications;
+  if (count) task->notifications = clearOnExit ? 0 : count - 1;
+  return count;
+}
+
+// Mutexes and binary semaphores are both a count with a ceiling of one
+struct NativeSemaphore {
+  std::mutex lock;
+  std::condition_variable wake;
+  uint32_t count;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new NativeSemaphore{{}, {}, 1}; }
+SemaphoreHandle_t xSemaphoreCreateBinary() { return new NativeSemaphore{{}, {}, 0}; }
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) { delete semaphore; }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+  std::unique_lock<std::mutex> guard(semaphore->lock);
+  if (!waitFor(guard, semaphore->wake, ticksToWait, [semaphore] { return semaphore->count > 0; })) {
+    return pdFALSE;
+  }
+  semaphore->count--;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  {
+    std::lock_guard<std::mutex> guard(semaphore->lock);
+    if (semaphore->count > 0) return pdFALSE;
+    semaphore->count = 1;
+  }
+  semaphore->wake.notify_one();
+  return pdTRUE;
+}
+
+struct NativeQueue {
+  std::mutex lock;
+  std::condition_variable wake;
+  std::deque<std::vector<uint8_t>> items;
+  UBaseType_t length;
+  UBaseType_t itemSize;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  NativeQueue* queue = new NativeQueue();
+  queue->length = length;
+  queue->itemSize = itemSize;
+  return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) { delete queue; }
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+  {
+    std::unique_lock<std::mutex> guard(queue->lock);
+    if (!waitFor(guard, queue->wake, ticksToWait, [queue] { return queue->items.size() < queue->length; })) {
+      return pdFALSE;
+    }
+    const uint8_t* bytes = (const uint8_t*)item;
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  }
+  queue->wake.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+  {
+    std::unique_lock<std::mutex> guard(queue->lock);
+    if (!waitFor(guard, queue->wake, ticksToWait, [queue] { return !queue->items.empty(); })) {
+      return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+  }
+  queue->wake.notify_all();
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> guard(queue->lock);
+  return queue->items.size();
+}
+
+// ---------------------------------------------------------------------------
+// esp_timer: one thread per timer, sleeping until its deadline. With virtual
+// time there are no threads: simNext() fires the timers as the clock reaches
+// them, on whichever task thread moved it (as if from the timer task).
+
+struct NativeTimer {
+  std::mutex lock;
+  std::condition_variable wake;
+  esp_timer_cb_t callback;
+  void* arg;
+  bool armed = false;
+  uint64_t periodUs = 0;
+  NativeClock::time_point due;
+  uint64_t dueUs = 0;  // Virtual time
+};
+
+static std::vector<NativeTimer*> simTimers;
+
+static uint64_t nextTimerDue() {
+  uint64_t soonest = SIM_FOREVER;
+  for (NativeTimer* timer : simTimers) {
+    if (timer->armed) soonest = min(soonest, timer->dueUs);
+  }
+  return soonest;
+}
+
+// Earliest deadline first, timers created first on a tie
+static void fireDueTimers() {
+  while (true) {
+    NativeTimer* next = nullptr;
+    for (NativeTimer* timer : simTimers) {
+      if (timer->armed && timer->dueUs <= virtualUs && (!next || timer->dueUs < next->dueUs)) next = timer;
+    }
+    if (!next) return;
+    if (next->periodUs) next->dueUs += next->periodUs;
+    else next->armed = false;
+    next->callback(next->arg);
+  }
+}
+
+static void runTimer(NativeTimer* timer) {
+  std::unique_lock<std::mutex> guard(timer->lock);
+  while (true) {
+    timer->wake.wait(guard, [timer] { return timer->armed; });
+    if (timer->wake.wait_until(guard, timer->due, [timer] { return !timer->armed; })) continue;
+    if (NativeClock::now() < timer->due) continue;  // Re-armed for later while waiting
+
+    if (timer->periodUs) timer->due += std::chrono::microseconds(timer->periodUs);
+    else timer->armed = false;
+    guard.unlock();
+    timer->callback(timer->arg);
+    guard.lock();
+  }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+  NativeTimer* timer = new NativeTimer();
+  timer->callback = args->callback;
+  timer->arg = args->arg;
+  if (simulated) {
+    std::lock_guard<std::recursive_mutex> guard(simLock);
+    simTimers.push_back(timer);
+  } else {
+    std::thread(runTimer, timer).detach();
+  }
+  *handle = timer;
+  return ESP_OK;
+}
+
+static esp_err_t arm(esp_timer_handle_t timer, uint64_t timeoutUs, uint64_t periodUs) {
+  if (simulated) {
+    std::lock_guard<std::recursive_mutex> guard(simLock);
+    if (timer->armed) return ESP_FAIL;
+    timer->armed = true;
+    timer->periodUs = periodUs;
+    timer->dueUs = virtualUs + timeoutUs;
+    return ESP_OK;
+  }
+  {
+    std::lock_guard<std::mutex> guard(timer->lock);
+    if (timer->armed) return ESP_FAIL;  // As on the device: stop it first
+    timer->armed = true;
+    timer->periodUs = periodUs;
+    timer->due = NativeClock::now() + std::chrono::microseconds(timeoutUs);
+  }
+  timer->wake.notify_all();
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) { return arm(timer, timeoutUs, 0); }
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) { return arm(timer, periodUs, periodUs); }
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  if (simulated) {
+    std::lock_guard<std::recursive_mutex> guard(simLock);
+    if (!timer->armed) return ESP_FAIL;
+    timer->armed = false;
+    return ESP_OK;
+  }
+  {
+    std::lock_guard<std::mutex> guard(timer->lock);
+    if (!timer->armed) return ESP_FAIL;
+    timer->armed = false;
+  }
+  timer->wake.notify_all();
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  esp_timer_stop(timer);
+  return ESP_OK;  // Its thread keeps the object; timers live as long as the program here
+}
+
+// ---------------------------------------------------------------------------
+// SD card in a host directory
+
+bool SDFS::begin(uint8_t, SPIClass&, uint32_t) {
+  const char* dir = getenv("CYD_SD_ROOT");
+  root = dir && dir[0] ? dir : "sdcard";
+  ::mkdir(root.c_str(), 0755);
+  struct stat st;
+  mounted = stat(root.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+  return mounted;
+}
+
+namespace fs {
+
+File::File(const std::string& host, const std::string& name, const char* mode)
+    : hostPath(host), filePath(name) {
+  size_t slash = name.find_last_of('/');
+  fileName = slash == std::string::npos ? name : name.substr(slash + 1);
+  struct stat st;
+  if (mode[0] == 'r' && stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+    dir = opendir(host.c_str());
+  } else {
+    file = fopen(host.c_str(), mode[0] == 'r' ? "rb" : mode[0] == 'a' ? "ab" : "wb");
+  }
+}
+
+File& File::operator=(File&& other) {
+  close();
+  file = other.file;
+  dir = other.dir;
+  hostPath = other.hostPath;
+  filePath = other.filePath;
+  fileName = other.fileName;
+  other.file = nullptr;
+  other.dir = nullptr;
+  return *this;
+}
+
+void File::close() {
+  if (file) fclose(file);
+  if (dir) closedir((DIR*)dir);
+  file = nullptr;
+  dir = nullptr;
+}
+
+size_t File::size() const {
+  struct stat st;
+  return (file || dir) && stat(hostPath.c_str(), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+File File::openNextFile() {
+  if (!dir) return File();
+  while (struct dirent* entry = readdir((DIR*)dir)) {
+    if (entry->d_name[0] == '.') continue;
+    std::string base = filePath == "/" ? "" : filePath;
+    return File(hostPath + "/" + entry->d_name, base + "/" + entry->d_name, FILE_READ);
+  }
+  return File();
+}
+
+size_t File::write(const uint8_t* data, size_t length) { return file ? fwrite(data, 1, length, file) : 0; }
+
+int File::available() {
+  if (!file) return 0;
+  long here = ftell(file);
+  long size = (long)this->size();
+  return size > here ? (int)(size - here) : 0;
+}
+
+int File::read() { return file ? fgetc(file) : -1; }
+
+int File::peek() {
+  if (!file) return -1;
+  int c = fgetc(file);
+  if (c != EOF) ungetc(c, file);
+  return c;
+}
+
+size_t File::read(uint8_t* buffer, size_t length) { return file ? fread(buffer, 1, length, file) : 0; }
+bool File::seek(uint32_t position) { return file && fseek(file, position, SEEK_SET) == 0; }
+size_t File::position() const { return file ? (size_t)ftell(file) : 0; }
+
+File FS::open(const char* path, const char* mode) {
+  File f(hostPath(path), path, mode);
+  if (!f) return File();
+  return f;
+}
+
+bool FS::exists(const char* path) {
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::mkdir(const char* path) { return ::mkdir(hostPath(path).c_str(), 0755) == 0; }
+bool FS::remove(const char* path) { return ::remove(hostPath(path).c_str()) == 0; }
+bool FS::rmdir(const char* path) { return ::rmdir(hostPath(path).c_str()) == 0; }
+
+}  // namespace fs
@@ -0,0 +1,987 @@
+// Host runner for [env:native] (pio run -e native && .pio/build/native/program)
+//
+// Runs the generators and the MIDI task off-device against the stand-ins in
+// native/hal, in virtual time: runs the GeneratorBench suite, checks that what
+// the generators produce is sane, checks the SPSC ring and the clock's drift
+// (also across tempo changes), fuzzes the BLE-MIDI parser, checks the gesture
+// recognizer, the dirty-rectangle list, the icon coding, the touch calibration
+// fit, the latency histogram and the step grid, plays the Euclidean engine
+// through the real MIDI task for a second and decodes the BLE-MIDI it sent,
+// checks that a retriggered note outlives the earlier note's off, that TB-3PO
+// ties slides into the same pitch and that the arp alone sends no transport
+// messages, then compares a minute of each engine's output with its golden log
+// (golden_midi.h) and prints the latency trace of those runs.
+// Exits non-zero if any check fails. --update-golden rewrites the logs.
+
+#include "common_definitions.h"
+#include "euclidean_mode.h"
+#include "grids_mode.h"
+#include "tb3po_mode.h"
+#include "morph_mode.h"
+#include "lfo_mode.h"
+#include "arpeggiator_mode.h"
+#include "generator_runtime.h"
+#include "generator_bench.h"
+#include "golden_midi.h"
+#include "latency_trace.h"
+#include "ui_compositor.h"
+#include "dirty_regions.h"
+#include "icon_rle.h"
+#include "touch_affine.h"
+#include "latency_histogram.h"
+#include "step_grid.h"
+#include "spsc_queue.h"
+#include "clock_phase.h"
+#include "ble_midi_packet.h"
+#include "ble_midi_parser.h"
+#include <algorithm>
+#include <thread>
+
+// What CYD-MIDI-Controller.ino defines on the device
+TFT_eSPI tft = TFT_eSPI();
+XPT2046_Touchscreen ts(33, 36);
+SPIClass sdSPI = SPIClass(HSPI);
+BLECharacteristic* pCharacteristic = nullptr;
+bool sdCardAvailable = true;
+MIDIClockSync midiClock;
+TempoTracker clockTracker;
+TouchState touch;
+GestureRecognizer gestures;
+AppMode currentMode = MENU;
+
+void exitToMenu() {
+  currentMode = MENU;
+  gestures.reset();  // As on the device: the press that left is not the menu's
+}
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+  if (!ok) {
+    printf("  FAILED: %s\n", what);
+    failures++;
+  }
+}
+
+// Repeatable pseudo-random input for the fuzz and stress checks (xorshift32)
+static uint32_t fuzzState = 0x2545F491;
+static uint32_t fuzzNext() {
+  fuzzState ^= fuzzState << 13;
+  fuzzState ^= fuzzState >> 17;
+  fuzzState ^= fuzzState << 5;
+  return fuzzState;
+}
+
+// The suite the device runs for /bench, then checks of what the generators make
+static void benchmarkGenerators() {
+  printf("Generators (GeneratorBench, ns per call)\n");
+  check(GeneratorBench::run(), "benchmark runs");
+  String json = GeneratorBench::toJSON();
+  check(json.startsWith("{\"unit\":\"ns\"") && json.endsWith("]}"), "benchmark JSON");
+
+  EuclideanVoice voice = {16, 5, 0, 36, TFT_RED, {false}};
+  generateEuclideanPattern(voice);
+  EuclideanVoice rotated = voice;
+  rotated.rotation = 3;
+  generateEuclideanPattern(rotated);
+  int hits = 0;
+  bool shifted = true;
+  for (int s = 0; s < 16; s++) {
+    hits += voice.pattern[s];
+    shifted = shifted && rotated.pattern[(s + 3) % 16] == voice.pattern[s];
+  }
+  check(hits == 5, "E(5,16) has 5 hits");
+  check(shifted, "Rotation shifts the pattern");
+
+  regenerateGridsPattern();
+  int kicks = 0;
+  for (int s = 0; s < GRIDS_STEPS; s++) kicks += grids.kickPattern[s] > 0;
+  check(kicks > 0, "Grids pattern has kicks");
+
+  tb3po.seed = 4242;
+  regenerateTB3POPattern();
+  TB3POState first = tb3po;
+  regenerateTB3POPattern();
+  check(memcmp(first.notes, tb3po.notes, sizeof(tb3po.notes)) == 0 && first.gates == tb3po.gates,
+        "TB3PO pattern repeats for the same seed");
+
+  for (int slot = 0; slot < NUM_MEMORY_SLOTS; slot++) {
+    Gesture& g = morphState.memories[slot];
+    g.numPoints = 64 + slot * 16;
+    g.isValid = true;
+    g.duration = 2000;
+    for (int p = 0; p < g.numPoints; p++) {
+      float t = (float)p / (g.numPoints - 1);
+      g.points[p] = {t, 0.5f + 0.4f * sinf(t * (slot + 1) * (float)TWO_PI), (unsigned long)(t * 2000), 0.5f, 0.5f};
+    }
+  }
+  morphState.morphX = 0.3f;
+  morphState.morphY = 0.7f;
+  morphGestures();
+  check(morphState.morphedGesture.isValid && morphState.morphedGesture.numPoints > 0,
+        "Morph blends the four gestures");
+
+  float lfoMin = 2, lfoMax = -2;
+  for (int i = 0; i < 4 * 628; i++) {
+    lfo.waveform = i % 4;
+    lfo.phase = (i / 4) / 100.0f;
+    float v = calculateLFOValue();
+    lfoMin = min(lfoMin, v);
+    lfoMax = max(lfoMax, v);
+  }
+  check(lfoMin >= -1.0f && lfoMax <= 1.0f, "LFO stays within -1..1");
+}
+
+// 10,000 beats of MIDI clock at uneven tempos: every tick within 1us of its
+// exact rational time, so nothing accumulates. A fixed whole-microsecond
+// interval per tick, for comparison, drifts by the rounding times the ticks.
+static void checkClockPhaseDrift() {
+  printf("ClockPhase: 10000 beats\n");
+  const uint32_t tempos[] = {60000, 120500, 173000};  // milli-BPM
+  const uint16_t grids[] = {MIDI_CLOCK_PPQN, TRANSPORT_PPQN};
+  const uint64_t startUs = 123456789;
+  for (uint32_t bpmMilli : tempos) {
+    for (uint16_t ppqn : grids) {
+      ClockPhase phase;
+      phase.start(startUs, bpmMilli, ppqn);
+      // Tick n is due at startUs + n * num / den exactly
+      const uint64_t num = 60000000000ULL, den = (uint64_t)bpmMilli * ppqn;
+      const uint64_t ticks = 10000ULL * ppqn;
+      uint64_t worstNs = 0, lastNs = 0;
+      bool within = true;
+      for (uint64_t n = 0; n <= ticks; n++) {
+        uint64_t exactNum = n * num;  // (tick time - startUs) * den
+        uint64_t gotNum = (phase.nextTickUs() - startUs) * den;
+        uint64_t error = exactNum > gotNum ? exactNum - gotNum : gotNum - exactNum;
+        within = within && error < den;
+        lastNs = error * 1000 / den;
+        worstNs = max(worstNs, lastNs);
+        phase.advance();
+      }
+      uint64_t lastUs = ticks * num / den;
+      uint64_t fixedUs = ticks * (num / den);
+      printf("  %7.3f BPM x%-2u worst %3llu ns, last tick %3llu ns; a fixed interval drifts %llu us\n",
+             bpmMilli / 1000.0f, ppqn, (unsigned long long)worstNs, (unsigned long long)lastNs,
+             (unsigned long long)(lastUs - fixedUs));
+      check(within && phase.ticks() == ticks + 1, "ticks within 1us of exact time");
+    }
+  }
+}
+
+// Tempo changes asked for in the middle of a beat: the rest of that beat
+// keeps the old tempo, the new one runs from the beat's tick (the new
+// anchor), and no tick is lost or doubled. Ten changes over 10,000 beats.
+// Against the ideal time the only error is the anchor landing on a whole
+// microsecond, under 1us per change.
+static void checkClockPhaseTempoChange() {
+  printf("ClockPhase: tempo changes mid-beat\n");
+  const uint32_t tempos[] = {173000, 60000, 99999, 240000, 87300, 133333, 20000, 300000, 145000, 120500};
+  const uint16_t ppqn = TRANSPORT_PPQN;
+  const uint64_t startUs = 987654321;
+  ClockPhase phase;
+  phase.start(startUs, 120500, ppqn);
+
+  uint32_t bpmMilli = 120500, pending = 0;
+  uint64_t anchorUs = startUs;         // Tick 0 of the running tempo
+  long double anchorNs = startUs * 1000.0L;  // Its ideal time
+  uint64_t n = 0;                      // Ticks since the anchor
+  uint32_t changes = 0;
+  bool onGrid = true, atBoundary = true, withinDrift = true;
+  long double worstNs = 0;
+  for (uint32_t beat = 0; beat < 10000; beat++) {
+    for (uint16_t t = 0; t < ppqn; t++) {
+      if (beat % 1000 == 500 && t == ppqn / 2 + 7) {
+        pending = tempos[beat / 1000];
+        phase.setBPM(pending);
+      }
+      const uint64_t den = (uint64_t)bpmMilli * ppqn;
+      onGrid = onGrid && phase.nextTickUs() == anchorUs + n * 60000000000ULL / den;
+      long double error = phase.nextTickUs() * 1000.0L - (anchorNs + n * 60000000000000.0L / den);
+      if (error < 0) error = -error;
+      worstNs = max(worstNs, error);
+      withinDrift = withinDrift && error < 1000.0L * (changes + 1);
+      atBoundary = atBoundary && phase.bpm() == bpmMilli;
+      phase.advance();
+      n++;
+    }
+    if (pending) {
+      const uint64_t den = (uint64_t)bpmMilli * ppqn;
+      anchorUs += n * 60000000000ULL / den;
+      anchorNs += n * 60000000000000.0L / den;
+      n = 0;
+      bpmMilli = pending;
+      pending = 0;
+      changes++;
+    }
+  }
+  printf("  %u changes, worst %.0Lf ns from ideal\n", (unsigned)changes, worstNs);
+  check(atBoundary && phase.bpm() == 120500, "each tempo applies from the next beat");
+  check(onGrid, "ticks run from the new anchor");
+  check(withinDrift, "under 1us of drift per change");
+  check(phase.ticks() == 10000ULL * ppqn, "no tick lost or doubled");
+}
+
+// The ring between the loop and the MIDI task: full/empty, index wrap, counters,
+// then a million items through it from a second thread, in order
+static void checkSPSCQueue() {
+  printf("SPSCQueue\n");
+  SPSCQueue<uint32_t, 8> ring;
+  uint32_t item = 0;
+  check(ring.isEmpty() && !ring.pop(item), "a new ring is empty");
+  for (uint32_t i = 0; i < 8; i++) ring.push(i);
+  check(ring.size() == 8 && !ring.push(99), "the ninth push is refused");
+  check(ring.dropCount() == 1 && ring.highWaterMark() == 8, "a full ring counts the drop");
+
+  bool ordered = true;
+  for (uint32_t i = 0; i < 8; i++) ordered = ordered && ring.pop(item) && item == i;
+  check(ordered && ring.isEmpty() && !ring.pop(item), "items come out in order, then none");
+
+  // Slots wrap many times over; the fill level never passes 3
+  ring.resetStats();
+  uint32_t next = 0, expected = 0;
+  for (int round = 0; round < 1000; round++) {
+    for (int i = 0; i < 3; i++) ring.push(next++);
+    for (int i = 0; i < 3; i++) ordered = ordered && ring.pop(item) && item == expected++;
+  }
+  check(ordered && ring.isEmpty(), "order survives the slots wrapping");
+  check(ring.dropCount() == 0 && ring.highWaterMark() == 3, "counters after wrapping");
+
+  static SPSCQueue<uint32_t, MIDI_QUEUE_SIZE> shared;
+  const uint32_t total = 1000000;
+  std::thread producer([&]() {
+    for (uint32_t i = 0; i < total; i++) {
+      while (!shared.push(i)) std::this_thread::yield();
+    }
+  });
+  expected = 0;
+  ordered = true;
+  while (expected < total) {
+    if (shared.pop(item)) ordered = ordered && item == expected++;
+    else std::this_thread::yield();
+  }
+  producer.join();
+  printf("  %u items across threads, %u refused pushes, high water %u\n", (unsigned)total,
+         (unsigned)shared.dropCount(), (unsigned)shared.highWaterMark());
+  check(ordered && shared.isEmpty(), "two threads: nothing lost, nothing reordered");
+  check(shared.highWaterMark() <= MIDI_QUEUE_SIZE, "high water within capacity");
+}
+
+static TouchGesture seen[8];
+static int seenCount = 0;
+
+static void onGesture(const TouchGesture& gesture) {
+  if (seenCount < 8) seen[seenCount] = gesture;
+  seenCount++;
+}
+
+static bool saw(std::initializer_list<GestureType> types) {
+  if (seenCount != (int)types.size()) return false;
+  int i = 0;
+  for (GestureType type : types) {
+    if (seen[i++].type != type) return false;
+  }
+  return true;
+}
+
+// A press or release as updateTouch() takes it from the touch task
+static void touchAt(bool down, int16_t x, int16_t y, uint32_t timeUs) {
+  touch.x = x;
+  touch.y = y;
+  touch.isPressed = touch.justPressed = down;
+  touch.justReleased = !down;
+  if (down) gestures.press(x, y, timeUs);
+  else gestures.release(x, y, timeUs);
+}
+
+// Taps, a double tap, a long press, drags with and without a swipe, then
+// BACK in a mode: it leaves on the press, and the release must not reach the
+// menu as a tap on the settings icon underneath
+static void checkGestures() {
+  printf("Gesture recognizer\n");
+  gestures.reset();
+  gestures.setCallback(onGesture);
+
+  uint32_t t = 1000000;
+  seenCount = 0;
+  touchAt(true, 100, 100, t);
+  touchAt(false, 103, 98, t + 80000);
+  check(saw({GESTURE_TAP}), "tap");
+  seenCount = 0;
+  touchAt(true, 110, 104, t + 200000);
+  touchAt(false, 110, 104, t + 260000);
+  check(saw({GESTURE_TAP, GESTURE_DOUBLE_TAP}), "second tap close by: tap, double tap");
+  seenCount = 0;
+  touchAt(true, 110, 104, t + 400000);
+  touchAt(false, 110, 104, t + 450000);
+  check(saw({GESTURE_TAP}), "a third tap starts a new pair");
+  seenCount = 0;
+  touchAt(true, 300, 50, t + 700000);
+  touchAt(false, 300, 50, t + 760000);
+  check(saw({GESTURE_TAP}), "a tap elsewhere is no double tap");
+
+  t += 2000000;
+  seenCount = 0;
+  touchAt(true, 200, 150, t);
+  gestures.update(t + 500000);
+  check(seenCount == 0 && gestures.heldMs(t + 500000) == 500, "no long press before 600 ms");
+  gestures.move(204, 152, t + 550000);  // Within the slop
+  gestures.update(t + 600000);
+  check(saw({GESTURE_LONG_PRESS}), "long press while the finger is down");
+  touchAt(false, 204, 152, t + 900000);
+  check(saw({GESTURE_LONG_PRESS}), "its release is no tap");
+
+  // 200 px to the right in 100 ms
+  t += 2000000;
+  seenCount = 0;
+  touchAt(true, 50, 120, t);
+  for (int i = 1; i <= 10; i++) gestures.move(50 + i * 20, 120 + i, t + i * 10000);
+  bool dragged = seenCount == 11 && seen[0].type == GESTURE_DRAG_START && seen[1].type == GESTURE_DRAG &&
+                 seen[2].type == GESTURE_DRAG && seen[2].dx == 20 && seen[2].dy == 1;
+  seenCount = 0;
+  touchAt(false, 250, 130, t + 110000);
+  check(dragged, "drag start, then a drag per move");
+  check(saw({GESTURE_DRAG_END, GESTURE_SWIPE}) && seen[0].dx == 200 && seen[1].direction == SWIPE_RIGHT &&
+        seen[1].velocity >= 1000, "fast drag ends in a swipe right");
+
+  // The same distance up, slowing to a stop before the release
+  t += 2000000;
+  seenCount = 0;
+  touchAt(true, 200, 220, t);
+  for (int i = 1; i <= 10; i++) gestures.move(200, 220 - i * 20, t + i * 10000);
+  seenCount = 0;
+  touchAt(false, 200, 20, t + 400000);
+  check(saw({GESTURE_DRAG_END}) && seen[0].dy == -200, "a drag that stopped is no swipe");
+
+  // BACK (the header's top left) pressed in TB-3PO
+  Serial.setMuted(true);
+  initializeTB3POMode();
+  currentMode = TB3PO;
+  tb3po.readyForInput = true;
+  t += 2000000;
+  seenCount = 0;
+  touchAt(true, 10, 10, t);
+  handleTB3POMode();  // Leaves for the menu on the press
+  touchAt(false, 10, 10, t + 80000);
+  Serial.setMuted(false);
+  check(currentMode == MENU, "BACK leaves on the press");
+  check(seenCount == 0, "BACK's release is not a tap on the menu");
+
+  gestures.setCallback(nullptr);
+  touch.justReleased = false;
+}
+
+// Is every pixel of r inside one of the pending rectangles?
+static bool covered(const DirtyRegions& dirty, const DirtyRect& r) {
+  for (uint8_t i = 0; i < dirty.size(); i++) {
+    const DirtyRect& p = dirty[i];
+    if (r.x >= p.x && r.y >= p.y && r.x + r.w <= p.x + p.w && r.y + r.h <= p.y + p.h) return true;
+  }
+  return false;
+}
+
+static bool disjoint(const DirtyRegions& dirty) {
+  for (uint8_t i = 0; i < dirty.size(); i++) {
+    for (uint8_t j = i + 1; j < dirty.size(); j++) {
+      if (dirty[i].intersects(dirty[j])) return false;
+    }
+  }
+  return true;
+}
+
+// The compositor's dirty list: merging, clipping, the order pop() hands
+// rectangles out, and what happens once all slots are taken; then random
+// rectangles, after each of which every one added is still covered and no
+// two pending ones overlap
+static void checkDirtyRegions() {
+  printf("DirtyRegions\n");
+  DirtyRegions dirty(480, 320);
+  DirtyRect r;
+  dirty.add(10, 10, 50, 50);
+  dirty.add(40, 40, 50, 50);
+  check(dirty.size() == 1 && dirty[0].x == 10 && dirty[0].w == 80 && dirty[0].h == 80, "overlapping rectangles merge");
+  dirty.add(90, 10, 30, 80);
+  check(dirty.size() == 1 && dirty[0].w == 110, "a rectangle lined up beside it joins");
+  dirty.add(300, 200, 20, 20);
+  check(dirty.size() == 2, "a distant one stays separate");
+  dirty.add(-10, 300, 40, 100);
+  check(dirty.size() == 3 && dirty[2].x == 0 && dirty[2].y == 300 && dirty[2].w == 30 && dirty[2].h == 20,
+        "clipped to the screen");
+  dirty.add(500, 10, 20, 20);
+  check(dirty.size() == 3, "off screen adds nothing");
+  check(dirty.pop(r) && r.x == 10 && dirty.pop(r) && r.x == 300 && dirty.pop(r) && r.x == 0 && !dirty.pop(r),
+        "popped oldest first");
+
+  // Eight separate cells along the top, then a ninth under the third
+  for (int i = 0; i < DIRTY_REGIONS_MAX; i++) dirty.add(i * 60, 0, 10, 10);
+  check(dirty.size() == DIRTY_REGIONS_MAX, "eight separate rectangles fill the slots");
+  dirty.add(120, 40, 10, 10);
+  check(dirty.size() == DIRTY_REGIONS_MAX && dirty[DIRTY_REGIONS_MAX - 1].x == 120 &&
+        dirty[DIRTY_REGIONS_MAX - 1].y == 0 && dirty[DIRTY_REGIONS_MAX - 1].h == 50,
+        "with every slot taken, it joins the one that grows least");
+  dirty.addAll();
+  check(dirty.size() == 1 && dirty.totalArea() == 480 * 320, "addAll is one full-screen rectangle");
+
+  bool coveredAll = true, separate = true, bounded = true;
+  for (int round = 0; round < 2000; round++) {
+    dirty.clear();
+    DirtyRect added[24];
+    int count = 1 + fuzzNext() % 24;
+    for (int i = 0; i < count; i++) {
+      int x = (int)(fuzzNext() % 520) - 20;
+      int y = (int)(fuzzNext() % 360) - 20;
+      int w = 1 + fuzzNext() % 120;
+      int h = 1 + fuzzNext() % 80;
+      dirty.add(x, y, w, h);
+      // What add() keeps of it after clipping
+      int left = max(x, 0), top = max(y, 0);
+      int right = min(x + w, 480), bottom = min(y + h, 320);
+      added[i] = {(int16_t)left, (int16_t)top, (int16_t)(right - left), (int16_t)(bottom - top)};
+      for (int j = 0; j <= i; j++) coveredAll = coveredAll && (added[j].isEmpty() || covered(dirty, added[j]));
+      separate = separate && disjoint(dirty);
+      bounded = bounded && dirty.size() <= DIRTY_REGIONS_MAX;
+    }
+  }
+  check(coveredAll, "random: every added rectangle stays covered");
+  check(separate && bounded, "random: pending rectangles never overlap or overflow");
+}
+
+// Codes w x h pixels and decodes them row by row from an exactly sized copy
+// of the runs; true if every pixel comes back
+static bool iconRoundTrip(const uint16_t* pixels, uint16_t w, uint16_t h, size_t* bytes = nullptr) {
+  IconRLE icon;
+  if (!iconRLEPalette(pixels, w, h, icon)) return false;
+  icon.length = iconRLEEncode(pixels, icon, nullptr);
+  uint8_t* runs = (uint8_t*)malloc(icon.length ? icon.length : 1);
+  bool same = iconRLEEncode(pixels, icon, runs) == icon.length;
+  icon.runs = runs;
+  uint16_t line[320];
+  size_t pos = 0;
+  for (uint16_t y = 0; y < h && same; y++) {
+    pos = iconRLEDecodeRow(icon, pos, line);
+    same = memcmp(line, pixels + (size_t)y * w, w * sizeof(uint16_t)) == 0;
+  }
+  same = same && pos == icon.length;
+  free(runs);
+  if (bytes) *bytes = icon.length;
+  return same;
+}
+
+// The menu icons' run-length coding: runs of every length up to a full
+// 320 px row (one byte up to 15, two from 16, split past 271), random icons
+// of up to 16 colours, a 17th colour refused, and runs cut short
+static void checkIconRLE() {
+  printf("Icon RLE\n");
+  static uint16_t pixels[320 * 40];
+  bool runsOK = true;
+  size_t bytes = 0;
+  for (uint16_t length = 1; length <= 320; length++) {
+    for (uint16_t x = 0; x < 320; x++) pixels[x] = x < length ? 0xF800 : 0x001F;
+    runsOK = runsOK && iconRoundTrip(pixels, 320, 1, &bytes);
+    if (length == 15) runsOK = runsOK && bytes == 1 + 4;    // 15, then 305 = 271 + 34
+    if (length == 16) runsOK = runsOK && bytes == 2 + 4;    // 16, then 304 = 271 + 33
+    if (length == 271) runsOK = runsOK && bytes == 2 + 2;   // 271, then 49
+    if (length == 272) runsOK = runsOK && bytes == 2 + 1 + 2;  // 271 + 1, then 48
+  }
+  check(runsOK, "runs of 1 to 320 pixels round trip, in the expected bytes");
+
+  bool randomOK = true;
+  for (int round = 0; round < 500; round++) {
+    uint16_t w = 1 + fuzzNext() % 320, h = 1 + fuzzNext() % 40;
+    uint16_t palette[ICON_RLE_COLORS];
+    uint8_t colors = 1 + fuzzNext() % ICON_RLE_COLORS;
+    for (uint8_t c = 0; c < colors; c++) palette[c] = fuzzNext();
+    uint16_t color = palette[0];
+    for (size_t i = 0; i < (size_t)w * h; i++) {
+      if (fuzzNext() % 24 == 0) color = palette[fuzzNext() % colors];  // Mostly long runs
+      pixels[i] = color;
+    }
+    randomOK = randomOK && iconRoundTrip(pixels, w, h);
+  }
+  check(randomOK, "random icons of up to 16 colours round trip");
+
+  for (int i = 0; i < 17; i++) pixels[i] = i * 1000;
+  IconRLE icon;
+  check(!iconRLEPalette(pixels, 17, 1, icon) && iconRLEPalette(pixels, 16, 1, icon) && icon.colors == 16,
+        "a 17th colour is refused");
+
+  // Ends on a long-run marker whose length byte is missing
+  const uint8_t cut[] = {0x13, 0x00};
+  uint8_t* runs = (uint8_t*)malloc(sizeof(cut));
+  memcpy(runs, cut, sizeof(cut));
+  icon.width = 40;
+  icon.height = 1;
+  icon.runs = runs;
+  icon.length = sizeof(cut);
+  uint16_t line[40];
+  check(iconRLEDecodeRow(icon, 0, line) == sizeof(cut), "runs cut short end the row, not read past it");
+  free(runs);
+}
+
+// The calibration fit: 9 points read through a known panel-to-screen map
+// (scaled, then swapped and mirrored, then rotated and skewed) give that map
+// back to within a pixel anywhere on the panel, with read noise as well; 3
+// points in a line or too few points are refused
+static void checkTouchAffine() {
+  printf("TouchAffine\n");
+  const double maps[3][6] = {
+    {0.13, 0, -26, 0, 0.0865, -20.8},          // Scale and offset
+    {0, -0.13, 500, 0.0865, 0, -17},           // Axes swapped, X mirrored
+    {0.1299, 0.0045, -31, -0.0035, 0.0864, -12},  // Rotated about 2 degrees, skewed
+  };
+  for (int m = 0; m < 3; m++) {
+    const double* k = maps[m];
+    for (int noise = 0; noise <= 12; noise += 12) {
+      TouchCalPoint points[9];
+      for (int i = 0; i < 9; i++) {
+        uint16_t rawX = 400 + (i % 3) * 1600, rawY = 400 + (i / 3) * 1600;
+        points[i].screenX = (int16_t)lround(k[0] * rawX + k[1] * rawY + k[2]);
+        points[i].screenY = (int16_t)lround(k[3] * rawX + k[4] * rawY + k[5]);
+        points[i].rawX = rawX + (noise ? (int)(fuzzNext() % (2 * noise + 1)) - noise : 0);
+        points[i].rawY = rawY + (noise ? (int)(fuzzNext() % (2 * noise + 1)) - noise : 0);
+      }
+      TouchAffine fit;
+      bool solved = fit.solve(points, 9);
+      double worst = 0;
+      for (uint16_t rawY = 300; solved && rawY <= 3800; rawY += 100) {
+        for (uint16_t rawX = 300; rawX <= 3800; rawX += 100) {
+          int32_t x, y;
+          fit.apply(rawX, rawY, x, y);
+          worst = max(worst, fabs(x - (k[0] * rawX + k[1] * rawY + k[2])));
+          worst = max(worst, fabs(y - (k[3] * rawX + k[4] * rawY + k[5])));
+        }
+      }
+      printf("  map %d, noise +-%2d raw: residual rms %.2f px, off by up to %.2f px on the panel\n", m, noise,
+             solved ? fit.errorRmsPx : -1.0f, worst);
+      check(solved && worst <= (noise ? 2.0 : 1.0), "the fit recovers the map");
+      check(solved && fit.errorMaxPx <= (noise ? 2.0f : 1.0f), "residual within a pixel or two");
+    }
+  }
+
+  TouchCalPoint line[3] = {{10, 10, 400, 400}, {160, 160, 2000, 2000}, {310, 310, 3600, 3600}};
+  TouchAffine fit;
+  check(!fit.solve(line, 3) && !fit.solve(line, 2), "points in a line, or too few, are refused");
+}
+
+// The latency buckets: 0-7 us exact, then quarters of each power of two up
+// to 2^24 us, the rest in the last bucket; bucket bounds that meet, widths
+// within 25% of their values, and percentiles never below the true value,
+// above the top of its bucket or above the largest duration seen
+static void checkLatencyHistogram() {
+  printf("LatencyHistogram\n");
+  bool exact = true;
+  for (uint32_t us = 0; us < 8; us++) {
+    exact = exact && LatencyHistogram::bucketOf(us) == us && LatencyHistogram::upperBound(us) == us;
+  }
+  check(exact, "0-7 us have a bucket each");
+
+  bool meet = true, narrow = true;
+  for (uint8_t i = 8; i < LATENCY_HISTOGRAM_BUCKETS - 1; i++) {
+    uint32_t lower = LatencyHistogram::upperBound(i - 1) + 1, upper = LatencyHistogram::upperBound(i);
+    meet = meet && LatencyHistogram::bucketOf(lower) == i && LatencyHistogram::bucketOf(upper) == i &&
+           LatencyHistogram::bucketOf(upper + 1) == i + 1;
+    narrow = narrow && (upper - lower + 1) * 4 <= lower;
+  }
+  check(meet, "each bucket starts where the last one ends");
+  check(narrow, "no bucket wider than a quarter of its values");
+  check(LatencyHistogram::bucketOf((1u << 24) - 1) == LATENCY_HISTOGRAM_BUCKETS - 2 &&
+        LatencyHistogram::bucketOf(1u << 24) == LATENCY_HISTOGRAM_BUCKETS - 1 &&
+        LatencyHistogram::bucketOf(UINT32_MAX) == LATENCY_HISTOGRAM_BUCKETS - 1 &&
+        LatencyHistogram::upperBound(LATENCY_HISTOGRAM_BUCKETS - 1) == UINT32_MAX,
+        "2^24 us and up share the last bucket");
+
+  LatencyHistogram histogram;
+  check(histogram.percentile(50) == 0 && histogram.maxUs() == 0, "an empty histogram answers 0");
+
+  // Log-uniform durations, as latencies tend to be, and the odd stall
+  static uint32_t samples[10000];
+  bool bounded = true;
+  for (int round = 0; round < 20; round++) {
+    histogram.reset();
+    int count = 1 + fuzzNext() % 10000;
+    for (int i = 0; i < count; i++) {
+      samples[i] = fuzzNext() % 64 == 0 ? fuzzNext() : fuzzNext() >> (fuzzNext() % 32);
+      histogram.add(samples[i]);
+    }
+    std::sort(samples, samples + count);
+    const uint8_t percents[] = {0, 1, 50, 90, 99, 100};
+    for (uint8_t percent : percents) {
+      uint32_t rank = max(1u, (uint32_t)(((uint64_t)count * percent + 99) / 100));
+      uint32_t truth = samples[rank - 1];
+      uint32_t got = histogram.percentile(percent);
+      bounded = bounded && got >= truth && got <= histogram.maxUs() &&
+                got <= LatencyHistogram::upperBound(LatencyHistogram::bucketOf(truth));
+    }
+    bounded = bounded && histogram.count() == (uint32_t)count && histogram.maxUs() == samples[count - 1] &&
+              histogram.percentile(100) == samples[count - 1];
+  }
+  check(bounded, "percentiles lie between the true value and the top of its bucket");
+}
+
+static int gridPaints = 0;
+static void countGridPaint(uint8_t, uint8_t, uint8_t) { gridPaints++; }
+
+// Step grid repaints: every cell once after invalidate(), then only the
+// cells whose state changed - a playhead moving over 16 steps is 2 cells a row
+static void checkStepGrid() {
+  printf("StepGrid\n");
+  StepGrid<4, 16> grid(countGridPaint);
+  for (uint8_t row = 0; row < 4; row++) {
+    for (uint8_t col = 0; col < 16; col++) grid.set(row, col, col % 4 == 0);
+  }
+  check(gridPaints == 64, "every cell painted after invalidate()");
+
+  bool twoPerRow = true;
+  for (int step = 0; step < 32; step++) {
+    gridPaints = 0;
+    for (uint8_t row = 0; row < 4; row++) {
+      for (uint8_t col = 0; col < 16; col++) grid.set(row, col, (col % 4 == 0) | (col == step % 16) << 1);
+    }
+    twoPerRow = twoPerRow && gridPaints == (step == 0 ? 4 : 8);  // Old and new playhead cell
+  }
+  check(twoPerRow && grid.state(2, 15) == 2 && grid.state(2, 12) == 1, "a playhead move repaints two cells a row");
+
+  gridPaints = 0;
+  grid.assume(0, 5, 7);
+  check(!grid.set(0, 5, 7) && !grid.set(4, 0, 1) && !grid.set(0, 16, 1) && gridPaints == 0,
+        "cells painted by a full draw, or out of range, are skipped");
+  grid.invalidate();
+  check(grid.set(0, 5, 7) && gridPaints == 1, "invalidate() repaints");
+}
+
+// BLE-MIDI input: random message streams packed by BLEMIDIPacket and parsed
+// back, SysEx split over packets, then random bytes. Run under
+// -fsanitize=address to catch reads past a packet as well.
+struct ParsedStream {
+  MIDIInputEvent events[64];
+  int count;
+  uint8_t sysex[BLE_MIDI_SYSEX_MAX];
+  int sysexLength;  // -1 = none delivered
+  bool wellFormed;
+};
+
+static void onParsedEvent(const MIDIInputEvent& event, void* context) {
+  ParsedStream& out = *(ParsedStream*)context;
+  out.wellFormed = out.wellFormed && (event.status & 0x80) && event.data1 < 0x80 && event.data2 < 0x80 &&
+                   event.timestampMs < 0x2000;
+  if (out.count < 64) out.events[out.count] = event;
+  out.count++;
+}
+
+static void onParsedSysEx(const uint8_t* data, size_t length, uint16_t, void* context) {
+  ParsedStream& out = *(ParsedStream*)context;
+  out.wellFormed = out.wellFormed && length <= BLE_MIDI_SYSEX_MAX;
+  for (size_t i = 0; i < length && i < BLE_MIDI_SYSEX_MAX; i++) {
+    out.wellFormed = out.wellFormed && data[i] < 0x80;
+    out.sysex[i] = data[i];
+  }
+  out.sysexLength = (int)length;
+}
+
+// Exactly sized copy, so a read past the end is a read past the allocation
+static void parseExact(BLEMIDIParser& parser, const uint8_t* data, size_t length) {
+  uint8_t* copy = (uint8_t*)malloc(length ? length : 1);
+  memcpy(copy, data, length);
+  parser.parse(copy, length);
+  free(copy);
+}
+
+static void fuzzBLEMIDIParser() {
+  printf("BLE-MIDI parser: round trips and random bytes\n");
+  ParsedStream out = {};
+  BLEMIDIParser parser;
+  parser.setHandler(onParsedEvent, &out);
+  parser.setSysExHandler(onParsedSysEx, &out);
+
+  // Random channel and realtime messages through the packer, a packet at a
+  // time: same status often, so running status is exercised
+  bool roundTrips = true;
+  uint32_t messages = 0, packets = 0;
+  uint32_t timeMs = 0;
+  for (int stream = 0; stream < 2000; stream++) {
+    BLEMIDIPacket packet;
+    packet.setMTU(BLE_MIDI_DEFAULT_MTU + fuzzNext() % 160);
+    MIDIInputEvent sent[64];
+    int count = 0;
+    uint8_t status = 0x90;
+    while (count < 64) {
+      uint8_t msg[3];
+      uint8_t length;
+      if (fuzzNext() % 8 == 0) {
+        static const uint8_t realtime[] = {0xF8, 0xFA, 0xFB, 0xFC};
+        msg[0] = realtime[fuzzNext() % 4];
+        length = 1;
+      } else {
+        if (fuzzNext() % 2) status = 0x80 | (fuzzNext() % 7) << 4 | (fuzzNext() % 16);
+        msg[0] = status;
+        length = ((status & 0xF0) == 0xC0 || (status & 0xF0) == 0xD0) ? 2 : 3;
+      }
+      msg[1] = length > 1 ? fuzzNext() & 0x7F : 0;
+      msg[2] = length > 2 ? fuzzNext() & 0x7F : 0;
+      timeMs += fuzzNext() % 4 == 0 ? fuzzNext() % 40 : 0;
+      if (!packet.append(msg, length, timeMs)) break;  // Full, or its time span used up
+      sent[count++] = {msg[0], msg[1], msg[2], (uint16_t)(timeMs & 0x1FFF)};
+    }
+    out.count = 0;
+    out.wellFormed = true;
+    parseExact(parser, packet.data(), packet.size());
+    roundTrips = roundTrips && out.wellFormed && out.count == count;
+    for (int i = 0; i < count && roundTrips; i++) {
+      roundTrips = out.events[i].status == sent[i].status && out.events[i].data1 == sent[i].data1 &&
+                   out.events[i].data2 == sent[i].data2 && out.events[i].timestampMs == sent[i].timestampMs;
+    }
+    messages += count;
+    packets++;
+  }
+  printf("  %u messages in %u packets\n", (unsigned)messages, (unsigned)packets);
+  check(roundTrips && parser.errorCount() == 0, "packed messages parse back unchanged");
+
+  // Running status carried into the next packet
+  const uint8_t first[] = {0x80, 0x80, 0x93, 0x3C, 0x40};
+  const uint8_t second[] = {0x80, 0x81, 0x3E, 0x41};
+  out.count = 0;
+  parseExact(parser, first, sizeof(first));
+  parseExact(parser, second, sizeof(second));
+  check(out.count == 2 && out.events[1].status == 0x93 && out.events[1].data1 == 0x3E &&
+        out.events[1].timestampMs == 1, "running status continues in the next packet");
+
+  // SysEx of every length up to twice the buffer, split at random, with a
+  // clock byte in the middle; longer than the buffer is dropped and counted
+  bool sysexOK = true;
+  for (int length = 0; length <= 2 * BLE_MIDI_SYSEX_MAX; length++) {
+    uint8_t body[2 * BLE_MIDI_SYSEX_MAX];
+    for (int i = 0; i < length; i++) body[i] = fuzzNext() & 0x7F;
+    out.count = 0;
+    out.sysexLength = -1;
+    uint32_t errorsBefore = parser.errorCount();
+
+    uint8_t data[BLE_MIDI_MAX_PACKET];
+    size_t n = 0;
+    data[n++] = 0x80;
+    data[n++] = 0x80;
+    data[n++] = 0xF0;
+    int sent = 0;
+    int clockAt = length / 2;
+    while (true) {
+      int chunk = 1 + fuzzNext() % 20;
+      while (chunk-- && sent < length) {
+        if (sent == clockAt && clockAt > 0) {
+          data[n++] = 0x81;
+          data[n++] = 0xF8;
+          clockAt = -1;
+        }
+        data[n++] = body[sent++];
+      }
+      if (sent == length) break;
+      parseExact(parser, data, n);  // Continues after the next header
+      n = 0;
+      data[n++] = 0x80;
+    }
+    data[n++] = 0x82;
+    data[n++] = 0xF7;
+    parseExact(parser, data, n);
+
+    bool delivered = out.sysexLength == length && memcmp(out.sysex, body, length) == 0;
+    bool clockSeen = length < 2 || (out.count == 1 && out.events[0].status == 0xF8);
+    if (length <= BLE_MIDI_SYSEX_MAX) sysexOK = sysexOK && delivered && clockSeen && parser.errorCount() == errorsBefore;
+    else sysexOK = sysexOK && out.sysexLength == -1 && clockSeen && parser.errorCount() == errorsBefore + 1;
+  }
+  check(sysexOK, "SysEx split over packets, with realtime inside");
+
+  // Random bytes, often with a valid header: whatever comes out is well formed,
+  // and a valid packet afterwards still decodes
+  bool recovers = true;
+  out.wellFormed = true;
+  for (int i = 0; i < 200000; i++) {
+    uint8_t data[64];
+    size_t length = fuzzNext() % sizeof(data);
+    for (size_t b = 0; b < length; b++) data[b] = fuzzNext();
+    if (length && fuzzNext() % 2) data[0] = 0x80 | (data[0] & 0x3F);
+    out.count = 0;
+    parseExact(parser, data, length);
+    if (i % 1000 == 999) {
+      const uint8_t valid[] = {0x80, 0x85, 0xB2, 0x07, 0x64};
+      out.count = 0;
+      parseExact(parser, valid, sizeof(valid));
+      recovers = recovers && out.count >= 1 && out.events[out.count - 1].status == 0xB2 &&
+                 out.events[out.count - 1].data1 == 0x07 && out.events[out.count - 1].data2 == 0x64;
+    }
+  }
+  printf("  200000 random packets, %u errors counted\n", (unsigned)parser.errorCount());
+  check(out.wellFormed, "random bytes only ever give well-formed events");
+  check(recovers, "a valid packet decodes after random bytes");
+}
+
+static BLEMIDIParser received;
+static int noteOns = 0, noteOffs = 0, realtime = 0, packets = 0;
+
+static void onMIDI(const MIDIInputEvent& event, void*) {
+  if ((event.status & 0xF0) == 0x90 && event.data2 > 0) noteOns++;
+  else if ((event.status & 0xF0) == 0x80 || (event.status & 0xF0) == 0x90) noteOffs++;
+  else if (event.status >= 0xF8) realtime++;
+}
+
+static void onNotify(const uint8_t* data, size_t length) {
+  packets++;
+  received.parse(data, length);
+}
+
+static void playEuclidean() {
+  printf("MIDI task: Euclidean engine for 1s at 120 BPM\n");
+  pCharacteristic = new BLECharacteristic();
+  BLECharacteristic::onNotify = onNotify;
+  received.setHandler(onMIDI);
+  globalState.bleConnected = true;
+  globalState.bpm = 120;
+
+  MIDIThread::begin();
+  Serial.setMuted(true);
+  initializeEuclideanMode();  // Generates the default four voices
+  Serial.setMuted(false);
+  euclideanState.resyncPending = true;
+  GeneratorRuntime::setPlaying(ENGINE_EUCLIDEAN, true);
+  delay(1000);
+  GeneratorRuntime::setPlaying(ENGINE_EUCLIDEAN, false);
+  delay(100);  // Last note-offs
+
+  // 8 sixteenths per second; the four default voices have 21 hits in 16 steps
+  printf("  %d packets, %d note-ons, %d note-offs\n", packets, noteOns, noteOffs);
+  check(noteOns >= 8 && noteOns <= 14, "about 10 note-ons in a second");
+  check(noteOffs >= noteOns - 4, "notes are released");
+}
+
+// An open hat gated longer than a step: the first note's off is due while
+// the retriggered note sounds and must not cut it
+static void retriggerOverlappingNote() {
+  printf("MIDI task: retrigger before the earlier note-off\n");
+  uint8_t channel = globalState.currentMidiChannel;
+  int offsBefore = noteOffs;
+  uint32_t t0 = micros() + 10000;
+  scheduleNote(46, 100, t0, 300000);
+  scheduleNote(46, 100, t0 + 125000, 300000);
+  delay(210);
+  check(MIDIThread::isNoteActive(channel, 46), "the retriggered note sounds");
+  delay(150);  // Past the first note's off
+  check(MIDIThread::isNoteActive(channel, 46), "the first note's off does not cut the second");
+  delay(100);  // Past the second note's off
+  check(!MIDIThread::isNoteActive(channel, 46), "the second note's off releases it");
+  check(noteOffs - offsBefore == 1, "one note-off on the wire");
+}
+
+// TB-3PO with every step slid into the same pitch: one tied note, struck
+// once and held, not retriggered on every step
+static void playTB3POTie() {
+  printf("MIDI task: TB-3PO slides into the same pitch\n");
+  Serial.setMuted(true);
+  initializeTB3POMode();
+  Serial.setMuted(false);
+  tb3po.lockSeed = true;
+  tb3po.gates = tb3po.slides = 0xFFFF;
+  tb3po.oct_ups = tb3po.oct_downs = 0;
+  memset(tb3po.notes, 0, sizeof(tb3po.notes));
+  int onsBefore = noteOns;
+  GeneratorRuntime::setPlaying(ENGINE_TB3PO, true);
+  delay(100);
+  bool held = true;
+  int note = tb3po.currentNote;
+  for (int i = 0; i < 16; i++) {
+    held = held && note >= 0 && MIDIThread::isNoteActive(globalState.currentMidiChannel, note);
+    delay(50);
+  }
+  GeneratorRuntime::setPlaying(ENGINE_TB3PO, false);
+  delay(50);
+  printf("  %d note-ons in 0.9s\n", noteOns - onsBefore);
+  check(noteOns - onsBefore == 1, "tied steps are not struck again");
+  check(held, "the tied note sounds throughout");
+  check(!MIDIThread::isNoteActive(globalState.currentMidiChannel, note), "stopping ends the tie");
+}
+
+// The arp on its own plays on the transport without running the receiver's:
+// a held key sends notes but no START, clock or STOP. A background engine
+// joining it starts the receiver's transport.
+static void playArpAlone() {
+  printf("MIDI task: arpeggiator on its own, then with Euclidean\n");
+  Serial.setMuted(true);
+  initializeArpeggiatorMode();
+  int onsBefore = noteOns, realtimeBefore = realtime;
+  arpeggiatorNoteInput(60, true);
+  delay(1000);  // Eighths: four at 120 BPM
+  int ons = noteOns - onsBefore, sent = realtime - realtimeBefore;
+  GeneratorRuntime::setPlaying(ENGINE_EUCLIDEAN, true);
+  delay(200);
+  int joined = realtime - realtimeBefore;
+  GeneratorRuntime::setPlaying(ENGINE_EUCLIDEAN, false);
+  arpeggiatorNoteInput(60, false);
+  GeneratorRuntime::stopForeground();
+  delay(100);
+  Serial.setMuted(false);
+  printf("  %d arp notes, %d realtime alone, %d with Euclidean\n", ons, sent, joined);
+  check(ons >= 4, "a held key arpeggiates");
+  check(sent == 0, "no START, clock or STOP for the arp alone");
+  check(joined > 0, "Euclidean joining sends START and clock");
+}
+
+// A tap on TB-3PO's PLAY repaints its layers, not the screen
+static void pressTB3POPlay() {
+  touch.x = 50;
+  touch.y = SCREEN_HEIGHT - 45;
+  touch.isPressed = touch.justPressed = true;
+  tb3po.readyForInput = true;
+  nativeTFTStats = {};
+  handleTB3POMode();  // Press feedback and the step boxes
+  touch.isPressed = touch.justPressed = false;
+  UICompositor::update();
+}
+
+static void repaintTB3PO() {
+  printf("Compositor: TB-3PO PLAY and STOP\n");
+  Serial.setMuted(true);
+  initializeTB3POMode();
+  nativeTFTStats = {};
+  drawTB3POMode();
+  uint64_t full = nativeTFTStats.pixels;
+  pressTB3POPlay();
+  uint64_t play = nativeTFTStats.pixels;
+  check(GeneratorRuntime::isPlaying(ENGINE_TB3PO), "PLAY starts TB-3PO");
+  pressTB3POPlay();
+  uint64_t stop = nativeTFTStats.pixels;
+  Serial.setMuted(false);
+  printf("  full draw %llu px, PLAY %llu px, STOP %llu px\n", (unsigned long long)full,
+         (unsigned long long)play, (unsigned long long)stop);
+  check(!GeneratorRuntime::isPlaying(ENGINE_TB3PO), "STOP stops TB-3PO");
+  check(play > 0 && play < full / 2 && stop < full / 2, "a press repaints less than half the full draw");
+  check(!UICompositor::isPending(), "nothing left to repaint");
+}
+
+int main(int argc, char** argv) {
+  bool updateGolden = argc > 1 && strcmp(argv[1], "--update-golden") == 0;
+  nativeUseVirtualTime();
+
+  benchmarkGenerators();
+  checkSPSCQueue();
+  checkClockPhaseDrift();
+  checkClockPhaseTempoChange();
+  fuzzBLEMIDIParser();
+  checkGestures();
+  checkDirtyRegions();
+  checkIconRLE();
+  checkTouchAffine();
+  checkLatencyHistogram();
+  checkStepGrid();
+  playEuclidean();
+  retriggerOverlappingNote();
+  playTB3POTie();
+  playArpAlone();
+  printf("Golden MIDI logs%s\n", updateGolden ? " (updating)" : "");
+  LatencyTrace::reset();
+  failures += runGoldenMIDI(updateGolden);
+
+  // Virtual time: only the waits (polls, scheduling) show up
+  printf("Latency trace\n");
+  LatencyTrace::printReport();
+  check(LatencyTrace::histogram(LATENCY_TICK).count() > 0 && LatencyTrace::histogram(LATENCY_DUE).count() > 0 &&
+        LatencyTrace::histogram(LATENCY_NOTIFY).count() > 0, "MIDI task stages are traced");
+  repaintTB3PO();
+  printf("%s\n", failures ? "FAILED" : "OK");
+  fflush(stdout);
+  _Exit(failures ? 1 : 0);  // The MIDI task never returns
+}
@@ -43,6 +43,11 @@
 #include "ui_elements.h"
 // #include "ui_manager.h"  // Will be used after mode migration to event-driven UI
 #include "midi_utils.h"
+#include "ble_midi_packet.h"
+#include "clock_engine.h"
+#include "ui_compositor.h"
+#include "play_area_renderer.h"
+#include "menu_icon_atlas.h"
 
 // Hardware setup
 #define XPT2046_IRQ 36
@@ -64,9 +69,14 @@ uint64_t sdCardUsed = 0;
 uint8_t midiChannel = 1;  // MIDI channel 1-16
 bool bleEnabled = true;
 
-// Press tracking for 3-second hold
-unsigned long pressStartTime = 0;
-bool longPressTriggered = false;
+// Screens of the menu mode, all driven by gestures (onMenuGesture)
+enum MenuScreen {
+  MENU_ICONS,
+  MENU_SETTINGS,
+  MENU_BLE_INFO,
+  MENU_SD_INFO
+};
+MenuScreen menuScreen = MENU_ICONS;
 
 // Screenshot counter
 int screenshotCount = 0;
@@ -83,13 +93,19 @@ TFT_eSPI tft = TFT_eSPI();
 
 // BLE MIDI globals
 BLECharacteristic *pCharacteristic;
-uint8_t midiPacket[] = {0x80, 0x80, 0x00, 0x60, 0x7F};
 
 // MIDI Clock sync
 MIDIClockSync midiClock;
+TempoTracker clockTracker;
 
 // Touch state
 TouchState touch;
+GestureRecognizer gestures;
+
+// Set from BLE callbacks, handled in loop() (MIDIThread::send* is loop-only,
+// and so is drawing: the menu's icon atlas, compositor and sprite strips)
+volatile bool midiPanicPending = false;
+volatile bool menuRedrawPending = false;
 
 // App state
 AppMode currentMode = MENU;
@@ -108,7 +124,12 @@ uint8_t getTouchRotation() {
 
 // Forward declarations
 void drawMenu();
+GeneratorEngine engineForMode(AppMode mode);
+void paintMenuIcon(TFT_eSPI& gfx, uint8_t index, int16_t iconSize);
 void showSettingsMenu(bool interactive = true);
+void onMenuGesture(const TouchGesture& gesture);
+int menuAppAtTouch();
+void showBluetoothStatus();
 
 // Scalable App Icon System
 // To add new apps, see DEV_NOTES.md for complete step-by-step guide
@@ -118,7 +139,7 @@ void showSettingsMenu(bool interactive = true);
 // 3. Include header in this file
 // 4. Add to initialization, loop, and enterMode switch statements
 // 5. Add entry to apps[] array below
-// 6. Add graphics case to drawAppGraphics() function
+// 6. Add graphics case to drawAppGraphics() function (draw on gfx, not tft)
 // 7. Increment numApps
 struct AppIcon {
   String name;
@@ -154,20 +175,22 @@ class MIDICallbacks: public BLEServerCallbacks {
     void onConnect(BLEServer* pServer) {
       globalState.bleConnected = true;
       Serial.println("BLE connected");
-      if (currentMode == MENU) {
-        drawMenu(); // Redraw menu to clear "BLE WAITING..."
-      }
+      menuRedrawPending = true;  // Clear "BLE WAITING..." from the loop task
+    }
+    void onMtuChanged(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) {
+      // Larger MTU lets the MIDI thread pack more messages per notification
+      MIDIThread::setMTU(param->mtu.mtu);
+      Serial.printf("BLE MTU negotiated: %d\n", param->mtu.mtu);
     }
     void onDisconnect(BLEServer* pServer) {
       globalState.bleConnected = false;
+      MIDIThread::setMTU(BLE_MIDI_DEFAULT_MTU);
       Serial.println("BLE disconnected - sending All Notes Off");
       
-      if (currentMode == MENU) {
-        drawMenu(); // Redraw menu to show "BLE WAITING..."
-      }
-      
-      // Stop all notes using threaded MIDI (more reliable than loop)
-      stopAllModes();
+      // Stop all notes and show "BLE WAITING..." from the loop task - the MIDI
+      // ring only has one producer, and the menu is drawn by the loop
+      midiPanicPending = true;
+      menuRedrawPending = true;
       
       // Restart advertising to allow reconnection
       delay(500); // Brief delay before restarting advertising
@@ -176,60 +199,80 @@ class MIDICallbacks: public BLEServerCallbacks {
     }
 };
 
+// Incoming realtime messages - runs in the BLE callback (see MIDIInput)
+void handleMIDIRealtime(uint8_t status) {
+  // MIDI Clock (0xF8) - 24 ppqn (24 pulses per quarter note)
+  if (status == 0xF8) {
+    unsigned long now = millis();
+    
+    // Tempo from a regression over microsecond arrival times (see TempoTracker)
+    clockTracker.addTick(micros());
+    TempoEstimate tempo = clockTracker.estimate();
+    if (tempo.locked) {
+      midiClock.calculatedBPM = clockTracker.bpm();
+      midiClock.clockInterval = (unsigned long)(tempo.tickUs / 1000.0f + 0.5f);
+      
+      // Pull the transport onto the master's beats, not just its tempo
+      if (tempo.anchorTick % MIDI_CLOCK_PPQN == 0) {
+        ClockEngine::follow(midiClock.calculatedBPM, tempo.anchorUs);
+      }
+    }
+    
+    midiClock.lastClockTime = now;
+    midiClock.clockCount++;
+    midiClock.isReceiving = true;
+    midiClock.lastBPMUpdate = now;
+  }
+  // MIDI Start (0xFA)
+  else if (status == 0xFA) {
+    midiClock.isPlaying = true;
+    midiClock.clockCount = 0;
+    clockTracker.reset();  // Tick 0 is the downbeat
+    Serial.println("MIDI Start received");
+  }
+  // MIDI Stop (0xFC)
+  else if (status == 0xFC) {
+    midiClock.isPlaying = false;
+    Serial.println("MIDI Stop received");
+  }
+  // MIDI Continue (0xFB)
+  else if (status == 0xFB) {
+    midiClock.isPlaying = true;
+    Serial.println("MIDI Continue received");
+  }
+}
+
 class MIDICharacteristicCallbacks: public BLECharacteristicCallbacks {
     void onWrite(BLECharacteristic *pCharacteristic) {
       std::string value = pCharacteristic->getValue();
       
-      if (value.length() >= 3) {
-        // BLE MIDI packet format: timestamp(2 bytes) + MIDI status + data...
-        uint8_t status = value[2];
-        
-        // MIDI Clock (0xF8) - 24 ppqn (24 pulses per quarter note)
-        if (status == 0xF8) {
-          unsigned long now = millis();
-          
-          if (midiClock.lastClockTime > 0) {
-            midiClock.clockInterval = now - midiClock.lastClockTime;
-            
-            // Calculate BPM: 24 clocks per quarter note
-            // BPM = 60000 / (interval_ms * 24)
-            if (midiClock.clockInterval > 0) {
-              float bpm = 60000.0 / (midiClock.clockInterval * 24.0);
-              
-              // Smooth BPM calculation with averaging
-              if (midiClock.clockCount > 24) {
-                midiClock.calculatedBPM = (midiClock.calculatedBPM * 0.9) + (bpm * 0.1);
-              } else {
-                midiClock.calculatedBPM = bpm;
-              }
-            }
-          }
-          
-          midiClock.lastClockTime = now;
-          midiClock.clockCount++;
-          midiClock.isReceiving = true;
-          midiClock.lastBPMUpdate = now;
-        }
-        // MIDI Start (0xFA)
-        else if (status == 0xFA) {
-          midiClock.isPlaying = true;
-          midiClock.clockCount = 0;
-          Serial.println("MIDI Start received");
-        }
-        // MIDI Stop (0xFC)
-        else if (status == 0xFC) {
-          midiClock.isPlaying = false;
-          Serial.println("MIDI Stop received");
-        }
-        // MIDI Continue (0xFB)
-        else if (status == 0xFB) {
-          midiClock.isPlaying = true;
-          Serial.println("MIDI Continue received");
-        }
-      }
+      // Full BLE-MIDI decode: realtime is handled here, everything else is
+      // queued for the loop (processMIDIInput)
+      MIDIInput::receive((const uint8_t*)value.data(), value.length());
     }
 };
 
+// Route queued notes from an external controller to the active mode
+void processMIDIInput() {
+  MIDIInputEvent event;
+  while (MIDIInput::read(event)) {
+    uint8_t type = event.status & 0xF0;
+    if (type != 0x90 && type != 0x80) continue;
+    bool on = (type == 0x90 && event.data2 > 0);
+    
+    switch (currentMode) {
+      case ARPEGGIATOR:
+        arpeggiatorNoteInput(event.data1, on);
+        break;
+      case AUTO_CHORD:
+        autoChordNoteInput(event.data1, on);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
 // Icon drawing functions moved to ui_elements.h for consistency
 
 void initSDCard() {
@@ -343,20 +386,9 @@ void showSDCardInfo() {
     SD.end(); // Release SPI
   }
   
-  // Back button
-  int backBtnX3 = (SCREEN_WIDTH - 100) / 2;
-  int backBtnY3 = SCREEN_HEIGHT - 60;
-  drawRoundButton(backBtnX3, backBtnY3, 100, 35, "BACK", THEME_PRIMARY);
-  
-  // Wait for back button
-  while (true) {
-    updateTouch();
-    if (touch.justPressed && isButtonPressed(backBtnX3, backBtnY3, 100, 35)) {
-      drawMenu();
-      return;
-    }
-    delay(20);
-  }
+  // Back button (handled by onMenuGesture)
+  drawRoundButton((SCREEN_WIDTH - 100) / 2, SCREEN_HEIGHT - 60, 100, 35, "BACK", THEME_PRIMARY);
+  menuScreen = MENU_SD_INFO;
 }
 
 void saveScreenshot(String filename) {
@@ -462,7 +494,7 @@ void cycleModesForScreenshots() {
   tft.setTextColor(THEME_TEXT, THEME_BG);
   tft.drawCentreString("Saving screenshots to SD", SCREEN_WIDTH/2, 60, 2);
   tft.setTextColor(THEME_TEXT_DIM, THEME_BG);
-  tft.drawCentreString("Hold 3 seconds to skip", SCREEN_WIDTH/2, 90, 2);
+  tft.drawCentreString("Hold 3 seconds to skip the rest", SCREEN_WIDTH/2, 90, 2);
   
   AppMode modes[] = {KEYBOARD, SEQUENCER, BOUNCING_BALL, PHYSICS_DROP, 
                      RANDOM_GENERATOR, XY_PAD, ARPEGGIATOR, PADS, 
@@ -538,30 +570,25 @@ void cycleModesForScreenshots() {
     Serial.printf("[Screenshot %d/16] Capturing: %s\n", i+1, fileNames[i].c_str());
     saveScreenshot(fileNames[i]);
     
-    // Wait 500ms or until touch held to skip
+    // Show the mode for 500ms. The hold is timed by the gesture recognizer,
+    // so it carries on across modes until it reaches 3 seconds.
     unsigned long startTime = millis();
-    unsigned long touchStartTime = 0;
-    bool skipMode = false;
-    bool wasTouching = false;
-    while (millis() - startTime < 500 && !skipMode) {
+    bool skipRest = false;
+    while (millis() - startTime < 500 && !skipRest) {
       updateTouch();
-      if (touch.isPressed) {
-        if (!wasTouching) {
-          touchStartTime = millis();
-          wasTouching = true;
-        } else if (millis() - touchStartTime > 3000) {
-          skipMode = true;
-        }
-      } else {
-        wasTouching = false;
-      }
+      handleWebServer();
+      skipRest = gestures.heldMs(micros()) >= 3000;
+      delay(10);
     }
     
     // Give visual feedback if skipped
-    if (skipMode) {
+    if (skipRest) {
       tft.fillScreen(THEME_WARNING);
       tft.setTextColor(THEME_BG, THEME_WARNING);
       tft.drawCentreString("SKIPPED", SCREEN_WIDTH/2, SCREEN_HEIGHT/2, 4);
+      Serial.println("[Screenshot] Skipped remaining modes");
+      delay(500);
+      break;
     }
   }
   
@@ -580,6 +607,24 @@ void cycleModesForScreenshots() {
   exitToMenu();
 }
 
+// Rows of the settings screen below the title
+#define SETTINGS_ROW_Y(row) (SCALED_H(50) + (row) * (BTN_MEDIUM_H + SCALED_H(6)))
+
+// Compositor layers of the settings screen, registered by showSettingsMenu()
+int8_t settingsLayerChannel = -1;
+int8_t settingsLayerBLE = -1;
+
+void drawSettingsChannel() {
+  drawRoundButton(SCALED_W(20) + SCALED_W(150), SETTINGS_ROW_Y(1), SCALED_W(140), BTN_MEDIUM_H,
+                  "CH: " + String(midiChannel), THEME_SUCCESS);
+}
+
+void drawSettingsBLE() {
+  String bleText = bleEnabled ? "BLE: ON" : "BLE: OFF";
+  uint16_t bleColor = bleEnabled ? THEME_SUCCESS : THEME_ERROR;
+  drawRoundButton(SCALED_W(20), SETTINGS_ROW_Y(2), SCALED_W(440), BTN_MEDIUM_H, bleText, bleColor);
+}
+
 void showSettingsMenu(bool interactive) {
   tft.fillScreen(THEME_BG);
   tft.setTextColor(THEME_PRIMARY, THEME_BG);
@@ -598,14 +643,12 @@ void showSettingsMenu(bool interactive) {
   // MIDI Channel setting
   int channelBtnW = SCALED_W(140);
   drawRoundButton(btnX, btnY, channelBtnW, btnH, "CH -", THEME_WARNING);
-  drawRoundButton(btnX + SCALED_W(150), btnY, channelBtnW, btnH, "CH: " + String(midiChannel), THEME_SUCCESS);
+  drawSettingsChannel();
   drawRoundButton(btnX + SCALED_W(300), btnY, channelBtnW, btnH, "CH +", THEME_WARNING);
   btnY += btnH + spacing;
   
   // BLE Enable/Disable
-  String bleText = bleEnabled ? "BLE: ON" : "BLE: OFF";
-  uint16_t bleColor = bleEnabled ? THEME_SUCCESS : THEME_ERROR;
-  drawRoundButton(btnX, btnY, btnW, btnH, bleText, bleColor);
+  drawSettingsBLE();
   btnY += btnH + spacing;
   
   // Screenshot Mode Cycling
@@ -615,78 +658,79 @@ void showSettingsMenu(bool interactive) {
   // Back button - centered at bottom
   drawRoundButton((SCREEN_WIDTH - SCALED_W(120)) / 2, SCALED_H(270), SCALED_W(120), BTN_MEDIUM_H, "BACK", THEME_PRIMARY);
   
-  // If not interactive (screenshot mode), just return
-  if (!interactive) return;
+  // Channel and BLE taps repaint just their button
+  UICompositor::reset();
+  settingsLayerChannel = UICompositor::addLayer(btnX + SCALED_W(150), SETTINGS_ROW_Y(1), channelBtnW, btnH, drawSettingsChannel);
+  settingsLayerBLE = UICompositor::addLayer(btnX, SETTINGS_ROW_Y(2), btnW, btnH, drawSettingsBLE);
   
-  // Handle touch
-  while (true) {
-    updateTouch();
-    if (!touch.justPressed) {
-      delay(20);
-      continue;
-    }
-    
-    // Calibrate Touch
-    int currentY = SCALED_H(50);
-    if (isButtonPressed(btnX, currentY, btnW, btnH)) {
-      // Delete calibration file and reboot
-      tft.fillScreen(THEME_BG);
-      tft.setTextColor(THEME_PRIMARY, THEME_BG);
-      tft.drawCentreString("DELETING CALIBRATION", SCREEN_WIDTH/2, SCREEN_HEIGHT/2 - 30, 4);
-      tft.setTextColor(THEME_TEXT, THEME_BG);
-      tft.drawCentreString("Rebooting to recalibrate...", SCREEN_WIDTH/2, SCREEN_HEIGHT/2 + 10, 2);
-      delay(1000);
-      resetCalibration();
-      delay(500);
-      ESP.restart();
-      return;
-    }
-    
-    // MIDI Channel -
-    currentY = SCALED_H(50) + btnH + spacing;
-    if (isButtonPressed(btnX, currentY, SCALED_W(140), btnH)) {
-      if (midiChannel > 1) midiChannel--;
-      showSettingsMenu();
-      return;
-    }
-    
-    // MIDI Channel +
-    if (isButtonPressed(btnX + SCALED_W(300), currentY, SCALED_W(140), btnH)) {
-      if (midiChannel < 16) midiChannel++;
-      showSettingsMenu();
-      return;
-    }
-    
-    // BLE Toggle
-    currentY += btnH + spacing;
-    if (isButtonPressed(btnX, currentY, btnW, btnH)) {
-      bleEnabled = !bleEnabled;
-      if (bleEnabled) {
-        BLEDevice::startAdvertising();
-        Serial.println("BLE advertising enabled");
-      } else {
-        BLEDevice::stopAdvertising();
-        Serial.println("BLE advertising disabled");
-      }
-      showSettingsMenu();
-      return;
-    }
-    
-    // Screenshot Mode Cycling
-    currentY += btnH + spacing;
-    if (isButtonPressed(btnX, currentY, btnW, btnH)) {
-      cycleModesForScreenshots();
-      showSettingsMenu();
-      return;
-    }
-    
-    // Back button
-    if (isButtonPressed((SCREEN_WIDTH - SCALED_W(120)) / 2, SCALED_H(270), SCALED_W(120), BTN_MEDIUM_H)) {
-      drawMenu();
-      return;
+  // Taps are handled by handleSettingsTouch() unless this is a screenshot
+  if (interactive) menuScreen = MENU_SETTINGS;
+}
+
+void handleSettingsTouch() {
+  int btnH = BTN_MEDIUM_H;
+  int btnW = SCALED_W(440);
+  int btnX = SCALED_W(20);
+  int spacing = SCALED_H(6);
+  
+  // Calibrate Touch
+  int currentY = SCALED_H(50);
+  if (isButtonPressed(btnX, currentY, btnW, btnH)) {
+    // Delete calibration file and reboot
+    tft.fillScreen(THEME_BG);
+    tft.setTextColor(THEME_PRIMARY, THEME_BG);
+    tft.drawCentreString("DELETING CALIBRATION", SCREEN_WIDTH/2, SCREEN_HEIGHT/2 - 30, 4);
+    tft.setTextColor(THEME_TEXT, THEME_BG);
+    tft.drawCentreString("Rebooting to recalibrate...", SCREEN_WIDTH/2, SCREEN_HEIGHT/2 + 10, 2);
+    delay(1000);
+    resetCalibration();
+    delay(500);
+    ESP.restart();
+    return;
+  }
+  
+  // MIDI Channel -
+  currentY = SCALED_H(50) + btnH + spacing;
+  if (isButtonPressed(btnX, currentY, SCALED_W(140), btnH)) {
+    if (midiChannel > 1) midiChannel--;
+    UICompositor::invalidateLayer(settingsLayerChannel);
+    return;
+  }
+  
+  // MIDI Channel +
+  if (isButtonPressed(btnX + SCALED_W(300), currentY, SCALED_W(140), btnH)) {
+    if (midiChannel < 16) midiChannel++;
+    UICompositor::invalidateLayer(settingsLayerChannel);
+    return;
+  }
+  
+  // BLE Toggle
+  currentY += btnH + spacing;
+  if (isButtonPressed(btnX, currentY, btnW, btnH)) {
+    bleEnabled = !bleEnabled;
+    if (bleEnabled) {
+      BLEDevice::startAdvertising();
+      Serial.println("BLE advertising enabled");
+    } else {
+      BLEDevice::stopAdvertising();
+      Serial.println("BLE advertising disabled");
     }
-    
-    delay(20);
+    UICompositor::invalidateLayer(settingsLayerBLE);
+    return;
+  }
+  
+  // Screenshot Mode Cycling
+  currentY += btnH + spacing;
+  if (isButtonPressed(btnX, currentY, btnW, btnH)) {
+    cycleModesForScreenshots();
+    showSettingsMenu();
+    return;
+  }
+  
+  // Back button
+  if (isButtonPressed((SCREEN_WIDTH - SCALED_W(120)) / 2, SCALED_H(270), SCALED_W(120), BTN_MEDIUM_H)) {
+    drawMenu();
+    return;
   }
 }
 
@@ -743,6 +787,11 @@ void saveCalibration() {
   file.println(calibration.y_max);
   file.println(calibration.swap_xy ? 1 : 0);
   file.println(calibration.rotation);
+  if (calibration.useAffine) {
+    for (int i = 0; i < 6; i++) {
+      file.println(calibration.affine.m[i]);
+    }
+  }
   file.close();
   
   Serial.println("Calibration saved to SD card");
@@ -782,7 +831,7 @@ bool loadCalibration() {
   }
   
   calibration.magic = file.parseInt();
-  if (calibration.magic != CALIBRATION_MAGIC) {
+  if (calibration.magic != CALIBRATION_MAGIC && calibration.magic != CALIBRATION_MAGIC_AFFINE) {
     Serial.println("Invalid calibration magic number");
     file.close();
     SD.end();
@@ -798,15 +847,30 @@ bool loadCalibration() {
   uint8_t rot = file.parseInt();
   calibration.rotation = (rot <= 3) ? rot : 0;
   
+  // Files from before the affine fit keep the min/max mapping
+  calibration.useAffine = calibration.magic == CALIBRATION_MAGIC_AFFINE;
+  if (calibration.useAffine) {
+    for (int i = 0; i < 6; i++) {
+      calibration.affine.m[i] = file.parseInt();
+    }
+  }
+  
   file.close();
   SD.end();
   
   calibration.valid = true;
   Serial.println("Loaded calibration from SD card");
-  Serial.printf("X: %d - %d, Y: %d - %d, Swap: %d, Rotation: %d\n", 
-                calibration.x_min, calibration.x_max,
-                calibration.y_min, calibration.y_max,
-                calibration.swap_xy, calibration.rotation);
+  if (calibration.useAffine) {
+    Serial.printf("Affine: %ld %ld %ld / %ld %ld %ld (Q16), Rotation: %d\n",
+                  (long)calibration.affine.m[0], (long)calibration.affine.m[1], (long)calibration.affine.m[2],
+                  (long)calibration.affine.m[3], (long)calibration.affine.m[4], (long)calibration.affine.m[5],
+                  calibration.rotation);
+  } else {
+    Serial.printf("X: %d - %d, Y: %d - %d, Swap: %d, Rotation: %d\n", 
+                  calibration.x_min, calibration.x_max,
+                  calibration.y_min, calibration.y_max,
+                  calibration.swap_xy, calibration.rotation);
+  }
   
   return true;
 }
@@ -868,9 +932,11 @@ void setup() {
   
   // Initialize thread managers
   Serial.println("Starting Touch Thread...");
-  TouchThread::begin();
+  TouchThread::begin(mapTouchPoint);  // Owns the touch controller from here on
+  gestures.setCallback(onMenuGesture);
   Serial.println("Starting MIDI Thread...");
   MIDIThread::begin();
+  MIDIInput::begin(handleMIDIRealtime);
   Serial.println("Thread managers initialized");
   
   BLEServer *server = BLEDevice::createServer();
@@ -940,15 +1006,18 @@ void loop() {
     lv_timer_handler();  // Handle LVGL tasks
   }
   
-  // Update touch state (using existing calibration logic)
+  // Take this frame's touch events from the touch task
   updateTouch();
+  LatencyTrace::update();  // Spans the MIDI task traced since the last pass
   
   // Handle web server requests
   handleWebServer();
   
   // Sync global state with MIDI clock (bidirectional sync)
   if (midiClock.isReceiving) {
-    // External MIDI clock is master
+    // External MIDI clock is master. The transport follows it, but sends no
+    // START or clock back over the link the master's clock arrives on.
+    MIDIThread::setClockOutput(false);
     globalState.bpm = midiClock.calculatedBPM;
     globalState.isPlaying = midiClock.isPlaying;
     MIDIThread::setBPM(midiClock.calculatedBPM);
@@ -958,6 +1027,28 @@ void loop() {
     midiClock.isPlaying = globalState.isPlaying;
   }
   
+  // The clock engine follows the transport state (its output is off while following)
+  if (globalState.isPlaying != ClockEngine::isRunning()) {
+    if (globalState.isPlaying) MIDIThread::sendStart();
+    else MIDIThread::sendStop();
+  }
+  
+  // Notes from an external BLE-MIDI controller
+  processMIDIInput();
+  
+  // Deferred All Notes Off requested by a BLE callback
+  if (midiPanicPending) {
+    midiPanicPending = false;
+    MIDIThread::cancelScheduled();
+    MIDIThread::panic();
+  }
+  
+  // Deferred menu redraw after the BLE connection changed
+  if (menuRedrawPending) {
+    menuRedrawPending = false;
+    if (currentMode == MENU) drawMenu();
+  }
+  
   // Check MIDI clock timeout (stop receiving if no clock for 2 seconds)
   if (midiClock.isReceiving && (millis() - midiClock.lastBPMUpdate > 2000)) {
     midiClock.isReceiving = false;
@@ -966,12 +1057,10 @@ void loop() {
     Serial.println("MIDI Clock timeout");
   }
   
+  LatencyTrace::handlerStart();
   switch (currentMode) {
     case MENU:
-      // Handle taps (including cog icon for settings)
-      if (touch.justPressed) {
-        handleMenuTouch();
-      }
+      // Taps, long presses and swipes reach onMenuGesture() from updateTouch()
       break;
     case KEYBOARD:
       handleKeyboardMode();
@@ -1022,19 +1111,33 @@ void loop() {
       handleLVGLTestMode();
       break;
   }
+  LatencyTrace::handlerEnd();
+  
+  // Repaint what the touches and handlers invalidated this pass
+  UICompositor::update();
   
   delay(20);
 }
 
 void drawMenu() {
+  menuScreen = MENU_ICONS;
+  UICompositor::reset();  // Layers of the screen being left
+  PlayAreaRenderer::end();  // And its sprite strips
   tft.fillScreen(THEME_BG);
   
   // Use unified header (settings icon, not back button)
   drawModuleHeader("MIDI CONTROLLER", false);
   
-  // Subtitle under header
-  tft.setTextColor(THEME_TEXT_DIM, THEME_BG);
-  tft.drawCentreString("Cheap Yellow Display", SCREEN_WIDTH/2, SCALED_H(52), 2);
+  // Subtitle under header - or, while engines play in the background, the
+  // control that stops them all
+  if (GeneratorRuntime::anyPlaying()) {
+    tft.setTextColor(THEME_WARNING, THEME_BG);
+    tft.drawCentreString(String(GeneratorRuntime::playingCount()) + " PLAYING - TAP HERE TO STOP ALL",
+                         SCREEN_WIDTH/2, SCALED_H(52), 2);
+  } else {
+    tft.setTextColor(THEME_TEXT_DIM, THEME_BG);
+    tft.drawCentreString("Cheap Yellow Display", SCREEN_WIDTH/2, SCALED_H(52), 2);
+  }
   
   // Dynamic grid layout - 5 icons per row with bigger graphics
   int iconSize = SCALED_W(85);   // Button size scales with screen
@@ -1044,6 +1147,11 @@ void drawMenu() {
   int startX = (SCREEN_WIDTH - (cols * iconSize + (cols-1) * spacing)) / 2;
   int startY = SCALED_H(58);     // Start slightly higher to fit 3 rows
   
+  // Icons are painted once into the atlas, then each is a single blit
+  if (!MenuIconAtlas::isBuilt(numApps, iconSize)) {
+    MenuIconAtlas::build(numApps, iconSize, paintMenuIcon);
+  }
+  
   // Draw all apps (now includes TB3PO as 11th app)
   for (int i = 0; i < numApps; i++) {
     int col = i % cols;
@@ -1051,26 +1159,53 @@ void drawMenu() {
     int x = startX + col * (iconSize + spacing);
     int y = startY + row * (iconSize + rowSpacing);
     
-    // App icon background
-    uint16_t iconColor = apps[i].color;
-    
-    tft.fillRoundRect(x, y, iconSize, iconSize, 8, iconColor);
-    tft.drawRoundRect(x, y, iconSize, iconSize, 8, THEME_TEXT);
-    
-    // Draw app-specific graphics in TOP half of button
-    drawAppGraphics(apps[i].mode, x, y, iconSize);
-    
-    // Icon symbol in TOP half
-    tft.setTextColor(TFT_BLACK, iconColor);
-    tft.drawCentreString(apps[i].symbol, x + iconSize/2, y + iconSize/4, 2);
+    if (!MenuIconAtlas::draw(i, x, y)) {
+      tft.setViewport(x, y, iconSize, iconSize);  // Painter draws from (0, 0)
+      paintMenuIcon(tft, i, iconSize);
+      tft.resetViewport();
+    }
     
-    // App name in BOTTOM half
-    tft.setTextColor(TFT_BLACK, iconColor);
-    tft.drawCentreString(apps[i].name, x + iconSize/2, y + (3 * iconSize/4) - 4, 2);
+    // Playing in the background
+    GeneratorEngine engine = engineForMode(apps[i].mode);
+    if (engine != ENGINE_COUNT && GeneratorRuntime::isPlaying(engine)) {
+      tft.fillCircle(x + iconSize - 10, y + 10, 5, THEME_SUCCESS);
+      tft.drawCircle(x + iconSize - 10, y + 10, 5, TFT_BLACK);
+    }
+  }
+}
+
+// One menu icon with its top-left corner at (0, 0), for the icon atlas
+void paintMenuIcon(TFT_eSPI& gfx, uint8_t index, int16_t iconSize) {
+  // App icon background
+  uint16_t iconColor = apps[index].color;
+  
+  gfx.fillRoundRect(0, 0, iconSize, iconSize, 8, iconColor);
+  gfx.drawRoundRect(0, 0, iconSize, iconSize, 8, THEME_TEXT);
+  
+  // Draw app-specific graphics in TOP half of button
+  drawAppGraphics(gfx, apps[index].mode, 0, 0, iconSize);
+  
+  // Icon symbol in TOP half
+  gfx.setTextColor(TFT_BLACK, iconColor);
+  gfx.drawCentreString(apps[index].symbol, iconSize/2, iconSize/4, 2);
+  
+  // App name in BOTTOM half
+  gfx.setTextColor(TFT_BLACK, iconColor);
+  gfx.drawCentreString(apps[index].name, iconSize/2, (3 * iconSize/4) - 4, 2);
+}
+
+// Background engine behind a menu entry (ENGINE_COUNT if none)
+GeneratorEngine engineForMode(AppMode mode) {
+  switch (mode) {
+    case SEQUENCER: return ENGINE_BEATS;
+    case GRIDS:     return ENGINE_GRIDS;
+    case TB3PO:     return ENGINE_TB3PO;
+    case EUCLIDEAN: return ENGINE_EUCLIDEAN;
+    default:        return ENGINE_COUNT;
   }
 }
 
-void drawAppGraphics(AppMode mode, int x, int y, int iconSize) {
+void drawAppGraphics(TFT_eSPI& gfx, AppMode mode, int x, int y, int iconSize) {
   int topHalfY = y + iconSize/4; // Center graphics in top half
   
   switch (mode) {
@@ -1080,7 +1215,7 @@ void drawAppGraphics(AppMode mode, int x, int y, int iconSize) {
         int totalWidth = 5 * keyWidth + 4 * 2; // 5 keys + 4 gaps
         int startX = x + (iconSize - totalWidth) / 2;
         for (int i = 0; i < 5; i++) {
-          tft.fillRect(startX + i*10, topHalfY - 12, keyWidth, 24, THEME_BG);
+          gfx.fillRect(startX + i*10, topHalfY - 12, keyWidth, 24, THEME_BG);
         }
       }
       break;
@@ -1093,7 +1228,7 @@ void drawAppGraphics(AppMode mode, int x, int y, int iconSize) {
         int startYPos = topHalfY - totalH / 2;
         for (int r = 0; r < 3; r++) {
           for (int c = 0; c < 4; c++) {
-            tft.fillRect(startX + c*(gridW+gapX), startYPos + r*(gridH+gapY), gridW, gridH, THEME_BG);
+            gfx.fillRect(startX + c*(gridW+gapX), startYPos + r*(gridH+gapY), gridW, gridH, THEME_BG);
           }
         }
       }
@@ -1101,47 +1236,47 @@ void drawAppGraphics(AppMode mode, int x, int y, int iconSize) {
     case BOUNCING_BALL: // ZEN - circle with dots
       {
         int centerX = x + iconSize/2;
-        tft.drawCircle(centerX, topHalfY, 12, THEME_BG);
-        tft.fillCircle(centerX - 6, topHalfY - 4, 2, THEME_BG);
-        tft.fillCircle(centerX + 5, topHalfY + 2, 2, THEME_BG);
-        tft.fillCircle(centerX - 2, topHalfY + 6, 2, THEME_BG);
+        gfx.drawCircle(centerX, topHalfY, 12, THEME_BG);
+        gfx.fillCircle(centerX - 6, topHalfY - 4, 2, THEME_BG);
+        gfx.fillCircle(centerX + 5, topHalfY + 2, 2, THEME_BG);
+        gfx.fillCircle(centerX - 2, topHalfY + 6, 2, THEME_BG);
       }
       break;
     case PHYSICS_DROP: // DROP - balls falling on platforms
       {
         int centerX = x + iconSize/2;
         // Draw platforms
-        tft.fillRect(centerX - 10, topHalfY + 8, 8, 2, THEME_BG);
-        tft.fillRect(centerX + 4, topHalfY + 4, 6, 2, THEME_BG);
+        gfx.fillRect(centerX - 10, topHalfY + 8, 8, 2, THEME_BG);
+        gfx.fillRect(centerX + 4, topHalfY + 4, 6, 2, THEME_BG);
         // Draw falling balls
-        tft.fillCircle(centerX - 6, topHalfY - 8, 2, THEME_BG);
-        tft.fillCircle(centerX + 2, topHalfY - 4, 2, THEME_BG);
-        tft.fillCircle(centerX + 8, topHalfY, 2, THEME_BG);
+        gfx.fillCircle(centerX - 6, topHalfY - 8, 2, THEME_BG);
+        gfx.fillCircle(centerX + 2, topHalfY - 4, 2, THEME_BG);
+        gfx.fillCircle(centerX + 8, topHalfY, 2, THEME_BG);
       }
       break;
     case RANDOM_GENERATOR: // RNG - random dots
       {
         int centerX = x + iconSize/2;
-        tft.fillCircle(centerX - 16, topHalfY - 12, 4, THEME_BG);
-        tft.fillCircle(centerX - 2, topHalfY - 6, 4, THEME_BG);
-        tft.fillCircle(centerX + 14, topHalfY + 2, 4, THEME_BG);
-        tft.fillCircle(centerX - 8, topHalfY + 12, 4, THEME_BG);
+        gfx.fillCircle(centerX - 16, topHalfY - 12, 4, THEME_BG);
+        gfx.fillCircle(centerX - 2, topHalfY - 6, 4, THEME_BG);
+        gfx.fillCircle(centerX + 14, topHalfY + 2, 4, THEME_BG);
+        gfx.fillCircle(centerX - 8, topHalfY + 12, 4, THEME_BG);
       }
       break;
     case XY_PAD: // XY PAD - crosshairs
       {
         int centerX = x + iconSize/2;
         int crossSize = 28;
-        tft.drawFastHLine(centerX - crossSize/2, topHalfY, crossSize, THEME_BG);
-        tft.drawFastVLine(centerX, topHalfY - crossSize/2, crossSize, THEME_BG);
-        tft.fillCircle(centerX, topHalfY, 6, THEME_BG);
+        gfx.drawFastHLine(centerX - crossSize/2, topHalfY, crossSize, THEME_BG);
+        gfx.drawFastVLine(centerX, topHalfY - crossSize/2, crossSize, THEME_BG);
+        gfx.fillCircle(centerX, topHalfY, 6, THEME_BG);
       }
       break;
     case ARPEGGIATOR: // ARP - ascending notes
       {
         int centerX = x + iconSize/2;
         for (int i = 0; i < 4; i++) {
-          tft.fillCircle(centerX - 14 + i*10, topHalfY + 10 - i*6, 4, THEME_BG);
+          gfx.fillCircle(centerX - 14 + i*10, topHalfY + 10 - i*6, 4, THEME_BG);
         }
       }
       break;
@@ -1154,7 +1289,7 @@ void drawAppGraphics(AppMode mode, int x, int y, int iconSize) {
         int startYPos = topHalfY - totalH / 2;
         for (int r = 0; r < 3; r++) {
           for (int c = 0; c < 4; c++) {
-            tft.drawRect(startX + c*(cellW+gapX), startYPos + r*(cellH+gapY), cellW, cellH, THEME_BG);
+            gfx.drawRect(startX + c*(cellW+gapX), startYPos + r*(cellH+gapY), cellW, cellH, THEME_BG);
           }
         }
       }
@@ -1163,9 +1298,9 @@ void drawAppGraphics(AppMode mode, int x, int y, int iconSize) {
       {
         int centerX = x + iconSize/2;
         int lineWidth = 28;
-        tft.fillRect(centerX - lineWidth/2, topHalfY + 8, lineWidth, 4, THEME_BG);
-        tft.fillRect(centerX - lineWidth/2, topHalfY, lineWidth, 4, THEME_BG);
-        tft.fillRect(centerX - lineWidth/2, topHalfY - 8, lineWidth, 4, THEME_BG);
+        gfx.fillRect(centerX - lineWidth/2, topHalfY + 8, lineWidth, 4, THEME_BG);
+        gfx.fillRect(centerX - lineWidth/2, topHalfY, lineWidth, 4, THEME_BG);
+        gfx.fillRect(centerX - lineWidth/2, topHalfY - 8, lineWidth, 4, THEME_BG);
       }
       break;
     case LFO: // LFO - simple sine wave line
@@ -1182,7 +1317,7 @@ void drawAppGraphics(AppMode mode, int x, int y, int iconSize) {
           int py = topHalfY + (int)(12 * sin(angle));
           
           // Draw line from last point to current point
-          tft.drawLine(lastX, lastY, px, py, THEME_BG);
+          gfx.drawLine(lastX, lastY, px, py, THEME_BG);
           
           lastX = px;
           lastY = py;
@@ -1193,16 +1328,16 @@ void drawAppGraphics(AppMode mode, int x, int y, int iconSize) {
       {
         int centerX = x + iconSize/2;
         // Draw circle face outline (2 pixels thick for visibility)
-        tft.drawCircle(centerX, topHalfY, 18, THEME_BG);
-        tft.drawCircle(centerX, topHalfY, 17, THEME_BG);
+        gfx.drawCircle(centerX, topHalfY, 18, THEME_BG);
+        gfx.drawCircle(centerX, topHalfY, 17, THEME_BG);
         // Eyes (filled dots)
-        tft.fillCircle(centerX - 8, topHalfY - 5, 3, THEME_BG);
-        tft.fillCircle(centerX + 8, topHalfY - 5, 3, THEME_BG);
+        gfx.fillCircle(centerX - 8, topHalfY - 5, 3, THEME_BG);
+        gfx.fillCircle(centerX + 8, topHalfY - 5, 3, THEME_BG);
         // Acid smiley mouth (wide smile - curves upward, thicker line)
         for (int i = -10; i <= 10; i++) {
           int y = topHalfY + 8 - (abs(i) * abs(i)) / 20;
-          tft.drawPixel(centerX + i, y, THEME_BG);
-          tft.drawPixel(centerX + i, y + 1, THEME_BG); // Make it thicker
+          gfx.drawPixel(centerX + i, y, THEME_BG);
+          gfx.drawPixel(centerX + i, y + 1, THEME_BG); // Make it thicker
         }
       }
       break;
@@ -1210,54 +1345,54 @@ void drawAppGraphics(AppMode mode, int x, int y, int iconSize) {
       {
         int centerX = x + iconSize/2;
         // Draw concentric circles representing drum pattern map
-        tft.drawCircle(centerX, topHalfY, 16, THEME_BG);
-        tft.drawCircle(centerX, topHalfY, 10, THEME_BG);
-        tft.drawCircle(centerX, topHalfY, 4, THEME_BG);
+        gfx.drawCircle(centerX, topHalfY, 16, THEME_BG);
+        gfx.drawCircle(centerX, topHalfY, 10, THEME_BG);
+        gfx.drawCircle(centerX, topHalfY, 4, THEME_BG);
         // Draw dots representing triggers in different positions
-        tft.fillCircle(centerX, topHalfY - 10, 2, THEME_BG);
-        tft.fillCircle(centerX + 8, topHalfY + 6, 2, THEME_BG);
-        tft.fillCircle(centerX - 8, topHalfY + 6, 2, THEME_BG);
+        gfx.fillCircle(centerX, topHalfY - 10, 2, THEME_BG);
+        gfx.fillCircle(centerX + 8, topHalfY + 6, 2, THEME_BG);
+        gfx.fillCircle(centerX - 8, topHalfY + 6, 2, THEME_BG);
       }
       break;
     case RAGA: // RAGA - Indian classical music (sitar/tanpura shape)
       {
         int centerX = x + iconSize/2;
         // Draw sitar/tanpura body (gourd shape)
-        tft.fillCircle(centerX, topHalfY + 6, 12, THEME_BG);
+        gfx.fillCircle(centerX, topHalfY + 6, 12, THEME_BG);
         // Neck
-        tft.fillRect(centerX - 2, topHalfY - 18, 4, 24, THEME_BG);
+        gfx.fillRect(centerX - 2, topHalfY - 18, 4, 24, THEME_BG);
         // Tuning pegs
-        tft.drawLine(centerX - 2, topHalfY - 16, centerX - 8, topHalfY - 18, THEME_BG);
-        tft.drawLine(centerX + 2, topHalfY - 16, centerX + 8, topHalfY - 18, THEME_BG);
+        gfx.drawLine(centerX - 2, topHalfY - 16, centerX - 8, topHalfY - 18, THEME_BG);
+        gfx.drawLine(centerX + 2, topHalfY - 16, centerX + 8, topHalfY - 18, THEME_BG);
         // Strings (vertical lines)
-        tft.drawFastVLine(centerX - 4, topHalfY - 10, 16, THEME_BG);
-        tft.drawFastVLine(centerX, topHalfY - 10, 16, THEME_BG);
-        tft.drawFastVLine(centerX + 4, topHalfY - 10, 16, THEME_BG);
+        gfx.drawFastVLine(centerX - 4, topHalfY - 10, 16, THEME_BG);
+        gfx.drawFastVLine(centerX, topHalfY - 10, 16, THEME_BG);
+        gfx.drawFastVLine(centerX + 4, topHalfY - 10, 16, THEME_BG);
         // Bridge
-        tft.drawFastHLine(centerX - 8, topHalfY + 10, 16, THEME_BG);
+        gfx.drawFastHLine(centerX - 8, topHalfY + 10, 16, THEME_BG);
       }
       break;
     case EUCLIDEAN: // EUCLIDEAN - Euclidean rhythm (multi-ring circular pattern)
       {
         int centerX = x + iconSize/2;
         // Draw 4 concentric circles with dots (representing Euclidean patterns)
-        tft.drawCircle(centerX, topHalfY, 18, THEME_BG);
-        tft.drawCircle(centerX, topHalfY, 14, THEME_BG);
-        tft.drawCircle(centerX, topHalfY, 10, THEME_BG);
-        tft.drawCircle(centerX, topHalfY, 6, THEME_BG);
+        gfx.drawCircle(centerX, topHalfY, 18, THEME_BG);
+        gfx.drawCircle(centerX, topHalfY, 14, THEME_BG);
+        gfx.drawCircle(centerX, topHalfY, 10, THEME_BG);
+        gfx.drawCircle(centerX, topHalfY, 6, THEME_BG);
         // Event markers at different positions on each ring
         // Outer ring - 4 events
         for (int i = 0; i < 4; i++) {
           float angle = (i * TWO_PI / 4) - HALF_PI;
-          tft.fillCircle(centerX + cos(angle) * 18, topHalfY + sin(angle) * 18, 2, THEME_BG);
+          gfx.fillCircle(centerX + cos(angle) * 18, topHalfY + sin(angle) * 18, 2, THEME_BG);
         }
         // Mid-outer ring - 3 events
         for (int i = 0; i < 3; i++) {
           float angle = (i * TWO_PI / 3) - HALF_PI + 0.5;
-          tft.fillCircle(centerX + cos(angle) * 14, topHalfY + sin(angle) * 14, 2, THEME_BG);
+          gfx.fillCircle(centerX + cos(angle) * 14, topHalfY + sin(angle) * 14, 2, THEME_BG);
         }
         // Center dot
-        tft.fillCircle(centerX, topHalfY, 2, THEME_BG);
+        gfx.fillCircle(centerX, topHalfY, 2, THEME_BG);
       }
       break;
     case MORPH: // MORPH - Gesture morphing (infinity symbol with trail)
@@ -1268,7 +1403,7 @@ void drawAppGraphics(AppMode mode, int x, int y, int iconSize) {
           float scale = 16.0f;
           float ix = scale * cos(t) / (1 + sin(t) * sin(t));
           float iy = scale * sin(t) * cos(t) / (1 + sin(t) * sin(t));
-          tft.drawPixel(centerX + (int)ix, topHalfY + (int)iy, THEME_BG);
+          gfx.drawPixel(centerX + (int)ix, topHalfY + (int)iy, THEME_BG);
         }
         // Add flowing particles
         for (int i = 0; i < 3; i++) {
@@ -1276,7 +1411,7 @@ void drawAppGraphics(AppMode mode, int x, int y, int iconSize) {
           float scale = 16.0f;
           float px = scale * cos(t) / (1 + sin(t) * sin(t));
           float py = scale * sin(t) * cos(t) / (1 + sin(t) * sin(t));
-          tft.fillCircle(centerX + (int)px, topHalfY + (int)py, 2, THEME_BG);
+          gfx.fillCircle(centerX + (int)px, topHalfY + (int)py, 2, THEME_BG);
         }
       }
       break;
@@ -1286,12 +1421,12 @@ void drawAppGraphics(AppMode mode, int x, int y, int iconSize) {
         // Draw checkmark
         // Left part of check (short line going down-right)
         for (int i = 0; i < 8; i++) {
-          tft.drawLine(centerX - 8 + i, topHalfY - 2 + i, 
+          gfx.drawLine(centerX - 8 + i, topHalfY - 2 + i, 
                       centerX - 7 + i, topHalfY - 1 + i, THEME_BG);
         }
         // Right part of check (long line going up-right)
         for (int i = 0; i < 14; i++) {
-          tft.drawLine(centerX + i, topHalfY + 6 - i, 
+          gfx.drawLine(centerX + i, topHalfY + 6 - i, 
                       centerX + 1 + i, topHalfY + 7 - i, THEME_BG);
         }
       }
@@ -1311,25 +1446,8 @@ void handleMenuTouch() {
   
   // Check Bluetooth icon touch - larger touch area
   if (isButtonPressed(SCREEN_WIDTH - SCALED_W(75), SCALED_H(10), SCALED_W(35), SCALED_H(35))) {
-    // Show BLE status
-    tft.fillScreen(THEME_BG);
-    tft.setTextColor(THEME_PRIMARY, THEME_BG);
-    tft.drawCentreString("BLUETOOTH STATUS", SCREEN_WIDTH/2, SCALED_H(60), 4);
-    tft.setTextColor(THEME_TEXT, THEME_BG);
-    tft.drawCentreString(globalState.bleConnected ? "Connected" : "Waiting for connection", SCREEN_WIDTH/2, SCALED_H(120), 2);
-    tft.setTextColor(THEME_TEXT_DIM, THEME_BG);
-    tft.drawCentreString("Device: CYD MIDI", SCREEN_WIDTH/2, SCALED_H(160), 2);
-    String mac = BLEDevice::getAddress().toString().c_str();
-    tft.drawCentreString("MAC: " + mac, SCREEN_WIDTH/2, SCALED_H(190), 2);
-    drawRoundButton((SCREEN_WIDTH - BTN_LARGE_W) / 2, SCALED_H(240), BTN_LARGE_W, BTN_SMALL_H, "BACK", THEME_PRIMARY);
-    while (true) {
-      updateTouch();
-      if (touch.justPressed && isButtonPressed((SCREEN_WIDTH - BTN_LARGE_W) / 2, SCALED_H(240), BTN_LARGE_W, BTN_SMALL_H)) {
-        drawMenu();
-        return;
-      }
-      delay(20);
-    }
+    showBluetoothStatus();
+    return;
   }
   
   // Check SD icon touch (top right) - larger touch area
@@ -1338,6 +1456,28 @@ void handleMenuTouch() {
     return;
   }
   
+  // "Stop all" line under the header (the icon grid starts just below it)
+  if (GeneratorRuntime::anyPlaying() && touch.y >= SCALED_H(46) && touch.y < SCALED_H(58)) {
+    Serial.println("Stopping all background engines");
+    GeneratorRuntime::stopAll();
+    drawMenu();
+    return;
+  }
+  
+  int app = menuAppAtTouch();
+  if (app >= 0) {
+    Serial.printf("Menu touch: app %d (%s) touch=(%d,%d)\n", 
+                  app, apps[app].name.c_str(), touch.x, touch.y);
+    enterMode(apps[app].mode);
+    return;
+  }
+  
+  // Debug: show where the touch was
+  Serial.printf("Menu touch missed all icons: (%d,%d)\n", touch.x, touch.y);
+}
+
+// Index of the menu icon under the touch, or -1
+int menuAppAtTouch() {
   int iconSize = SCALED_W(85);  // Match drawMenu icon size (updated for better touch)
   int spacing = SCALED_W(5);    // Match drawMenu spacing (reduced)
   int rowSpacing = SCALED_H(2); // Match drawMenu row spacing
@@ -1352,15 +1492,69 @@ void handleMenuTouch() {
     int y = startY + row * (iconSize + rowSpacing);
     
     if (isButtonPressed(x, y, iconSize, iconSize)) {
-      Serial.printf("Menu touch: app %d (%s) at (%d,%d) touch=(%d,%d)\n", 
-                    i, apps[i].name.c_str(), x, y, touch.x, touch.y);
-      enterMode(apps[i].mode);
-      return;
+      return i;
     }
   }
+  return -1;
+}
+
+// Long press on the icon of a playing background engine stops just that one
+void handleMenuLongPress() {
+  int app = menuAppAtTouch();
+  if (app < 0) return;
+  GeneratorEngine engine = engineForMode(apps[app].mode);
+  if (engine != ENGINE_COUNT && GeneratorRuntime::isPlaying(engine)) {
+    Serial.printf("Stopping %s from the menu\n", apps[app].name.c_str());
+    GeneratorRuntime::setPlaying(engine, false);
+    drawMenu();
+  }
+}
+
+void showBluetoothStatus() {
+  tft.fillScreen(THEME_BG);
+  tft.setTextColor(THEME_PRIMARY, THEME_BG);
+  tft.drawCentreString("BLUETOOTH STATUS", SCREEN_WIDTH/2, SCALED_H(60), 4);
+  tft.setTextColor(THEME_TEXT, THEME_BG);
+  tft.drawCentreString(globalState.bleConnected ? "Connected" : "Waiting for connection", SCREEN_WIDTH/2, SCALED_H(120), 2);
+  tft.setTextColor(THEME_TEXT_DIM, THEME_BG);
+  tft.drawCentreString("Device: CYD MIDI", SCREEN_WIDTH/2, SCALED_H(160), 2);
+  String mac = BLEDevice::getAddress().toString().c_str();
+  tft.drawCentreString("MAC: " + mac, SCREEN_WIDTH/2, SCALED_H(190), 2);
+  drawRoundButton((SCREEN_WIDTH - BTN_LARGE_W) / 2, SCALED_H(240), BTN_LARGE_W, BTN_SMALL_H, "BACK", THEME_PRIMARY);
+  menuScreen = MENU_BLE_INFO;
+}
+
+// Every menu screen reacts to finished gestures rather than to the press,
+// so a long press or swipe never also counts as a tap
+void onMenuGesture(const TouchGesture& gesture) {
+  if (currentMode != MENU) return;
+  
+  // Swipe right goes back from the settings and info screens
+  if (gesture.type == GESTURE_SWIPE && gesture.direction == SWIPE_RIGHT && menuScreen != MENU_ICONS) {
+    drawMenu();
+    return;
+  }
   
-  // Debug: show where the touch was
-  Serial.printf("Menu touch missed all icons: (%d,%d)\n", touch.x, touch.y);
+  switch (menuScreen) {
+    case MENU_ICONS:
+      if (gesture.type == GESTURE_TAP) handleMenuTouch();
+      else if (gesture.type == GESTURE_LONG_PRESS) handleMenuLongPress();
+      break;
+    case MENU_SETTINGS:
+      if (gesture.type == GESTURE_TAP) handleSettingsTouch();
+      break;
+    case MENU_BLE_INFO:
+      if (gesture.type == GESTURE_TAP &&
+          isButtonPressed((SCREEN_WIDTH - BTN_LARGE_W) / 2, SCALED_H(240), BTN_LARGE_W, BTN_SMALL_H)) {
+        drawMenu();
+      }
+      break;
+    case MENU_SD_INFO:
+      if (gesture.type == GESTURE_TAP && isButtonPressed((SCREEN_WIDTH - 100) / 2, SCREEN_HEIGHT - 60, 100, 35)) {
+        drawMenu();
+      }
+      break;
+  }
 }
 
 void enterMode(AppMode mode) {
@@ -1436,6 +1630,9 @@ void exitToMenu() {
   
   currentMode = MENU;
   stopAllModes();
+  // Modes leave on the press of BACK; its release must not reach the menu
+  // as a tap (BACK sits over the settings icon)
+  gestures.reset();
   // NOTE: UIManager::clearMode() not called yet - will be used after mode migration
   drawMenu();
 }
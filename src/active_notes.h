@@ -0,0 +1,81 @@
+#ifndef ACTIVE_NOTES_H
+#define ACTIVE_NOTES_H
+
+#include <stdint.h>
+
+// Which notes are currently sounding, one 128-bit set per MIDI channel
+// - update() is fed every channel message as it goes out on the wire
+// - Note On with velocity 0 counts as Note Off, CC 123 clears the channel
+// - Written by the MIDI task only; reads from other tasks see whole 32-bit
+//   words and may be one message behind, which is fine for UI display
+//
+// Plain C++ (no Arduino/FreeRTOS) so it also builds on the host.
+
+class ActiveNoteMap {
+public:
+  ActiveNoteMap() { clear(); }
+
+  void update(const uint8_t* msg, uint8_t length) {
+    if (length < 3) return;
+    uint8_t ch = msg[0] & 0x0F;
+    uint8_t note = msg[1] & 0x7F;
+    switch (msg[0] & 0xF0) {
+      case 0x90:
+        if (msg[2]) set(ch, note);
+        else reset(ch, note);
+        break;
+      case 0x80:
+        reset(ch, note);
+        break;
+      case 0xB0:
+        if (note == 123) clearChannel(ch);  // All Notes Off
+        break;
+    }
+  }
+
+  bool isActive(uint8_t ch, uint8_t note) const {
+    return (bits[ch & 0x0F][(note >> 5) & 3] >> (note & 31)) & 1;
+  }
+
+  bool anyActive(uint8_t ch) const {
+    const volatile uint32_t* w = bits[ch & 0x0F];
+    return (w[0] | w[1] | w[2] | w[3]) != 0;
+  }
+
+  uint8_t count(uint8_t ch) const {
+    uint8_t n = 0;
+    for (int i = 0; i < 4; i++) n += __builtin_popcount(bits[ch & 0x0F][i]);
+    return n;
+  }
+
+  // Copy one channel's set (bit n of word n/32 = note n)
+  void snapshot(uint8_t ch, uint32_t out[4]) const {
+    for (int i = 0; i < 4; i++) out[i] = bits[ch & 0x0F][i];
+  }
+
+  // Lowest active note at or above 'from', or -1
+  int nextActive(uint8_t ch, uint8_t from) const {
+    for (int w = from >> 5; w < 4; w++) {
+      uint32_t word = bits[ch & 0x0F][w];
+      if (w == (from >> 5)) word &= ~0u << (from & 31);
+      if (word) return (w << 5) + __builtin_ctz(word);
+    }
+    return -1;
+  }
+
+  void clearChannel(uint8_t ch) {
+    for (int i = 0; i < 4; i++) bits[ch & 0x0F][i] = 0;
+  }
+
+  void clear() {
+    for (int ch = 0; ch < 16; ch++) clearChannel(ch);
+  }
+
+private:
+  volatile uint32_t bits[16][4];
+
+  void set(uint8_t ch, uint8_t note) { bits[ch][note >> 5] |= 1u << (note & 31); }
+  void reset(uint8_t ch, uint8_t note) { bits[ch][note >> 5] &= ~(1u << (note & 31)); }
+};
+
+#endif // ACTIVE_NOTES_H
@@ -10,20 +10,45 @@ int pianoOctave = 4;
 
 // Function implementations
 
+// Transport step (MIDI task): one arp note while a key is held
+static void arpStep(const TransportTick& tick, void*) {
+  if (!arp.isPlaying) return;
+  playArpNote(tick.timeUs, tick.stepUs);
+}
+
+// The arp plays on the transport while a key is held (on its own, without
+// sending START/STOP - see GeneratorRuntime)
+static void startArp() {
+  arp.isPlaying = true;
+  arp.currentStep = 0;
+  GeneratorRuntime::setPlaying(ENGINE_ARP, true);
+}
+
+static void stopArp() {
+  arp.isPlaying = false;
+  GeneratorRuntime::setPlaying(ENGINE_ARP, false);
+  if (arp.currentNote != -1) {
+    // Pending events may belong to background engines - keep those
+    if (!GeneratorRuntime::anyPlaying()) MIDIThread::cancelScheduled();
+    sendNoteOff(arp.currentNote);
+    arp.currentNote = -1;
+  }
+}
+
 void initializeArpeggiatorMode() {
   arp.scaleType = 0;
   arp.chordType = 0;
   arp.pattern = 0;
   arp.octaves = 2;
   arp.speed = 8;
-  arp.bpm = 120;
   arp.isPlaying = false;
   arp.currentStep = 0;
   arp.currentNote = -1;
   arp.triggeredKey = -1;
   arp.triggeredOctave = 4;
+  arp.needsRedraw = false;
   pianoOctave = 4;
-  calculateStepInterval();
+  arp.transportId = GeneratorRuntime::attach(ENGINE_ARP, arpStep, ARP_TICKS_PER_NOTE(arp.speed));
   
   drawArpeggiatorMode();
 }
@@ -75,7 +100,7 @@ void drawArpControls() {
   
   // BPM Control
   tft.drawString("BPM:", 10, y + 12, 1);
-  tft.drawString(String(arp.bpm), 50, y + 12, 1);
+  tft.drawString(String((int)globalState.bpm), 50, y + 12, 1);
   drawRoundButton(75, y, 45, btnHeight, "-", THEME_SECONDARY);
   drawRoundButton(125, y, 45, btnHeight, "+", THEME_SECONDARY);
   
@@ -134,6 +159,12 @@ void drawPianoKeys() {
 }
 
 void handleArpeggiatorMode() {
+  // Notes are played by the transport; show the one it just played
+  if (arp.needsRedraw) {
+    arp.needsRedraw = false;
+    drawArpControls();
+  }
+  
   // Back button - larger touch area
   if (touch.justPressed && isButtonPressed(BACK_BTN_X, BACK_BTN_Y, BTN_BACK_W, BTN_BACK_H)) {
     exitToMenu();
@@ -227,7 +258,7 @@ void handleArpeggiatorMode() {
       if (arp.speed == 32) arp.speed = 16;
       else if (arp.speed == 16) arp.speed = 8;
       else if (arp.speed == 8) arp.speed = 4;
-      calculateStepInterval();
+      Transport::setDivision(arp.transportId, ARP_TICKS_PER_NOTE(arp.speed));
       drawArpControls();
       return;
     }
@@ -236,7 +267,7 @@ void handleArpeggiatorMode() {
       if (arp.speed == 4) arp.speed = 8;
       else if (arp.speed == 8) arp.speed = 16;
       else if (arp.speed == 16) arp.speed = 32;
-      calculateStepInterval();
+      Transport::setDivision(arp.transportId, ARP_TICKS_PER_NOTE(arp.speed));
       drawArpControls();
       return;
     }
@@ -245,14 +276,12 @@ void handleArpeggiatorMode() {
     
     // BPM controls
     if (isButtonPressed(75, y, 45, btnHeight)) {
-      arp.bpm = max(60, arp.bpm - 5);
-      calculateStepInterval();
+      setBPM(max(60.0f, globalState.bpm - 5));
       drawArpControls();
       return;
     }
     if (isButtonPressed(125, y, 45, btnHeight)) {
-      arp.bpm = min(200, arp.bpm + 5);
-      calculateStepInterval();
+      setBPM(min(200.0f, globalState.bpm + 5));
       drawArpControls();
       return;
     }
@@ -285,12 +314,7 @@ void handleArpeggiatorMode() {
         int note = (pianoOctave * 12) + i;
         
         if (arp.isPlaying && arp.triggeredKey == note) {
-          // Stop current arp
-          arp.isPlaying = false;
-          if (arp.currentNote != -1) {
-            sendNoteOff(arp.currentNote);
-            arp.currentNote = -1;
-          }
+          stopArp();
         } else {
           // Start new arp - keep timing if already playing
           if (arp.isPlaying && arp.currentNote != -1) {
@@ -298,11 +322,7 @@ void handleArpeggiatorMode() {
           }
           arp.triggeredKey = note;
           arp.triggeredOctave = pianoOctave;
-          if (!arp.isPlaying) {
-            arp.isPlaying = true;
-            arp.currentStep = 0;
-            arp.lastStepTime = millis();
-          }
+          if (!arp.isPlaying) startArp();
         }
         drawPianoKeys();
         drawArpControls();
@@ -310,39 +330,24 @@ void handleArpeggiatorMode() {
       }
     }
   }
-  
-  // Update arpeggiator
-  updateArpeggiator();
 }
 
-void updateArpeggiator() {
-  if (!arp.isPlaying) return;
-  
-  unsigned long now = millis();
-  
-  // Use MIDI clock if available
-  unsigned long effectiveInterval;
-  if (midiClock.isReceiving && midiClock.clockInterval > 0) {
-    // Calculate interval based on arp speed and MIDI clock
-    // MIDI clock is 24 ppqn
-    int clocksPerNote = 24 / arp.speed;  // e.g., 8th note = 12 clocks
-    effectiveInterval = midiClock.clockInterval * clocksPerNote;
+// External keyboard: the held key sets the arp root, releasing it stops the arp
+void arpeggiatorNoteInput(uint8_t note, bool on) {
+  if (on) {
+    arp.triggeredKey = note;
+    arp.triggeredOctave = note / 12;
+    if (!arp.isPlaying) startArp();
+  } else if (arp.isPlaying && arp.triggeredKey == note) {
+    stopArp();
   } else {
-    effectiveInterval = arp.stepInterval;
-  }
-  
-  if (now - arp.lastStepTime >= effectiveInterval) {
-    playArpNote();
-    arp.lastStepTime = now;
+    return;
   }
+  drawPianoKeys();
+  drawArpControls();
 }
 
-void playArpNote() {
-  // Turn off previous note
-  if (arp.currentNote != -1) {
-    sendNoteOff(arp.currentNote);
-  }
-  
+void playArpNote(uint32_t stepTimeUs, uint32_t intervalUs) {
   // Check if we should skip this note (for CHANCE pattern)
   if (arp.pattern == 4) { // CHANCE pattern
     if (random(100) < 30) { // 30% chance to skip
@@ -354,11 +359,11 @@ void playArpNote() {
   // Get next chord tone
   arp.currentNote = getArpNote();
   
-  // Play single note
-  sendNoteOn(arp.currentNote, 100);
+  // Play single note, released just before the next step
+  scheduleNote(arp.currentNote, 100, stepTimeUs, intervalUs - intervalUs / 10);
   
-  // Update display
-  drawArpControls();
+  // Update display (from the loop)
+  arp.needsRedraw = true;
 }
 
 int getArpNote() {
@@ -419,11 +424,3 @@ int getArpNote() {
   
   return arp.triggeredKey + chordIntervals[chordStep] + (octaveOffset * 12);
 }
-
-void calculateStepInterval() {
-  // Calculate step interval from BPM and speed
-  // BPM = beats per minute, speed = notes per beat (4, 8, 16, 32)
-  float beatsPerSecond = arp.bpm / 60.0;
-  float notesPerSecond = beatsPerSecond * (arp.speed / 4.0);
-  arp.stepInterval = 1000.0 / notesPerSecond;
-}
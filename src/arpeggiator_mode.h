@@ -4,6 +4,7 @@
 #include "common_definitions.h"
 #include "ui_elements.h"
 #include "midi_utils.h"
+#include "generator_runtime.h"
 
 // Arpeggiator mode variables
 struct Arpeggiator {
@@ -11,17 +12,19 @@ struct Arpeggiator {
   int chordType = 0; // 0=Major, 1=Minor, 2=7th
   int pattern = 0; // 0=Up, 1=Down, 2=UpDown, 3=Random, 4=Chance
   int octaves = 2;
-  int speed = 8; // 16th notes
-  int bpm = 120; // BPM control
-  bool isPlaying = false;
-  int currentStep = 0;
-  int currentNote = -1; // Current single note being played
-  unsigned long lastStepTime = 0;
-  unsigned long stepInterval = 125; // Calculated from BPM
-  int triggeredKey = -1; // Which piano key triggered the arp
+  int speed = 8; // Notes per bar: 4, 8, 16 or 32
+  volatile bool isPlaying = false;  // A key is held
+  volatile int currentStep = 0;
+  volatile int currentNote = -1; // Current single note being played
+  volatile int triggeredKey = -1; // Which piano key triggered the arp
   int triggeredOctave = 4; // Octave of the triggered key
+  int8_t transportId = -1;  // Transport subscription
+  volatile bool needsRedraw = false;  // Set by the transport, cleared by the redraw
 };
 
+// Transport ticks per arp note
+#define ARP_TICKS_PER_NOTE(speed) (TRANSPORT_PPQN * 4 / (speed))
+
 // Extern declarations (definitions in arpeggiator_mode.cpp)
 extern Arpeggiator arp;
 extern const char* const patternNames[];
@@ -36,9 +39,8 @@ void drawArpeggiatorMode();
 void handleArpeggiatorMode();
 void drawArpControls();
 void drawPianoKeys();
-void updateArpeggiator();
-void playArpNote();
+void playArpNote(uint32_t stepTimeUs, uint32_t intervalUs);
+void arpeggiatorNoteInput(uint8_t note, bool on);
 int getArpNote();
-void calculateStepInterval();
 
 #endif
\ No newline at end of file
@@ -34,8 +34,9 @@ void initializeAutoChordMode();
 void drawAutoChordMode();
 void handleAutoChordMode();
 void drawChordKeys();
-void playChord(int scaleDegree, bool on);
+void playChord(int scaleDegree, bool on, uint8_t velocity = 100);
 void stopAllChords();
+void autoChordNoteInput(uint8_t note, bool on);
 
 // Implementations
 void initializeAutoChordMode() {
@@ -169,7 +170,7 @@ void handleAutoChordMode() {
       if (isButtonPressed(x, keyY, keyWidth, keyHeight)) {
         if (!chordPressed[i]) {
           // Turn on chord
-          playChord(i, true);
+          playChord(i, true, touch.velocity);
           chordPressed[i] = true;
           drawChordKeys();
         }
@@ -208,7 +209,7 @@ void handleAutoChordMode() {
       
       // Turn on the current chord if not already on
       if (!chordPressed[currentKey]) {
-        playChord(currentKey, true);
+        playChord(currentKey, true, touch.velocity);
         chordPressed[currentKey] = true;
         drawChordKeys();
       }
@@ -229,7 +230,7 @@ void handleAutoChordMode() {
   }
 }
 
-void playChord(int scaleDegree, bool on) {
+void playChord(int scaleDegree, bool on, uint8_t velocity) {
   if (!globalState.bleConnected) return;
   
   // Get root note for this scale degree
@@ -248,7 +249,7 @@ void playChord(int scaleDegree, bool on) {
       if (chord.intervals[i] >= 0) {
         int chordNote = rootNote + chord.intervals[i];
         if (chordNote >= 24 && chordNote <= 108) {
-          sendNoteOn(chordNote, 100);
+          sendNoteOn(chordNote, velocity);
           activeChordNotes[scaleDegree][i] = chordNote;
         }
       }
@@ -264,6 +265,20 @@ void playChord(int scaleDegree, bool on) {
   }
 }
 
+// External keyboard: a key whose pitch class is in the current scale plays
+// the diatonic chord on that degree, for as long as it is held
+void autoChordNoteInput(uint8_t note, bool on) {
+  const Scale& scale = scales[chordScale];
+  for (int degree = 0; degree < scale.numNotes && degree < 7; degree++) {
+    if (scale.intervals[degree] != note % 12) continue;
+    if (chordPressed[degree] == on) return;
+    chordPressed[degree] = on;
+    playChord(degree, on);
+    drawChordKeys();
+    return;
+  }
+}
+
 void stopAllChords() {
   for (int i = 0; i < 8; i++) {
     if (chordPressed[i]) {
@@ -0,0 +1,79 @@
+#include "ble_midi_packet.h"
+
+BLEMIDIPacket::BLEMIDIPacket() {
+  setMTU(BLE_MIDI_DEFAULT_MTU);
+  clear();
+}
+
+void BLEMIDIPacket::setMTU(uint16_t mtu) {
+  size_t payload = (mtu > BLE_MIDI_ATT_OVERHEAD) ? mtu - BLE_MIDI_ATT_OVERHEAD : 0;
+  if (payload < 5) payload = 5;  // Always room for header + one 3-byte message
+  if (payload > BLE_MIDI_MAX_PACKET) payload = BLE_MIDI_MAX_PACKET;
+  maxLength = payload;
+}
+
+void BLEMIDIPacket::clear() {
+  length = 0;
+  count = 0;
+  runningStatus = 0;
+  canOmitTimestamp = false;
+  headerTime = 0;
+  lastTime = 0;
+}
+
+bool BLEMIDIPacket::append(const uint8_t* msg, uint8_t msgLength, uint16_t timestampMs) {
+  if (msgLength == 0 || msgLength > 3 || !(msg[0] & 0x80)) return false;
+
+  uint16_t ts = timestampMs & 0x1FFF;
+  uint8_t status = msg[0];
+
+  if (length > 0) {
+    // Messages must not go backwards in time within a packet - stamp late ones
+    // with the previous time instead of reordering them
+    if (((ts - lastTime) & 0x1FFF) >= 0x1000) ts = lastTime;
+
+    // The low 7 bits may wrap at most once per packet, so limit the span
+    if (((ts - headerTime) & 0x1FFF) >= 0x80) return false;
+  }
+
+  bool isRealtime = status >= 0xF8;
+  bool isChannel = status < 0xF0;
+  bool useRunning = isChannel && status == runningStatus;
+  bool writeTimestamp = !(useRunning && canOmitTimestamp && ts == lastTime);
+
+  size_t needed = (length == 0 ? 1 : 0)       // Header
+                + (writeTimestamp ? 1 : 0)    // Timestamp
+                + (useRunning ? 0 : 1)        // Status
+                + (msgLength - 1);            // Data
+  if (length + needed > maxLength) return false;
+
+  if (length == 0) {
+    headerTime = ts;
+    buffer[length++] = 0x80 | ((ts >> 7) & 0x3F);
+  }
+  if (writeTimestamp) {
+    buffer[length++] = 0x80 | (ts & 0x7F);
+    lastTime = ts;
+  }
+  if (!useRunning) {
+    buffer[length++] = status;
+  }
+  for (uint8_t i = 1; i < msgLength; i++) {
+    buffer[length++] = msg[i] & 0x7F;
+  }
+
+  // Realtime bytes may interleave without affecting running status,
+  // but the next running-status message must carry its own timestamp
+  if (isChannel) {
+    runningStatus = status;
+    canOmitTimestamp = true;
+  } else if (isRealtime) {
+    canOmitTimestamp = false;
+  } else {
+    runningStatus = 0;
+    canOmitTimestamp = false;
+  }
+
+  count++;
+  return true;
+}
@@ -0,0 +1,52 @@
+#ifndef BLE_MIDI_PACKET_H
+#define BLE_MIDI_PACKET_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// BLE-MIDI packet assembler
+// Packs several MIDI messages into a single characteristic notification:
+//
+//   header | timestamp status data... | timestamp status data... | ...
+//
+// The header carries the upper 6 bits of the 13-bit millisecond timestamp,
+// each message is preceded by a timestamp byte with the lower 7 bits.
+// Consecutive channel messages with the same status byte use running status
+// (the status is omitted, and so is the timestamp if it did not change).
+
+#define BLE_MIDI_DEFAULT_MTU  23   // ATT default MTU before negotiation
+#define BLE_MIDI_ATT_OVERHEAD 3    // Opcode + handle in each notification
+#define BLE_MIDI_MAX_PACKET   128  // Upper bound on one assembled packet
+
+class BLEMIDIPacket {
+public:
+  BLEMIDIPacket();
+
+  // Payload size follows the negotiated ATT MTU (clamped to BLE_MIDI_MAX_PACKET)
+  void setMTU(uint16_t mtu);
+  size_t capacity() const { return maxLength; }
+
+  // Append one complete MIDI message (status + 0-2 data bytes).
+  // Returns false if it does not fit - flush the packet and append again.
+  bool append(const uint8_t* msg, uint8_t msgLength, uint16_t timestampMs);
+
+  void clear();
+  bool isEmpty() const { return length == 0; }
+  bool isFull() const { return length + 2 > maxLength; }  // Not even a realtime byte fits
+
+  const uint8_t* data() const { return buffer; }
+  size_t size() const { return length; }
+  uint8_t messageCount() const { return count; }
+
+private:
+  uint8_t buffer[BLE_MIDI_MAX_PACKET];
+  size_t length;
+  size_t maxLength;
+  uint8_t count;
+  uint8_t runningStatus;   // 0 = none
+  bool canOmitTimestamp;   // Last item was a channel message using runningStatus
+  uint16_t headerTime;     // 13-bit time of the first message in the packet
+  uint16_t lastTime;       // 13-bit time of the last timestamp byte written
+};
+
+#endif // BLE_MIDI_PACKET_H
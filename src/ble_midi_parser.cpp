@@ -0,0 +1,148 @@
+#include "ble_midi_parser.h"
+
+BLEMIDIParser::BLEMIDIParser()
+  : eventHandler(nullptr), eventContext(nullptr),
+    sysexHandler(nullptr), sysexContext(nullptr), errors(0) {
+  reset();
+}
+
+void BLEMIDIParser::setHandler(MIDIInputHandler handler, void* context) {
+  eventHandler = handler;
+  eventContext = context;
+}
+
+void BLEMIDIParser::setSysExHandler(SysExHandler handler, void* context) {
+  sysexHandler = handler;
+  sysexContext = context;
+}
+
+void BLEMIDIParser::reset() {
+  status = 0;
+  dataNeeded = 0;
+  dataCount = 0;
+  timestamp = 0;
+  inSysEx = false;
+  sysexOverflow = false;
+  sysexLength = 0;
+}
+
+void BLEMIDIParser::parse(const uint8_t* data, size_t length) {
+  // Header: bit 7 set, bit 6 reserved (0), bits 5-0 = timestamp high
+  if (length < 2 || (data[0] & 0xC0) != 0x80) {
+    errors++;
+    return;
+  }
+
+  uint8_t timeHigh = data[0] & 0x3F;
+  uint8_t lastLow = 0;
+  bool haveLow = false;
+  bool afterTimestamp = false;
+
+  for (size_t i = 1; i < length; i++) {
+    uint8_t byte = data[i];
+
+    if (!(byte & 0x80)) {
+      afterTimestamp = false;
+      handleData(byte);
+      continue;
+    }
+
+    // A byte with bit 7 set is a timestamp, unless it directly follows one,
+    // in which case it is the status byte of the timestamped message
+    if (!afterTimestamp) {
+      uint8_t low = byte & 0x7F;
+      if (haveLow && low < lastLow) timeHigh = (timeHigh + 1) & 0x3F;  // Low bits wrapped
+      lastLow = low;
+      haveLow = true;
+      timestamp = ((uint16_t)timeHigh << 7) | low;
+      afterTimestamp = true;
+      continue;
+    }
+
+    afterTimestamp = false;
+    handleStatus(byte);
+  }
+
+  // A timestamp with nothing after it, or a message cut short, is an error -
+  // but running status and SysEx legitimately continue into the next packet
+  if (afterTimestamp) errors++;
+  if (!inSysEx && dataCount != 0) {
+    errors++;
+    dataCount = 0;
+  }
+}
+
+void BLEMIDIParser::handleStatus(uint8_t byte) {
+  // Realtime: dispatched at once, leaves running status and SysEx untouched
+  if (byte >= 0xF8) {
+    emit(byte, 0, 0);
+    return;
+  }
+
+  if (inSysEx) {
+    inSysEx = false;
+    if (byte == 0xF7) {
+      if (sysexOverflow) errors++;
+      else if (sysexHandler) sysexHandler(sysexBuffer, sysexLength, timestamp, sysexContext);
+      status = 0;
+      return;
+    }
+    errors++;  // SysEx aborted by another status byte, which is still honoured
+  }
+
+  dataCount = 0;
+
+  if (byte == 0xF0) {
+    inSysEx = true;
+    sysexOverflow = false;
+    sysexLength = 0;
+    status = 0;
+    return;
+  }
+
+  if (byte >= 0xF0) {
+    // System common cancels running status
+    switch (byte) {
+      case 0xF1: case 0xF3: dataNeeded = 1; break;  // MTC quarter frame, Song select
+      case 0xF2: dataNeeded = 2; break;             // Song position
+      case 0xF7: errors++; status = 0; return;      // Stray EOX
+      default: dataNeeded = 0; break;               // Tune request, undefined
+    }
+    status = byte;
+    if (dataNeeded == 0) {
+      emit(byte, 0, 0);
+      status = 0;
+    }
+    return;
+  }
+
+  status = byte;
+  uint8_t type = byte & 0xF0;
+  dataNeeded = (type == 0xC0 || type == 0xD0) ? 1 : 2;
+}
+
+void BLEMIDIParser::handleData(uint8_t byte) {
+  if (inSysEx) {
+    if (sysexLength < BLE_MIDI_SYSEX_MAX) sysexBuffer[sysexLength++] = byte;
+    else sysexOverflow = true;
+    return;
+  }
+
+  if (status == 0) {
+    errors++;  // Data with no status to attach it to
+    return;
+  }
+
+  dataBytes[dataCount++] = byte;
+  if (dataCount < dataNeeded) return;
+
+  emit(status, dataBytes[0], dataNeeded > 1 ? dataBytes[1] : 0);
+  dataCount = 0;
+  if (status >= 0xF0) status = 0;  // Only channel messages run on
+}
+
+void BLEMIDIParser::emit(uint8_t statusByte, uint8_t d1, uint8_t d2) {
+  if (!eventHandler) return;
+  MIDIInputEvent event = {statusByte, d1, d2, timestamp};
+  eventHandler(event, eventContext);
+}
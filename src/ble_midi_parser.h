@@ -0,0 +1,67 @@
+#ifndef BLE_MIDI_PARSER_H
+#define BLE_MIDI_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Incremental BLE-MIDI decoder (the counterpart of BLEMIDIPacket)
+// Feed it each characteristic write as it arrives; it handles
+// - several timestamped messages per packet, with 13-bit timestamp rollover
+// - running status, with or without a repeated timestamp byte
+// - system realtime bytes interleaved anywhere, including inside a message
+// - SysEx split over any number of packets (data continues right after the
+//   next packet's header byte)
+// Malformed input is skipped and counted, never read out of bounds.
+//
+// Plain C++ (no Arduino/FreeRTOS) so it can be fed arbitrary bytes on the host.
+
+#define BLE_MIDI_SYSEX_MAX 128  // Longer SysEx messages are dropped
+
+struct MIDIInputEvent {
+  uint8_t status;        // Full status byte (channel in the low nibble)
+  uint8_t data1;
+  uint8_t data2;
+  uint16_t timestampMs;  // 13-bit BLE-MIDI time from the sender
+};
+
+typedef void (*MIDIInputHandler)(const MIDIInputEvent& event, void* context);
+typedef void (*SysExHandler)(const uint8_t* data, size_t length, uint16_t timestampMs, void* context);
+
+class BLEMIDIParser {
+public:
+  BLEMIDIParser();
+
+  void setHandler(MIDIInputHandler handler, void* context = nullptr);
+  void setSysExHandler(SysExHandler handler, void* context = nullptr);
+
+  // Decode one BLE-MIDI packet. State carries over to the next call.
+  void parse(const uint8_t* data, size_t length);
+  void reset();
+
+  uint32_t errorCount() const { return errors; }
+
+private:
+  MIDIInputHandler eventHandler;
+  void* eventContext;
+  SysExHandler sysexHandler;
+  void* sysexContext;
+
+  uint8_t status;         // Running status (0 = none)
+  uint8_t dataNeeded;     // Data bytes for the current status
+  uint8_t dataCount;
+  uint8_t dataBytes[2];
+  uint16_t timestamp;     // Time of the message being decoded
+
+  bool inSysEx;
+  bool sysexOverflow;
+  size_t sysexLength;
+  uint8_t sysexBuffer[BLE_MIDI_SYSEX_MAX];
+
+  uint32_t errors;
+
+  void handleStatus(uint8_t byte);
+  void handleData(uint8_t byte);
+  void emit(uint8_t statusByte, uint8_t d1, uint8_t d2);
+};
+
+#endif // BLE_MIDI_PARSER_H
@@ -4,6 +4,7 @@
 #include "common_definitions.h"
 #include "ui_elements.h"
 #include "midi_utils.h"
+#include "play_area_renderer.h"
 
 // Pong-style Ambient MIDI mode variables
 struct Ball {
@@ -19,6 +20,7 @@ struct Ball {
 #define PLAY_AREA_MARGIN_Y_TOP (CONTENT_TOP + 20)
 #define PLAY_AREA_MARGIN_Y_BOTTOM (SCREEN_HEIGHT > 250 ? 100 : 80)
 #define WALL_THICKNESS 4
+#define WALL_LABEL_RISE 2  // Note names of the top walls start above the wall
 
 #define MAX_BALLS 4
 Ball balls[MAX_BALLS];
@@ -49,8 +51,11 @@ void initializeBalls();
 void initializeWalls();
 void updateBouncingBall();
 void updateBalls();
-void drawBalls();
-void drawWalls();
+void drawBalls(TFT_eSPI& gfx, int16_t ox, int16_t oy);
+void drawWalls(TFT_eSPI& gfx, int16_t ox, int16_t oy);
+void paintBouncingBallArea(TFT_eSPI& gfx, int16_t ox, int16_t oy);
+void invalidateBall(int i);
+void invalidateWall(int i);
 void checkWallCollisions();
 
 // Implementations
@@ -88,8 +93,12 @@ void drawBouncingBallMode() {
   tft.drawString("Oct:" + String(ballOctave), SCREEN_WIDTH / 2, statusY, 2);
   tft.drawString("Balls:" + String(numActiveBalls), SCREEN_WIDTH - 80, statusY, 2);
   
-  drawWalls();
-  drawBalls();
+  // Walls and balls are rendered off-screen, strip by strip
+  const int playTop = PLAY_AREA_MARGIN_Y_TOP - WALL_LABEL_RISE;
+  PlayAreaRenderer::begin(PLAY_AREA_MARGIN_X, playTop, SCREEN_WIDTH - 2 * PLAY_AREA_MARGIN_X,
+                          SCREEN_HEIGHT - PLAY_AREA_MARGIN_Y_BOTTOM - playTop, paintBouncingBallArea);
+  PlayAreaRenderer::invalidateAll();
+  PlayAreaRenderer::render();
 }
 
 void initializeBalls() {
@@ -273,29 +282,42 @@ void updateBouncingBall() {
   // Smooth 60 FPS animation
   static unsigned long lastUpdate = 0;
   if (millis() - lastUpdate > 16) {
-    const int playLeft = PLAY_AREA_MARGIN_X;
-    const int playRight = SCREEN_WIDTH - PLAY_AREA_MARGIN_X;
-    const int playTop = PLAY_AREA_MARGIN_Y_TOP;
-    const int playBottom = SCREEN_HEIGHT - PLAY_AREA_MARGIN_Y_BOTTOM;
-    
-    // Clear entire play area to prevent flickering
-    tft.fillRect(playLeft + WALL_THICKNESS, playTop + WALL_THICKNESS, 
-                 playRight - playLeft - 2 * WALL_THICKNESS, 
-                 playBottom - playTop - 2 * WALL_THICKNESS, THEME_BG);
-    
+    // Where the balls were and where they go need repainting
+    for (int i = 0; i < numActiveBalls; i++) invalidateBall(i);
     updateBalls();
     checkWallCollisions();
+    for (int i = 0; i < numActiveBalls; i++) invalidateBall(i);
     
-    // Draw walls
-    drawWalls();
-    
-    // Draw balls
-    drawBalls();
+    // End the flash of walls hit more than 200ms ago
+    for (int i = 0; i < NUM_WALLS; i++) {
+      if (walls[i].active && millis() - walls[i].activeTime >= 200) {
+        walls[i].active = false;
+        invalidateWall(i);
+      }
+    }
     
+    PlayAreaRenderer::render();
     lastUpdate = millis();
   }
 }
 
+void invalidateBall(int i) {
+  if (!balls[i].active) return;
+  int r = balls[i].size + 2;  // Outline and rounding
+  PlayAreaRenderer::invalidate((int)balls[i].x - r, (int)balls[i].y - r, 2 * r + 1, 2 * r + 1);
+}
+
+void invalidateWall(int i) {
+  // With the note name, which is 8px high from just above the wall
+  PlayAreaRenderer::invalidate(walls[i].x, walls[i].y - WALL_LABEL_RISE, walls[i].w, max(walls[i].h, 8) + WALL_LABEL_RISE);
+}
+
+// Everything in the play area, for PlayAreaRenderer
+void paintBouncingBallArea(TFT_eSPI& gfx, int16_t ox, int16_t oy) {
+  drawWalls(gfx, ox, oy);
+  drawBalls(gfx, ox, oy);
+}
+
 void updateBalls() {
   const int playLeft = PLAY_AREA_MARGIN_X;
   const int playRight = SCREEN_WIDTH - PLAY_AREA_MARGIN_X;
@@ -329,37 +351,28 @@ void updateBalls() {
   }
 }
 
-void drawBalls() {
+void drawBalls(TFT_eSPI& gfx, int16_t ox, int16_t oy) {
   for (int i = 0; i < numActiveBalls; i++) {
     if (!balls[i].active) continue;
-    tft.fillCircle(balls[i].x, balls[i].y, balls[i].size, balls[i].color);
-    tft.drawCircle(balls[i].x, balls[i].y, balls[i].size, THEME_TEXT);
+    gfx.fillCircle(balls[i].x - ox, balls[i].y - oy, balls[i].size, balls[i].color);
+    gfx.drawCircle(balls[i].x - ox, balls[i].y - oy, balls[i].size, THEME_TEXT);
   }
 }
 
-void drawWalls() {
+void drawWalls(TFT_eSPI& gfx, int16_t ox, int16_t oy) {
   for (int i = 0; i < NUM_WALLS; i++) {
-    uint16_t color = walls[i].color;
-    
-    // Bright flash when active
-    if (walls[i].active) {
-      unsigned long elapsed = millis() - walls[i].activeTime;
-      if (elapsed < 200) {
-        color = THEME_TEXT; // Bright white flash
-      } else {
-        walls[i].active = false;
-      }
-    }
+    // Bright white flash when active
+    uint16_t color = walls[i].active ? THEME_TEXT : walls[i].color;
     
     // Draw wall
-    tft.fillRect(walls[i].x, walls[i].y, walls[i].w, walls[i].h, color);
+    gfx.fillRect(walls[i].x - ox, walls[i].y - oy, walls[i].w, walls[i].h, color);
     
     // Add note name for horizontal walls (top and bottom)
     if (walls[i].w > walls[i].h && walls[i].w > 30) {
-      tft.setTextColor(THEME_BG, color);
-      tft.drawCentreString(walls[i].noteName, 
-                          walls[i].x + walls[i].w/2, 
-                          walls[i].y - 2, 1);
+      gfx.setTextColor(THEME_BG, color);
+      gfx.drawCentreString(walls[i].noteName, 
+                          walls[i].x + walls[i].w/2 - ox, 
+                          walls[i].y - WALL_LABEL_RISE - oy, 1);
     }
   }
 }
@@ -418,11 +431,11 @@ void checkWallCollisions() {
       
       if (collision) {
         int velocity = random(70, 110);
-        sendNoteOn(walls[w].note, velocity);
-        sendNoteOff(walls[w].note);
+        scheduleNote(walls[w].note, velocity, micros(), 100000);  // Short percussive gate
         
         walls[w].active = true;
         walls[w].activeTime = millis();
+        invalidateWall(w);
         
         Serial.printf("Wall segment hit: %s\n", walls[w].noteName.c_str());
         break; // Only trigger one wall per ball per frame
@@ -0,0 +1,157 @@
+#include "clock_engine.h"
+
+esp_timer_handle_t ClockEngine::timer = nullptr;
+TaskHandle_t ClockEngine::notifyTask = nullptr;
+ClockPhase ClockEngine::phase;
+SPSCQueue<MIDIThread::MIDIMessage, CLOCK_QUEUE_SIZE> ClockEngine::realtimeQueue;
+volatile bool ClockEngine::running = false;
+volatile bool ClockEngine::startPending = false;
+volatile bool ClockEngine::resumePending = false;
+volatile bool ClockEngine::stopPending = false;
+volatile bool ClockEngine::outputEnabled = true;
+volatile uint32_t ClockEngine::requestedBpmMilli = 120000;
+volatile uint16_t ClockEngine::requestedPpqn = MIDI_CLOCK_PPQN;
+volatile uint32_t ClockEngine::followBeatUs = 0;
+volatile bool ClockEngine::followPending = false;
+uint32_t ClockEngine::appliedBpmMilli = 120000;
+uint16_t ClockEngine::clockDivider = TRANSPORT_PPQN / MIDI_CLOCK_PPQN;
+uint32_t ClockEngine::position = 0;
+volatile uint32_t ClockEngine::skipped = 0;
+
+void ClockEngine::begin(TaskHandle_t midiTask) {
+  notifyTask = midiTask;
+  
+  esp_timer_create_args_t args = {};
+  args.callback = onTimer;
+  args.name = "midi_clock";
+  esp_timer_create(&args, &timer);
+}
+
+void ClockEngine::start() {
+  startPending = true;
+  resumePending = false;
+  stopPending = false;
+  kick();
+}
+
+void ClockEngine::resume() {
+  resumePending = true;
+  stopPending = false;
+  kick();
+}
+
+void ClockEngine::stop() {
+  if (!running && !startPending && !resumePending) return;
+  stopPending = true;
+  kick();
+}
+
+void ClockEngine::setBPM(float bpm) {
+  requestedBpmMilli = (uint32_t)(bpm * 1000.0f + 0.5f);
+}
+
+void ClockEngine::setPPQN(uint16_t ppqn) {
+  if (ppqn > 0 && ppqn <= TRANSPORT_PPQN && TRANSPORT_PPQN % ppqn == 0) requestedPpqn = ppqn;
+}
+
+void ClockEngine::setOutput(bool enabled) {
+  outputEnabled = enabled;
+}
+
+void ClockEngine::follow(float bpm, uint32_t beatUs) {
+  outputEnabled = false;
+  setBPM(bpm);
+  followBeatUs = beatUs;
+  followPending = true;
+}
+
+// Run the callback now instead of waiting for the armed tick. If the callback
+// is executing at this moment the restart fails, and the flags are picked up
+// when it fires next - within one tick.
+void ClockEngine::kick() {
+  if (!timer) return;
+  esp_timer_stop(timer);
+  esp_timer_start_once(timer, 1);
+}
+
+void ClockEngine::push(MIDIThread::MIDIMessage::Type type, uint32_t timestampUs) {
+  uint8_t local = outputEnabled ? 0 : MIDI_REALTIME_LOCAL;
+  MIDIThread::MIDIMessage msg = {type, local, 0, 0, timestampUs};
+  realtimeQueue.push(msg);
+}
+
+// Move the grid towards the master's beat. The correction is limited to one
+// transport tick (a quarter of an outgoing clock) per beat so the outgoing
+// clock slews instead of jumping.
+void ClockEngine::applyFollow(uint64_t now) {
+  followPending = false;
+  uint64_t beatLen = phase.beatUs();
+  uint64_t next = phase.nextTickUs();
+  uint32_t toNextBeat = (TRANSPORT_PPQN - position % TRANSPORT_PPQN) % TRANSPORT_PPQN;
+  uint64_t ourBeat = next + toNextBeat * beatLen / TRANSPORT_PPQN;
+  
+  // Master beat nearest to ours, in 64-bit timer time (micros() is its low 32 bits)
+  uint64_t masterBeat = now + (int32_t)(followBeatUs - (uint32_t)now);
+  int64_t offset = (int64_t)(masterBeat - ourBeat) % (int64_t)beatLen;
+  if (offset > (int64_t)beatLen / 2) offset -= beatLen;
+  if (offset < -(int64_t)beatLen / 2) offset += beatLen;
+  
+  int64_t limit = beatLen / TRANSPORT_PPQN;
+  if (offset > limit) offset = limit;
+  if (offset < -limit) offset = -limit;
+  phase.shift(offset);
+}
+
+void ClockEngine::onTimer(void*) {
+  uint64_t now = esp_timer_get_time();
+  
+  if (stopPending) {
+    stopPending = false;
+    startPending = false;
+    resumePending = false;
+    running = false;
+    push(MIDIThread::MIDIMessage::STOP, (uint32_t)now);
+    xTaskNotifyGive(notifyTask);
+    return;  // Not re-armed
+  }
+  
+  if (startPending || resumePending) {
+    bool fromTop = startPending;
+    startPending = false;
+    resumePending = false;
+    running = true;
+    appliedBpmMilli = requestedBpmMilli;
+    clockDivider = TRANSPORT_PPQN / requestedPpqn;
+    if (fromTop) position = 0;
+    phase.start(now, appliedBpmMilli, TRANSPORT_PPQN);
+    push(fromTop ? MIDIThread::MIDIMessage::START : MIDIThread::MIDIMessage::CONTINUE, (uint32_t)now);
+  }
+  
+  if (!running) return;
+  
+  // Tempo requests are queued on the phase, which applies them on a beat
+  if (requestedBpmMilli != appliedBpmMilli) {
+    appliedBpmMilli = requestedBpmMilli;
+    phase.setBPM(appliedBpmMilli);
+  }
+  if (followPending) applyFollow(now);
+  
+  // Emit every tick that is due (normally exactly one), stamped with its ideal time
+  uint32_t late = phase.skipLate(now);
+  skipped += late;
+  position += late;
+  while (phase.nextTickUs() <= now) {
+    uint32_t tickUs = (uint32_t)phase.nextTickUs();
+    
+    // Output rate changes wait for a beat so the receiver never sees a short pulse
+    if (position % TRANSPORT_PPQN == 0) clockDivider = TRANSPORT_PPQN / requestedPpqn;
+    if (outputEnabled && position % clockDivider == 0) push(MIDIThread::MIDIMessage::CLOCK, tickUs);
+    push(MIDIThread::MIDIMessage::TICK, tickUs);
+    
+    phase.advance();
+    position++;
+  }
+  xTaskNotifyGive(notifyTask);
+  
+  esp_timer_start_once(timer, phase.nextTickUs() - now);
+}
@@ -0,0 +1,71 @@
+#ifndef CLOCK_ENGINE_H
+#define CLOCK_ENGINE_H
+
+#include "common_definitions.h"
+#include "clock_phase.h"
+#include "esp_timer.h"
+
+// Master clock driven by a one-shot esp_timer
+// - Each callback re-arms the timer for the exact microsecond of the next tick
+//   (see ClockPhase), so nothing drifts or rounds to 1ms
+// - Ticks run at TRANSPORT_PPQN; every one is handed to the MIDI task as a
+//   TICK for the Transport, and every (TRANSPORT_PPQN / output PPQN)-th one
+//   also goes out as MIDI Clock, so the outgoing clock and every generator
+//   share one timebase
+// - CLOCK/TICK/START/STOP/CONTINUE are produced in the timer callback and
+//   handed to the MIDI task through their own SPSC ring, then the task is
+//   woken immediately
+// - start()/stop()/setBPM() may be called from any task; they only set
+//   flags and kick the timer, the callback owns all clock state
+// - With the output off the Transport runs just the same, but no MIDI Clock
+//   is produced and START/STOP/CONTINUE are marked MIDI_REALTIME_LOCAL, so
+//   nothing goes on the wire
+
+#define CLOCK_QUEUE_SIZE 128   // Power of two (SPSC ring)
+
+class ClockEngine {
+public:
+  static void begin(TaskHandle_t midiTask);
+  static void start();                // From the top: START, tick 0
+  static void resume();               // CONTINUE from the current position
+  static void stop();
+  static void setBPM(float bpm);      // Takes effect at the next beat
+  static void setPPQN(uint16_t ppqn); // Outgoing MIDI clock rate, must divide TRANSPORT_PPQN
+  static void setOutput(bool enabled); // Applies from the next message; set it before start()
+  static bool isRunning() { return startPending || (running && !stopPending); }  // Including requests
+
+  // Follow an external master: beatUs is the micros() time of one of its
+  // beats. Tempo and phase are pulled in over the next few beats. Turns the
+  // output off, so the master never hears its own clock back.
+  static void follow(float bpm, uint32_t beatUs);
+
+  // MIDI task side: next realtime message produced by the timer
+  static bool popRealtime(MIDIThread::MIDIMessage& msg) { return realtimeQueue.pop(msg); }
+  static uint32_t ticksSkipped() { return skipped; }
+
+private:
+  static esp_timer_handle_t timer;
+  static TaskHandle_t notifyTask;
+  static ClockPhase phase;
+  static SPSCQueue<MIDIThread::MIDIMessage, CLOCK_QUEUE_SIZE> realtimeQueue;
+  static volatile bool running;
+  static volatile bool startPending;
+  static volatile bool resumePending;
+  static volatile bool stopPending;
+  static volatile bool outputEnabled;
+  static volatile uint32_t requestedBpmMilli;
+  static volatile uint16_t requestedPpqn;
+  static volatile uint32_t followBeatUs;
+  static volatile bool followPending;
+  static uint32_t appliedBpmMilli;
+  static uint16_t clockDivider;       // Transport ticks per outgoing clock
+  static uint32_t position;           // Transport ticks since START
+  static volatile uint32_t skipped;
+
+  static void onTimer(void* arg);
+  static void kick();
+  static void push(MIDIThread::MIDIMessage::Type type, uint32_t timestampUs);
+  static void applyFollow(uint64_t now);
+};
+
+#endif // CLOCK_ENGINE_H
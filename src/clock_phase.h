@@ -0,0 +1,99 @@
+#ifndef CLOCK_PHASE_H
+#define CLOCK_PHASE_H
+
+#include <stdint.h>
+
+// Tick timing for the MIDI clock, in exact integer arithmetic
+// - Tempo is held in milli-BPM (120000 = 120.000 BPM)
+// - Tick n after the anchor is due at
+//     anchorUs + n * 60,000,000,000 / (bpmMilli * ppqn)
+//   computed from the anchor every time, so rounding never accumulates:
+//   each tick is within 1us of ideal no matter how long the clock runs
+// - Tempo and PPQN changes wait for the next beat boundary, where the anchor
+//   moves to that beat's tick time
+//
+// Plain C++ (no Arduino/FreeRTOS) so the math can be checked on the host.
+
+#define MIDI_CLOCK_PPQN 24
+#define TRANSPORT_PPQN 96       // Internal tick grid (see Transport)
+#define CLOCK_MIN_BPM_MILLI 20000
+#define CLOCK_MAX_BPM_MILLI 300000
+
+class ClockPhase {
+public:
+  ClockPhase()
+    : anchorUs(0), tick(0), totalTicks(0), bpmMilli(120000), ppqn(MIDI_CLOCK_PPQN),
+      pendingBpmMilli(0), pendingPpqn(0) {}
+
+  // Restart the tick grid with tick 0 due at startUs
+  void start(uint64_t startUs, uint32_t newBpmMilli, uint16_t newPpqn = MIDI_CLOCK_PPQN) {
+    anchorUs = startUs;
+    tick = 0;
+    totalTicks = 0;
+    bpmMilli = clampBpm(newBpmMilli);
+    ppqn = newPpqn ? newPpqn : MIDI_CLOCK_PPQN;
+    pendingBpmMilli = 0;
+    pendingPpqn = 0;
+  }
+
+  // Applied at the next beat boundary so the current beat keeps its length
+  void setBPM(uint32_t newBpmMilli) { pendingBpmMilli = clampBpm(newBpmMilli); }
+  void setPPQN(uint16_t newPpqn) { pendingPpqn = newPpqn; }
+
+  uint64_t nextTickUs() const { return tickTimeUs(tick); }
+
+  // Move past the tick returned by nextTickUs()
+  void advance() {
+    tick++;
+    totalTicks++;
+    if (tick % ppqn == 0 && (pendingBpmMilli || pendingPpqn)) {
+      anchorUs = tickTimeUs(tick);
+      tick = 0;
+      if (pendingBpmMilli) bpmMilli = pendingBpmMilli;
+      if (pendingPpqn) ppqn = pendingPpqn;
+      pendingBpmMilli = 0;
+      pendingPpqn = 0;
+    }
+  }
+
+  // Drop ticks that are already more than one beat late (after a stall),
+  // keeping the grid phase. Returns the number of ticks skipped.
+  uint32_t skipLate(uint64_t nowUs) {
+    uint32_t skipped = 0;
+    while (nowUs > tickTimeUs(tick) + beatUs() && !(pendingBpmMilli || pendingPpqn)) {
+      tick++;
+      totalTicks++;
+      skipped++;
+    }
+    return skipped;
+  }
+
+  // Move the whole grid by offsetUs (phase correction when following a master)
+  void shift(int64_t offsetUs) { anchorUs += offsetUs; }
+
+  uint64_t ticks() const { return totalTicks; }   // Since start()
+  uint32_t bpm() const { return bpmMilli; }
+  uint16_t pulsesPerQuarter() const { return ppqn; }
+  uint64_t beatUs() const { return 60000000000ULL / bpmMilli; }
+
+private:
+  uint64_t anchorUs;        // Time of tick 0 in the current tempo segment
+  uint64_t tick;            // Ticks since anchorUs
+  uint64_t totalTicks;
+  uint32_t bpmMilli;
+  uint16_t ppqn;
+  uint32_t pendingBpmMilli; // 0 = no change queued
+  uint16_t pendingPpqn;
+
+  uint64_t tickTimeUs(uint64_t n) const {
+    return anchorUs + (n * 60000000000ULL) / ((uint64_t)bpmMilli * ppqn);
+  }
+
+  static uint32_t clampBpm(uint32_t b) {
+    if (b < CLOCK_MIN_BPM_MILLI) return CLOCK_MIN_BPM_MILLI;
+    if (b > CLOCK_MAX_BPM_MILLI) return CLOCK_MAX_BPM_MILLI;
+    return b;
+  }
+};
+
+#endif // CLOCK_PHASE_H
@@ -4,6 +4,15 @@
 #include <TFT_eSPI.h>
 #include <XPT2046_Touchscreen.h>
 #include <BLEDevice.h>
+#include "spsc_queue.h"
+#include "midi_scheduler.h"
+#include "active_notes.h"
+#include "ble_midi_parser.h"
+#include "tempo_tracker.h"
+#include "touch_filter.h"
+#include "gesture_recognizer.h"
+#include "touch_event.h"
+#include "touch_recording.h"
 
 // Color scheme
 #define THEME_BG         0x0841
@@ -84,6 +93,8 @@ struct TouchState {
   bool justPressed = false;
   bool justReleased = false;
   int x = 0, y = 0;
+  uint32_t timestampUs = 0;  // micros() when the latest touch event was sampled
+  uint8_t velocity = 100;    // 1-127 from the pressure of the latest press
 };
 
 // Global BPM (shared across all modules)
@@ -107,27 +118,70 @@ struct MIDIClockSync {
   unsigned long lastBPMUpdate = 0;
 };
 extern MIDIClockSync midiClock;
+extern TempoTracker clockTracker;  // Tempo and phase of the incoming clock
 
 // Touch event callback type
 typedef void (*TouchCallback)(int x, int y, bool pressed);
 
+// Raw XPT2046 reading to screen coordinates; false while uncalibrated
+typedef bool (*TouchMapper)(uint16_t rawX, uint16_t rawY, int16_t& x, int16_t& y);
+
+#define TOUCH_SAMPLE_HZ 200
+#define TOUCH_EVENT_QUEUE_SIZE 64   // Power of two (SPSC ring)
+
 // Touch thread manager
+// - Owns the XPT2046 once setup is done: samples it at TOUCH_SAMPLE_HZ on
+//   core 0, runs the readings through a TouchFilter, maps them through the
+//   calibration and publishes press/move/release events with their sample
+//   time and velocity into a lock-free queue
+// - The loop drains the queue in updateTouch(), so a tap is seen exactly
+//   once however long the frame took to draw
 class TouchThread {
 public:
-  static void begin();
+  static void begin(TouchMapper mapper);
   static void update();
+  static bool popEvent(TouchEvent& event);  // Loop task only
+  static uint32_t droppedEvents() { return events.dropCount(); }
+  static void configureFilter(const TouchFilterConfig& config);  // Applied at the next sample
   static void registerCallback(TouchCallback callback);
   static void unregisterCallback();
   static TouchState getState();
   
 private:
   static TouchCallback activeCallback;
+  static TouchMapper mapPoint;
   static TouchState currentState;
   static SemaphoreHandle_t touchMutex;
+  static SPSCQueue<TouchEvent, TOUCH_EVENT_QUEUE_SIZE> events;
+  static TouchFilter filter;              // Touch task only
+  static TouchFilterConfig pendingConfig; // Guarded by touchMutex
+  static volatile bool configPending;
+  static void publish(TouchEventType type, int16_t x, int16_t y, uint8_t velocity, uint32_t timeUs);
   static void touchTask(void* parameter);
 };
 
+// MIDI output statistics (see MIDIThread::getStats)
+struct MIDIStats {
+  uint32_t sent;             // Messages handed to BLE
+  uint32_t dropped;          // Messages lost to a full queue
+  uint32_t highWaterMark;    // Deepest queue fill seen
+  uint32_t latencyLastUs;    // Enqueue-to-notify latency of the last message
+  uint32_t latencyAvgUs;     // Running average (1/16 weight)
+  uint32_t latencyMaxUs;     // Worst case since last reset
+  uint32_t scheduleDropped;  // Future events lost to a full scheduler heap
+  uint32_t scheduledPending; // Future events currently waiting
+};
+
+#define MIDI_QUEUE_SIZE 128     // Power of two (SPSC ring)
+#define MIDI_SCHEDULE_SIZE 128  // Future events held by the MIDI task
+#define MIDI_CAPTURE_SIZE 256   // Power of two; drained every loop() pass while capturing
+#define MIDI_REALTIME_LOCAL 1   // Realtime message for the Transport only (clock output off)
+
 // MIDI thread manager
+// The send* functions are the single producer of the output ring and must be
+// called from the Arduino loop task only; the MIDI task is the single consumer.
+// Transport step handlers run on the MIDI task itself - their send*/schedule*
+// calls bypass the ring and go straight into the task's scheduler heap.
 class MIDIThread {
 public:
   static void begin();
@@ -135,23 +189,97 @@ public:
   static void sendNoteOff(uint8_t note, uint8_t velocity);
   static void sendCC(uint8_t controller, uint8_t value);
   static void sendPitchBend(int16_t value);
-  static void sendClock();
-  static void sendStart();
+  static void sendClock();   // Single manual tick
+  static void sendStart();   // Start the timer-driven clock (ClockEngine)
+  static void sendContinue();
   static void sendStop();
+  static void setClockOutput(bool enabled);  // Off: START/STOP/clock only drive the Transport
   static void setBPM(float bpm);
   static float getBPM();
   
-private:
-  static QueueHandle_t midiQueue;
-  static SemaphoreHandle_t midiMutex;
-  static void midiTask(void* parameter);
+  // BLE-MIDI packet assembly (several messages per notification)
+  static void setMTU(uint16_t mtu);                // Negotiated ATT MTU
+  static void setFlushDeadline(uint32_t deadlineUs); // Max time a message waits for company
+  
+  // Queue and latency counters
+  static MIDIStats getStats();
+  static void resetStats();
   
   struct MIDIMessage {
-    enum Type { NOTE_ON, NOTE_OFF, CC, PITCH_BEND, CLOCK, START, STOP } type;
-    uint8_t data1;
+    enum Type { NOTE_ON, NOTE_OFF, CC, PITCH_BEND, CLOCK, START, STOP, CONTINUE,
+                TICK, CANCEL_SCHEDULED, PANIC } type;  // TICK drives the Transport, not sent
+    uint8_t data1;         // START/STOP/CONTINUE: MIDI_REALTIME_LOCAL when not sent
     uint8_t data2;
     int16_t data16;
+    uint32_t timestampUs;  // micros() when the message was generated, or when it is due
   };
+  
+  // Future events - held on the MIDI core and emitted at dueTimeUs (micros() timebase).
+  // Events already due are sent immediately. A scheduled note-off for a note
+  // that was retriggered in the meantime is absorbed (NoteOverlap).
+  static void schedule(const MIDIMessage& event, uint32_t dueTimeUs);
+  static void scheduleNoteOn(uint8_t note, uint8_t velocity, uint32_t dueTimeUs);
+  static void scheduleNoteOff(uint8_t note, uint32_t dueTimeUs);
+  static void scheduleCC(uint8_t controller, uint8_t value, uint32_t dueTimeUs);
+  static void schedulePitchBend(int16_t value, uint32_t dueTimeUs);
+  static void scheduleCCRamp(uint8_t controller, uint8_t from, uint8_t to,
+                             uint32_t startUs, uint32_t durationUs, uint8_t steps = 8);
+  static void cancelScheduled();  // Drop everything not yet due (panic)
+  
+  // Sounding notes, tracked as messages go out (channel 1-16)
+  static bool isNoteActive(uint8_t channel, uint8_t note);
+  static uint8_t activeNoteCount(uint8_t channel);
+  static void getActiveNotes(uint8_t channel, uint32_t out[4]);
+  
+  // Note Off for every sounding note (or one CC 123 per channel that has any)
+  static void panic(bool allNotesOffCC = false);
+  
+  // Copy of the output for TouchRecorder: everything that goes on the wire,
+  // and channel messages even without a BLE connection
+  static void setCapture(bool enabled);
+  static bool popCapture(MIDICapture& midi);  // Loop task only
+  
+private:
+  static SPSCQueue<MIDIMessage, MIDI_QUEUE_SIZE> midiQueue;
+  static SemaphoreHandle_t midiMutex;
+  static volatile uint16_t negotiatedMTU;
+  static volatile uint32_t flushDeadlineUs;
+  static MIDIStats stats;
+  static TaskHandle_t taskHandle;
+  static ActiveNoteMap activeNotes;
+  static TimedEventHeap<MIDIMessage, MIDI_SCHEDULE_SIZE> scheduled;  // MIDI task only
+  static NoteOverlap overlap;  // MIDI task only
+  static SPSCQueue<MIDICapture, MIDI_CAPTURE_SIZE> captured;
+  static volatile bool captureEnabled;
+  static void midiTask(void* parameter);
+  static void post(const MIDIMessage& msg);
+  static void enqueue(MIDIMessage::Type type, uint8_t data1 = 0, uint8_t data2 = 0, int16_t data16 = 0);
+  static uint8_t encodeMessage(const MIDIMessage& msg, uint8_t* out);
+  static uint16_t bleTimestamp(uint32_t eventUs);
+};
+
+#define MIDI_INPUT_QUEUE_SIZE 64  // Power of two (SPSC ring)
+
+typedef void (*MIDIRealtimeHandler)(uint8_t status);
+
+// Incoming BLE-MIDI
+// receive() runs in the BLE write callback and is the single producer of the
+// input ring; read() is drained by the Arduino loop. Realtime bytes (clock,
+// start, stop) go to the realtime handler straight away, in callback context,
+// so clock-period measurement is not delayed by the loop.
+class MIDIInput {
+public:
+  static void begin(MIDIRealtimeHandler handler);
+  static void receive(const uint8_t* data, size_t length);
+  static bool read(MIDIInputEvent& event);
+  static uint32_t droppedCount() { return inputQueue.dropCount(); }
+  static uint32_t errorCount() { return parser.errorCount(); }
+  
+private:
+  static BLEMIDIParser parser;
+  static SPSCQueue<MIDIInputEvent, MIDI_INPUT_QUEUE_SIZE> inputQueue;
+  static MIDIRealtimeHandler realtimeHandler;
+  static void onEvent(const MIDIInputEvent& event, void* context);
 };
 
 // App modes
@@ -187,8 +315,8 @@ extern TFT_eSPI tft;
 extern XPT2046_Touchscreen ts;
 extern BLECharacteristic *pCharacteristic;
 // BLE connection state now in GlobalState (globalState.bleConnected)
-extern uint8_t midiPacket[];
 extern TouchState touch;
+extern GestureRecognizer gestures;  // Fed by updateTouch()
 extern AppMode currentMode;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,117 @@
+#ifndef DIRTY_REGIONS_H
+#define DIRTY_REGIONS_H
+
+#include <stdint.h>
+
+// Screen rectangles waiting to be repainted
+// - add() clips to the screen and merges the rectangle with every pending
+//   one it overlaps, so no pixel is painted twice in a pass, and with any
+//   whose bounding box together is no bigger than the two (side by side)
+// - When all DIRTY_REGIONS_MAX slots are taken, the new rectangle joins the
+//   pending one whose bounding box grows least
+// - pop() hands them out oldest first
+//
+// Plain C++ (no Arduino), so the merging can be checked on the host.
+
+#define DIRTY_REGIONS_MAX 8
+
+struct DirtyRect {
+  int16_t x, y, w, h;
+
+  int32_t area() const { return (int32_t)w * h; }
+  bool isEmpty() const { return w <= 0 || h <= 0; }
+
+  bool intersects(const DirtyRect& o) const {
+    return x < o.x + o.w && o.x < x + w && y < o.y + o.h && o.y < y + h;
+  }
+
+  DirtyRect unionWith(const DirtyRect& o) const {
+    int16_t x0 = x < o.x ? x : o.x;
+    int16_t y0 = y < o.y ? y : o.y;
+    int16_t x1 = x + w > o.x + o.w ? x + w : o.x + o.w;
+    int16_t y1 = y + h > o.y + o.h ? y + h : o.y + o.h;
+    return {x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+  }
+};
+
+class DirtyRegions {
+public:
+  DirtyRegions(int16_t screenW, int16_t screenH) : screenW(screenW), screenH(screenH), count(0) {}
+
+  void add(int x, int y, int w, int h) {
+    // Clip to the screen
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > screenW) w = screenW - x;
+    if (y + h > screenH) h = screenH - y;
+    if (w <= 0 || h <= 0) return;
+
+    DirtyRect r = {(int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h};
+
+    // Absorb what it overlaps or lines up with; a merge can reach further ones
+    bool merged = true;
+    while (merged) {
+      merged = false;
+      for (uint8_t i = 0; i < count; i++) {
+        if (!r.intersects(rects[i]) && r.unionWith(rects[i]).area() > r.area() + rects[i].area()) continue;
+        r = r.unionWith(rects[i]);
+        remove(i);
+        merged = true;
+        break;
+      }
+    }
+
+    if (count == DIRTY_REGIONS_MAX) {
+      uint8_t best = 0;
+      int32_t bestGrowth = INT32_MAX;
+      for (uint8_t i = 0; i < count; i++) {
+        int32_t growth = rects[i].unionWith(r).area() - rects[i].area();
+        if (growth < bestGrowth) {
+          bestGrowth = growth;
+          best = i;
+        }
+      }
+      r = r.unionWith(rects[best]);
+      remove(best);
+      add(r.x, r.y, r.w, r.h);  // The bigger box may touch others now
+      return;
+    }
+    rects[count++] = r;
+  }
+
+  void addAll() {
+    count = 0;
+    add(0, 0, screenW, screenH);
+  }
+
+  bool pop(DirtyRect& out) {
+    if (count == 0) return false;
+    out = rects[0];
+    remove(0);
+    return true;
+  }
+
+  void clear() { count = 0; }
+  uint8_t size() const { return count; }
+  bool isEmpty() const { return count == 0; }
+  const DirtyRect& operator[](uint8_t i) const { return rects[i]; }
+
+  int32_t totalArea() const {
+    int32_t total = 0;
+    for (uint8_t i = 0; i < count; i++) total += rects[i].area();
+    return total;
+  }
+
+private:
+  int16_t screenW, screenH;
+  DirtyRect rects[DIRTY_REGIONS_MAX];
+  uint8_t count;
+
+  // Keeps the order, so pop() stays oldest first
+  void remove(uint8_t i) {
+    for (uint8_t j = i + 1; j < count; j++) rects[j - 1] = rects[j];
+    count--;
+  }
+};
+
+#endif // DIRTY_REGIONS_H
@@ -6,6 +6,8 @@
 #include "euclidean_mode.h"
 #include "common_definitions.h"
 #include "midi_utils.h"
+#include "generator_runtime.h"
+#include "step_grid.h"
 
 EuclideanState euclideanState;
 
@@ -32,71 +34,184 @@ void generateEuclideanPattern(EuclideanVoice& voice) {
   }
 }
 
-void initializeEuclideanMode() {
-  // Initialize 4 voices with classic patterns
-  // Voice 0 (Red): Kick - every 4th (4/16)
-  euclideanState.voices[0] = {16, 4, 0, 36, TFT_RED, {false}};  // C1 kick
-  
-  // Voice 1 (Yellow): Snare - backbeat (4/16 rotated)
-  euclideanState.voices[1] = {16, 4, 2, 38, TFT_YELLOW, {false}};  // D1 snare
-  
-  // Voice 2 (Green): Hi-hat - 8/16
-  euclideanState.voices[2] = {16, 8, 0, 42, TFT_GREEN, {false}};  // F#1 closed hat
+// Transport step (MIDI task): a 16th or a 16th triplet
+static void euclideanStep(const TransportTick& tick, void*) {
+  if (!GeneratorRuntime::isPlaying(ENGINE_EUCLIDEAN)) return;
   
-  // Voice 3 (Cyan): Percussion - 5/16 (interesting pattern)
-  euclideanState.voices[3] = {16, 5, 0, 39, TFT_CYAN, {false}};  // D#1 clap
+  if (euclideanState.resyncPending) {
+    euclideanState.resyncPending = false;
+    euclideanState.stepOrigin = tick.step;
+  }
   
-  // Generate all patterns
-  for (int i = 0; i < 4; i++) {
-    generateEuclideanPattern(euclideanState.voices[i]);
+  // Wrap at the longest voice
+  uint8_t maxSteps = 1;
+  for (int v = 0; v < 4; v++) {
+    if (euclideanState.voices[v].steps > maxSteps) {
+      maxSteps = euclideanState.voices[v].steps;
+    }
   }
+  euclideanState.currentStep = (tick.step - euclideanState.stepOrigin) % maxSteps;
   
-  euclideanState.bpm = 120;
-  euclideanState.currentStep = 0;
-  euclideanState.isPlaying = false;
-  euclideanState.lastStepTime = 0;
-  euclideanState.selectedVoice = 0;
-  euclideanState.tripletMode = false;
+  playEuclideanStep(tick.timeUs, tick.stepUs / 2);
+  euclideanState.needsRedraw = true;  // Step markers
+}
+
+static void euclideanTransport(TransportEvent event, void*) {
+  if (event == TRANSPORT_START) {
+    euclideanState.currentStep = 0;
+    euclideanState.stepOrigin = 0;
+    euclideanState.needsRedraw = true;
+  }
+}
+
+void initializeEuclideanMode() {
+  // Voices survive leaving the screen (they may still be playing)
+  if (!euclideanState.engineReady) {
+    // Initialize 4 voices with classic patterns
+    // Voice 0 (Red): Kick - every 4th (4/16)
+    euclideanState.voices[0] = {16, 4, 0, 36, TFT_RED, {false}};  // C1 kick
+    
+    // Voice 1 (Yellow): Snare - backbeat (4/16 rotated)
+    euclideanState.voices[1] = {16, 4, 2, 38, TFT_YELLOW, {false}};  // D1 snare
+    
+    // Voice 2 (Green): Hi-hat - 8/16
+    euclideanState.voices[2] = {16, 8, 0, 42, TFT_GREEN, {false}};  // F#1 closed hat
+    
+    // Voice 3 (Cyan): Percussion - 5/16 (interesting pattern)
+    euclideanState.voices[3] = {16, 5, 0, 39, TFT_CYAN, {false}};  // D#1 clap
+    
+    // Generate all patterns
+    for (int i = 0; i < 4; i++) {
+      generateEuclideanPattern(euclideanState.voices[i]);
+    }
+    
+    euclideanState.currentStep = 0;
+    euclideanState.resyncPending = true;
+    euclideanState.selectedVoice = 0;
+    euclideanState.tripletMode = false;
+    euclideanState.transportId = GeneratorRuntime::attach(ENGINE_EUCLIDEAN, euclideanStep,
+                                                          TRANSPORT_16TH, euclideanTransport);
+    euclideanState.engineReady = true;
+  }
+  euclideanState.needsRedraw = false;
   
   Serial.println("Euclidean mode initialized");
   drawEuclideanMode();
 }
 
+// Where the step markers of each voice sit, so redraws need no sin/cos;
+// recomputed when the voice's step count or the layout changes
+struct EuclideanRing {
+  int16_t centerX, centerY, radius;
+  uint8_t steps;  // 0 until computed
+  int16_t x[32], y[32];
+};
+
+static EuclideanRing rings[4];
+
+static const EuclideanRing& ringOf(int v) {
+  // Circular visualization - calculated from screen dimensions
+  int centerX = SCREEN_WIDTH / 3;
+  int centerY = (SCREEN_HEIGHT - CONTENT_TOP) / 2 + CONTENT_TOP;
+  int radius = min(SCREEN_WIDTH / 4, (SCREEN_HEIGHT - CONTENT_TOP) / 3);
+  int r = radius - (v * (radius / 5));
+  uint8_t steps = euclideanState.voices[v].steps;
+  
+  EuclideanRing& ring = rings[v];
+  if (ring.steps != steps || ring.radius != r || ring.centerX != centerX || ring.centerY != centerY) {
+    ring.centerX = centerX;
+    ring.centerY = centerY;
+    ring.radius = r;
+    ring.steps = steps;
+    for (int s = 0; s < steps; s++) {
+      float angle = (s * (float)TWO_PI / steps) - (float)HALF_PI;
+      ring.x[s] = centerX + cosf(angle) * r;
+      ring.y[s] = centerY + sinf(angle) * r;
+    }
+  }
+  return ring;
+}
+
+// What each marker shows, as last painted
+#define RING_CELL_EVENT 1
+#define RING_CELL_PLAYHEAD 2
+#define RING_MARKER_R 6  // The playhead ring; event markers are 4
+
+static int ringPlayhead = -1;  // Step being highlighted, -1 when stopped
+
+static uint8_t ringCellState(int v, int s) {
+  uint8_t state = euclideanState.voices[v].pattern[s] ? RING_CELL_EVENT : 0;
+  if (s == ringPlayhead) state |= RING_CELL_PLAYHEAD;
+  return state;
+}
+
+static void drawEuclideanMarker(int v, int s) {
+  const EuclideanRing& ring = rings[v];
+  uint16_t color = euclideanState.voices[v].color;
+  if (euclideanState.voices[v].pattern[s]) {
+    // Event marker - filled circle
+    tft.fillCircle(ring.x[s], ring.y[s], 4, color);
+  } else {
+    // Non-event - small dot
+    tft.drawPixel(ring.x[s], ring.y[s], color);
+  }
+  
+  // Highlight current step
+  if (s == ringPlayhead) {
+    tft.drawCircle(ring.x[s], ring.y[s], RING_MARKER_R, TFT_WHITE);
+  }
+}
+
+// Repaints the box around one marker: clipped to it, everything that
+// reaches into it is drawn again (rings and nearby markers of any voice)
+static void paintEuclideanCell(uint8_t voice, uint8_t step, uint8_t) {
+  int cx = rings[voice].x[step];
+  int cy = rings[voice].y[step];
+  int reach = 2 * RING_MARKER_R + 1;
+  tft.setViewport(cx - RING_MARKER_R, cy - RING_MARKER_R, 2 * RING_MARKER_R + 1, 2 * RING_MARKER_R + 1, false);
+  tft.fillRect(cx - RING_MARKER_R, cy - RING_MARKER_R, 2 * RING_MARKER_R + 1, 2 * RING_MARKER_R + 1, THEME_BG);
+  for (int v = 3; v >= 0; v--) {
+    const EuclideanRing& ring = rings[v];
+    int dx = cx - ring.centerX, dy = cy - ring.centerY;
+    int d2 = dx * dx + dy * dy;
+    int inner = max(0, ring.radius - reach), outer = ring.radius + reach;
+    if (d2 < inner * inner || d2 > outer * outer) continue;  // Ring passes elsewhere
+    tft.drawCircle(ring.centerX, ring.centerY, ring.radius, euclideanState.voices[v].color);
+    for (int s = 0; s < ring.steps; s++) {
+      if (abs(ring.x[s] - cx) <= reach && abs(ring.y[s] - cy) <= reach) drawEuclideanMarker(v, s);
+    }
+  }
+  tft.resetViewport();
+}
+
+static StepGrid<4, 32> ringGrid(paintEuclideanCell);
+
+// Playhead-only update: the markers it left and reached, per voice
+static void updateEuclideanRings() {
+  ringPlayhead = GeneratorRuntime::isPlaying(ENGINE_EUCLIDEAN) ? euclideanState.currentStep : -1;
+  for (int v = 0; v < 4; v++) {
+    const EuclideanRing& ring = ringOf(v);
+    for (int s = 0; s < ring.steps; s++) ringGrid.set(v, s, ringCellState(v, s));
+  }
+}
+
 void drawEuclideanMode() {
   tft.fillScreen(THEME_BG);
   
   // Unified header with BLE, SD, and BPM indicators
   drawModuleHeader("EUCLIDEAN");
   
-  // Draw circular visualization - calculated from screen dimensions
-  int centerX = SCREEN_WIDTH / 3;
-  int centerY = (SCREEN_HEIGHT - CONTENT_TOP) / 2 + CONTENT_TOP;
-  int radius = min(SCREEN_WIDTH / 4, (SCREEN_HEIGHT - CONTENT_TOP) / 3);
-  
   // Draw concentric circles for each voice
-  int radiusStep = radius / 5;
+  ringGrid.invalidate();
+  ringPlayhead = GeneratorRuntime::isPlaying(ENGINE_EUCLIDEAN) ? euclideanState.currentStep : -1;
   for (int v = 3; v >= 0; v--) {
-    int r = radius - (v * radiusStep);
-    tft.drawCircle(centerX, centerY, r, euclideanState.voices[v].color);
+    const EuclideanRing& ring = ringOf(v);
+    tft.drawCircle(ring.centerX, ring.centerY, ring.radius, euclideanState.voices[v].color);
     
     // Draw step markers
-    for (int s = 0; s < euclideanState.voices[v].steps; s++) {
-      float angle = (s * TWO_PI / euclideanState.voices[v].steps) - HALF_PI;
-      int x = centerX + cos(angle) * r;
-      int y = centerY + sin(angle) * r;
-      
-      if (euclideanState.voices[v].pattern[s]) {
-        // Event marker - filled circle
-        tft.fillCircle(x, y, 4, euclideanState.voices[v].color);
-      } else {
-        // Non-event - small dot
-        tft.drawPixel(x, y, euclideanState.voices[v].color);
-      }
-      
-      // Highlight current step
-      if (euclideanState.isPlaying && s == euclideanState.currentStep) {
-        tft.drawCircle(x, y, 6, TFT_WHITE);
-      }
+    for (int s = 0; s < ring.steps; s++) {
+      drawEuclideanMarker(v, s);
+      ringGrid.assume(v, s, ringCellState(v, s));
     }
   }
   
@@ -147,11 +262,11 @@ void drawEuclideanMode() {
   int bottomY = 280;
   
   // Play/Stop button
-  tft.fillRoundRect(10, bottomY, 70, 35, 5, euclideanState.isPlaying ? TFT_RED : TFT_GREEN);
-  tft.setTextColor(THEME_BG, euclideanState.isPlaying ? TFT_RED : TFT_GREEN);
+  tft.fillRoundRect(10, bottomY, 70, 35, 5, GeneratorRuntime::isPlaying(ENGINE_EUCLIDEAN) ? TFT_RED : TFT_GREEN);
+  tft.setTextColor(THEME_BG, GeneratorRuntime::isPlaying(ENGINE_EUCLIDEAN) ? TFT_RED : TFT_GREEN);
   tft.setTextSize(2);
-  tft.setCursor(euclideanState.isPlaying ? 22 : 18, bottomY + 10);
-  tft.print(euclideanState.isPlaying ? "STOP" : "PLAY");
+  tft.setCursor(GeneratorRuntime::isPlaying(ENGINE_EUCLIDEAN) ? 22 : 18, bottomY + 10);
+  tft.print(GeneratorRuntime::isPlaying(ENGINE_EUCLIDEAN) ? "STOP" : "PLAY");
   
   // BPM control
   tft.setTextColor(THEME_TEXT, THEME_BG);
@@ -162,7 +277,7 @@ void drawEuclideanMode() {
   tft.setTextColor(THEME_BG, THEME_ACCENT);
   tft.setTextSize(2);
   tft.setCursor(100, bottomY + 16);
-  tft.print(euclideanState.bpm);
+  tft.print((int)globalState.bpm);
   
   // Triplet mode toggle
   tft.fillRoundRect(160, bottomY, 80, 35, 5, euclideanState.tripletMode ? THEME_ACCENT : 0x4208);
@@ -183,54 +298,23 @@ void drawEuclideanMode() {
   tft.print("Re-Sync");
 }
 
-void playEuclideanStep() {
-  // Play all voices that have events at current step
+void playEuclideanStep(uint32_t stepTimeUs, uint32_t gateUs) {
+  // Schedule all voices that have events at current step
   for (int v = 0; v < 4; v++) {
     if (euclideanState.currentStep < euclideanState.voices[v].steps &&
         euclideanState.voices[v].pattern[euclideanState.currentStep]) {
-      sendNoteOn(euclideanState.voices[v].midiNote, 100);
-      sendNoteOff(euclideanState.voices[v].midiNote);
+      scheduleNote(euclideanState.voices[v].midiNote, 100, stepTimeUs, gateUs);
     }
   }
 }
 
-void updateEuclideanSequencer() {
-  if (!euclideanState.isPlaying) return;
-  
-  // Calculate step duration based on BPM and triplet mode
-  unsigned long stepDuration;
-  if (euclideanState.tripletMode) {
-    // Triplet 16th notes (24 per quarter note)
-    stepDuration = (60000 / euclideanState.bpm) / 6; // 6 triplets per quarter
-  } else {
-    // Regular 16th notes
-    stepDuration = (60000 / euclideanState.bpm) / 4; // 4 sixteenths per quarter
+void handleEuclideanMode() {
+  // Steps are played by the transport; redraw what it changed
+  if (euclideanState.needsRedraw) {
+    euclideanState.needsRedraw = false;
+    updateEuclideanRings();
   }
   
-  unsigned long currentTime = millis();
-  if (currentTime - euclideanState.lastStepTime >= stepDuration) {
-    euclideanState.lastStepTime = currentTime;
-    
-    playEuclideanStep();
-    
-    // Advance to next step (use max steps from all voices)
-    euclideanState.currentStep++;
-    uint8_t maxSteps = 0;
-    for (int v = 0; v < 4; v++) {
-      if (euclideanState.voices[v].steps > maxSteps) {
-        maxSteps = euclideanState.voices[v].steps;
-      }
-    }
-    if (euclideanState.currentStep >= maxSteps) {
-      euclideanState.currentStep = 0;
-    }
-    
-    // Update display (just the step markers)
-    drawEuclideanMode();
-  }
-}
-
-void handleEuclideanMode() {
   // Check for touch input
   if (touch.justPressed) {
     int touchX = touch.x;
@@ -238,31 +322,32 @@ void handleEuclideanMode() {
     
     // Play/Stop button
     if (touchX >= 10 && touchX <= 80 && touchY >= 280 && touchY <= 315) {
-      euclideanState.isPlaying = !euclideanState.isPlaying;
-      if (euclideanState.isPlaying) {
-        euclideanState.currentStep = 0;
-        euclideanState.lastStepTime = millis();
-      }
+      bool playing = !GeneratorRuntime::isPlaying(ENGINE_EUCLIDEAN);
+      euclideanState.resyncPending = playing;  // Pattern starts from its step 0
+      GeneratorRuntime::setPlaying(ENGINE_EUCLIDEAN, playing);
       drawEuclideanMode();
     }
     
     // BPM control
     else if (touchX >= 90 && touchX <= 150 && touchY >= 280 && touchY <= 315) {
-      euclideanState.bpm += 5;
-      if (euclideanState.bpm > 240) euclideanState.bpm = 40;
+      float newBpm = globalState.bpm + 5;
+      if (newBpm > 240) newBpm = 40;
+      setBPM(newBpm);
       drawEuclideanMode();
     }
     
     // Triplet mode toggle
     else if (touchX >= 160 && touchX <= 240 && touchY >= 280 && touchY <= 315) {
       euclideanState.tripletMode = !euclideanState.tripletMode;
+      Transport::setDivision(euclideanState.transportId,
+                             euclideanState.tripletMode ? TRANSPORT_16TH_TRIPLET : TRANSPORT_16TH);
+      euclideanState.resyncPending = true;  // Step count restarts in the new division
       drawEuclideanMode();
     }
     
-    // Re-Sync button
+    // Re-Sync button - the next step becomes step 0
     else if (touchX >= 250 && touchX <= 320 && touchY >= 280 && touchY <= 315) {
-      euclideanState.currentStep = 0;
-      euclideanState.lastStepTime = millis();
+      euclideanState.resyncPending = true;
       drawEuclideanMode();
     }
     
@@ -309,11 +394,8 @@ void handleEuclideanMode() {
     
     // Back button
     if (isButtonPressed(BACK_BTN_X, BACK_BTN_Y, BTN_BACK_W, BTN_BACK_H)) {
-      currentMode = MENU;
+      exitToMenu();
       return;
     }
   }
-  
-  // Update sequencer if playing
-  updateEuclideanSequencer();
 }
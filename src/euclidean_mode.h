@@ -18,10 +18,12 @@ struct EuclideanVoice {
 
 struct EuclideanState {
   EuclideanVoice voices[4];  // 4 independent rhythm voices
-  uint8_t bpm;               // Tempo (40-240 BPM)
-  uint8_t currentStep;       // Current playback position (0-31)
-  bool isPlaying;            // Playback state
-  unsigned long lastStepTime; // For timing
+  volatile uint8_t currentStep;  // Current playback position (0-31)
+  uint32_t stepOrigin;       // Transport step that counts as step 0 (Re-Sync)
+  volatile bool resyncPending;
+  volatile bool needsRedraw; // Set by the transport, cleared by the redraw
+  int8_t transportId;        // Transport subscription
+  bool engineReady;          // Set up once, then keeps running in the background
   uint8_t selectedVoice;     // Currently selected voice for editing (0-3)
   bool tripletMode;          // false = 16th notes, true = triplet divisions
 };
@@ -36,8 +38,7 @@ void handleEuclideanMode();
 // Pattern generation using Bjorklund's algorithm
 void generateEuclideanPattern(EuclideanVoice& voice);
 
-// Playback
-void updateEuclideanSequencer();
-void playEuclideanStep();
+// Playback (transport step handler, runs on the MIDI task)
+void playEuclideanStep(uint32_t stepTimeUs, uint32_t gateUs);
 
 #endif // EUCLIDEAN_MODE_H
@@ -0,0 +1,172 @@
+#include "generator_bench.h"
+#include "generator_runtime.h"
+#include "euclidean_mode.h"
+#include "grids_mode.h"
+#include "tb3po_mode.h"
+#include "morph_mode.h"
+
+GeneratorBenchResult GeneratorBench::results[GENERATOR_BENCH_MAX];
+uint8_t GeneratorBench::resultCount = 0;
+
+// Generator state put back after the run
+struct BenchSavedState {
+  EuclideanState euclidean;
+  GridsState grids;
+  TB3POState tb3po;
+  MorphState morph;
+};
+
+static EuclideanVoice benchVoice;
+
+static void benchEuclidean(uint32_t i) {
+  benchVoice.steps = 32;  // Longest pattern
+  benchVoice.events = 1 + i % 32;
+  benchVoice.rotation = i % 7;
+  generateEuclideanPattern(benchVoice);
+}
+
+static void benchGrids(uint32_t i) {
+  grids.patternX = i * 37;
+  grids.patternY = i * 91;
+  regenerateGridsPattern();
+}
+
+static void benchTB3PO(uint32_t i) {
+  tb3po.seed = 1 + i;
+  tb3po.density = i % 15;
+  regenerateTB3POPattern();
+}
+
+static void benchMorph(uint32_t i) {
+  morphState.morphX = (i % 11) / 10.0f;
+  morphState.morphY = (i % 7) / 6.0f;
+  morphGestures();
+}
+
+static void benchDrawEuclidean(uint32_t) { drawEuclideanMode(); }
+static void benchDrawGrids(uint32_t) { drawGridsMode(); }
+static void benchDrawTB3PO(uint32_t) { drawTB3POMode(); }
+static void benchUpdateTB3POSteps(uint32_t i) {
+  tb3po.step = i % tb3po.numSteps;
+  updateTB3POSteps();
+}
+static void benchDrawMorph(uint32_t) { drawMorphMode(); }
+
+// Four full-length recordings, so every morph step blends four curves
+static void fillMorphMemories() {
+  for (int slot = 0; slot < NUM_MEMORY_SLOTS; slot++) {
+    Gesture& gesture = morphState.memories[slot];
+    gesture.numPoints = MAX_GESTURE_POINTS;
+    gesture.isValid = true;
+    gesture.duration = 2000;
+    for (int p = 0; p < MAX_GESTURE_POINTS; p++) {
+      float t = (float)p / (MAX_GESTURE_POINTS - 1);
+      gesture.points[p].x = t;
+      gesture.points[p].y = 0.5f + 0.4f * sinf(t * (slot + 1) * TWO_PI);
+      gesture.points[p].time = (unsigned long)(t * gesture.duration);
+      gesture.points[p].velocity = 0.5f;
+      gesture.points[p].pressure = 0.5f;
+    }
+  }
+}
+
+const char* GeneratorBench::unit() {
+#ifdef NATIVE_BUILD
+  return "ns";
+#else
+  return "cycles";
+#endif
+}
+
+void GeneratorBench::measure(const char* name, Routine routine) {
+  if (resultCount >= GENERATOR_BENCH_MAX) return;
+
+#ifdef NATIVE_BUILD
+  const uint32_t unitsPerUs = 1000;
+#else
+  const uint32_t unitsPerUs = ESP.getCpuFreqMHz();
+#endif
+
+  // Double the run until it is long enough to time
+  uint32_t iterations = 1;
+  uint32_t elapsed = 0;
+  while (true) {
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < iterations; i++) routine(i);
+    elapsed = ESP.getCycleCount() - start;
+    if (elapsed >= GENERATOR_BENCH_TARGET_US * unitsPerUs || iterations >= (1u << 20)) break;
+    iterations *= 2;
+    yield();
+  }
+
+  GeneratorBenchResult& r = results[resultCount++];
+  r.name = name;
+  r.iterations = iterations;
+  r.perOp = elapsed / iterations;
+  r.usPerOp = (float)elapsed / iterations / unitsPerUs;
+}
+
+bool GeneratorBench::run(bool includeDrawing) {
+  if (GeneratorRuntime::anyPlaying()) {
+    Serial.println("[Bench] Stop playback first");
+    return false;
+  }
+
+  BenchSavedState* saved = (BenchSavedState*)malloc(sizeof(BenchSavedState));
+  if (!saved) {
+    Serial.println("[Bench] Not enough memory");
+    return false;
+  }
+  memcpy((void*)&saved->euclidean, (const void*)&euclideanState, sizeof(euclideanState));
+  memcpy((void*)&saved->grids, (const void*)&grids, sizeof(grids));
+  memcpy((void*)&saved->tb3po, (const void*)&tb3po, sizeof(tb3po));
+  memcpy((void*)&saved->morph, (const void*)&morphState, sizeof(morphState));
+
+  resultCount = 0;
+  benchVoice = {32, 5, 0, 36, 0, {false}};
+  fillMorphMemories();
+
+  measure("generateEuclideanPattern", benchEuclidean);
+  measure("regenerateGridsPattern", benchGrids);
+  measure("regenerateTB3POPattern", benchTB3PO);
+  measure("morphGestures", benchMorph);
+  if (includeDrawing) {
+    measure("drawEuclideanMode", benchDrawEuclidean);
+    measure("drawGridsMode", benchDrawGrids);
+    measure("drawTB3POMode", benchDrawTB3PO);
+    measure("updateTB3POSteps", benchUpdateTB3POSteps);
+    measure("drawMorphMode", benchDrawMorph);
+  }
+
+  memcpy((void*)&euclideanState, (const void*)&saved->euclidean, sizeof(euclideanState));
+  memcpy((void*)&grids, (const void*)&saved->grids, sizeof(grids));
+  memcpy((void*)&tb3po, (const void*)&saved->tb3po, sizeof(tb3po));
+  memcpy((void*)&morphState, (const void*)&saved->morph, sizeof(morphState));
+  free(saved);
+
+  printTable();
+  return true;
+}
+
+void GeneratorBench::printTable() {
+  Serial.printf("[Bench] %-26s %8s %12s %10s\n", "routine", "runs", unit(), "us");
+  for (uint8_t i = 0; i < resultCount; i++) {
+    const GeneratorBenchResult& r = results[i];
+    Serial.printf("[Bench] %-26s %8lu %12lu %10.2f\n", r.name, (unsigned long)r.iterations,
+                  (unsigned long)r.perOp, r.usPerOp);
+  }
+}
+
+String GeneratorBench::toJSON() {
+  String json = "{\"unit\":\"" + String(unit()) + "\",\"results\":[";
+  for (uint8_t i = 0; i < resultCount; i++) {
+    const GeneratorBenchResult& r = results[i];
+    if (i > 0) json += ",";
+    json += "{\"name\":\"" + String(r.name) + "\",";
+    json += "\"iterations\":" + String(r.iterations) + ",";
+    json += "\"perOp\":" + String(r.perOp) + ",";
+    json += "\"us\":" + String(r.usPerOp, 2) + "}";
+  }
+  json += "]}";
+  return json;
+}
@@ -0,0 +1,49 @@
+#ifndef GENERATOR_BENCH_H
+#define GENERATOR_BENCH_H
+
+#include <Arduino.h>
+
+// Micro-benchmarks of the pattern generators and screen drawing
+// - Each routine runs in a loop that doubles until it has taken
+//   GENERATOR_BENCH_TARGET_US, so fast and slow routines both get a
+//   stable figure
+// - Costs come from ESP.getCycleCount(): CPU cycles per call on the device,
+//   nanoseconds per call in the native build (where the stub counts those)
+// - The generators work on their real state, which is saved first and put
+//   back afterwards; nothing may be playing while it runs
+// - The drawing routines draw over the screen, so the caller redraws it
+// run() prints a table over serial; toJSON() is what /bench serves.
+// Loop task only.
+
+#define GENERATOR_BENCH_MAX 16
+#define GENERATOR_BENCH_TARGET_US 20000
+
+struct GeneratorBenchResult {
+  const char* name;
+  uint32_t iterations;
+  uint32_t perOp;   // Cycles (device) or ns (native) per call
+  float usPerOp;
+};
+
+class GeneratorBench {
+public:
+  // false if an engine is playing (its state would change under it)
+  static bool run(bool includeDrawing = true);
+
+  static uint8_t count() { return resultCount; }
+  static const GeneratorBenchResult& result(uint8_t i) { return results[i]; }
+  static const char* unit();  // "cycles" or "ns"
+
+  static void printTable();
+  static String toJSON();
+
+private:
+  typedef void (*Routine)(uint32_t iteration);
+
+  static GeneratorBenchResult results[GENERATOR_BENCH_MAX];
+  static uint8_t resultCount;
+
+  static void measure(const char* name, Routine routine);
+};
+
+#endif // GENERATOR_BENCH_H
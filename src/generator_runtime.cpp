@@ -0,0 +1,55 @@
+#include "generator_runtime.h"
+#include "midi_utils.h"
+
+volatile uint8_t GeneratorRuntime::playingMask = 0;
+int8_t GeneratorRuntime::subscriptions[ENGINE_COUNT] = {-1, -1, -1, -1, -1, -1};
+
+int8_t GeneratorRuntime::attach(GeneratorEngine engine, TransportStepHandler onStep,
+                                uint16_t ticksPerStep, TransportEventHandler onEvent) {
+  subscriptions[engine] = Transport::subscribe(onStep, ticksPerStep, nullptr, onEvent);
+  return subscriptions[engine];
+}
+
+void GeneratorRuntime::setPlaying(GeneratorEngine engine, bool playing) {
+  uint8_t previous = playingMask;
+  if (playing) playingMask = previous | (1 << engine);
+  else playingMask = previous & ~(1 << engine);
+  apply(previous);
+}
+
+uint8_t GeneratorRuntime::playingCount() {
+  uint8_t count = 0;
+  for (uint8_t mask = playingMask; mask; mask &= mask - 1) count++;
+  return count;
+}
+
+void GeneratorRuntime::stopForeground() {
+  uint8_t previous = playingMask;
+  for (int e = ENGINE_FIRST_FOREGROUND; e < ENGINE_COUNT; e++) {
+    Transport::unsubscribe(subscriptions[e]);
+    subscriptions[e] = -1;
+  }
+  playingMask = previous & ((1 << ENGINE_FIRST_FOREGROUND) - 1);
+  apply(previous);
+}
+
+void GeneratorRuntime::stopAll() {
+  uint8_t previous = playingMask;
+  playingMask = 0;
+  apply(previous);
+  
+  // Drop what the engines already scheduled and release anything sounding
+  MIDIThread::cancelScheduled();
+  MIDIThread::panic();
+}
+
+// First engine in starts the transport, last one out stops it. Only the
+// background engines send START and clock: the arp and RNG on their own run
+// it silently, and a background engine joining them restarts it out loud.
+void GeneratorRuntime::apply(uint8_t previousMask) {
+  const uint8_t background = (1 << ENGINE_FIRST_FOREGROUND) - 1;
+  bool sendClock = playingMask & background;
+  if (!previousMask && playingMask) startTransport(sendClock);
+  else if (previousMask && !playingMask) stopTransport();
+  else if (sendClock && !(previousMask & background)) startTransport(true);
+}
@@ -0,0 +1,50 @@
+#ifndef GENERATOR_RUNTIME_H
+#define GENERATOR_RUNTIME_H
+
+#include <stdint.h>
+#include "transport.h"
+
+// Which generators are playing, and so whether the transport runs
+// - BEATS, GRIDS, TB3PO and EUCLID are background engines: their step
+//   handlers stay subscribed after their screen closes, so several can play
+//   together while any other screen (or the menu) is shown
+// - ARP and RNG are foreground only and stop when their screen closes
+// - The transport starts with the first playing engine and stops after the
+//   last one (unless an external clock owns it). ARP and RNG alone run it
+//   without sending START, clock or STOP - they never drove the receiver.
+// Called from the loop task; isPlaying() is also safe from step handlers.
+
+enum GeneratorEngine {
+  ENGINE_BEATS,
+  ENGINE_GRIDS,
+  ENGINE_TB3PO,
+  ENGINE_EUCLIDEAN,
+  ENGINE_ARP,        // Foreground only from here on
+  ENGINE_RNG,
+  ENGINE_COUNT
+};
+
+#define ENGINE_FIRST_FOREGROUND ENGINE_ARP
+
+class GeneratorRuntime {
+public:
+  // Subscribe an engine's step handler to the transport (once per engine;
+  // calling again just updates the subscription). Returns the Transport id.
+  static int8_t attach(GeneratorEngine engine, TransportStepHandler onStep, uint16_t ticksPerStep,
+                       TransportEventHandler onEvent = nullptr);
+  
+  static void setPlaying(GeneratorEngine engine, bool playing);
+  static bool isPlaying(GeneratorEngine engine) { return playingMask & (1 << engine); }
+  static bool anyPlaying() { return playingMask != 0; }
+  static uint8_t playingCount();
+  
+  static void stopForeground();  // Leaving a screen
+  static void stopAll();         // Everything, including background engines
+  
+private:
+  static volatile uint8_t playingMask;
+  static int8_t subscriptions[ENGINE_COUNT];
+  static void apply(uint8_t previousMask);
+};
+
+#endif // GENERATOR_RUNTIME_H
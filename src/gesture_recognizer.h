@@ -0,0 +1,262 @@
+#ifndef GESTURE_RECOGNIZER_H
+#define GESTURE_RECOGNIZER_H
+
+#include <stdint.h>
+
+// Tap, double-tap, long-press, drag and swipe from the touch event stream
+// - press()/move()/release() take the touch task's events as updateTouch()
+//   drains them; update() runs once per loop() pass so a long press fires
+//   while the finger is still down
+// - Never waits: everything is decided from the event timestamps, so a
+//   screen using it keeps loop() (web server, MIDI input) running
+// - A tap is reported on release straight away. A second tap close in time
+//   and place is reported as a tap and then GESTURE_DOUBLE_TAP, so single
+//   taps never wait for a possible second one.
+// - Moving further than slopPx makes the touch a drag: DRAG_START, a DRAG
+//   per move with the delta, DRAG_END on release. A drag still moving fast
+//   on release is also a SWIPE.
+// The callback runs after the recognizer's own state is updated, so it may
+// redraw, switch screens or feed the recognizer again.
+//
+// Plain C++ (no Arduino) so it can be checked on the host.
+
+#define GESTURE_HISTORY 8   // Recent positions kept for the swipe velocity
+
+enum GestureType : uint8_t {
+  GESTURE_TAP,
+  GESTURE_DOUBLE_TAP,
+  GESTURE_LONG_PRESS,
+  GESTURE_DRAG_START,
+  GESTURE_DRAG,
+  GESTURE_DRAG_END,
+  GESTURE_SWIPE
+};
+
+enum SwipeDirection : uint8_t {
+  SWIPE_NONE,
+  SWIPE_LEFT,
+  SWIPE_RIGHT,
+  SWIPE_UP,
+  SWIPE_DOWN
+};
+
+struct TouchGesture {
+  GestureType type;
+  int16_t x, y;              // Current position (release position for taps)
+  int16_t startX, startY;    // Where the finger went down
+  int16_t dx, dy;            // DRAG: since the last DRAG; DRAG_END/SWIPE: since the press
+  SwipeDirection direction;  // SWIPE only
+  int32_t velocity;          // SWIPE: px/s along the direction
+  uint32_t durationMs;       // Since the press
+};
+
+struct GestureConfig {
+  uint16_t slopPx = 12;             // Movement still counted as holding still
+  uint16_t longPressMs = 600;
+  uint16_t doubleTapMs = 300;       // Release to release
+  uint16_t doubleTapPx = 30;
+  uint16_t swipeMinPx = 40;         // Along the main axis, press to release
+  uint16_t swipeMinVelocity = 400;  // px/s over the last swipeWindowMs
+  uint16_t swipeWindowMs = 80;
+};
+
+typedef void (*GestureCallback)(const TouchGesture& gesture);
+
+class GestureRecognizer {
+public:
+  GestureRecognizer() : callback(nullptr) { reset(); }
+
+  void configure(const GestureConfig& c) { config = c; }
+  const GestureConfig& getConfig() const { return config; }
+
+  // nullptr: recognise, but report nothing
+  void setCallback(GestureCallback cb) { callback = cb; }
+
+  void reset() {
+    down = false;
+    dragging = false;
+    longPressed = false;
+    tapPending = false;
+    historyCount = 0;
+    historyHead = 0;
+  }
+
+  void press(int16_t x, int16_t y, uint32_t timeUs) {
+    down = true;
+    dragging = false;
+    longPressed = false;
+    startX = lastX = x;
+    startY = lastY = y;
+    pressUs = timeUs;
+    historyCount = 0;
+    historyHead = 0;
+    remember(x, y, timeUs);
+  }
+
+  void move(int16_t x, int16_t y, uint32_t timeUs) {
+    if (!down) return;
+    Batch out;
+    checkLongPress(timeUs, out);
+
+    remember(x, y, timeUs);
+    if (!dragging && distance(x - startX, y - startY) > config.slopPx) {
+      dragging = true;
+      out.add(make(GESTURE_DRAG_START, x, y, timeUs));
+    }
+    if (dragging && (x != lastX || y != lastY)) {
+      TouchGesture& g = out.add(make(GESTURE_DRAG, x, y, timeUs));
+      g.dx = x - lastX;
+      g.dy = y - lastY;
+      lastX = x;
+      lastY = y;
+    }
+    emit(out);
+  }
+
+  void release(int16_t x, int16_t y, uint32_t timeUs) {
+    if (!down) return;
+    Batch out;
+    checkLongPress(timeUs, out);
+    down = false;
+
+    if (dragging) {
+      remember(x, y, timeUs);
+      TouchGesture& end = out.add(make(GESTURE_DRAG_END, x, y, timeUs));
+      end.dx = x - startX;
+      end.dy = y - startY;
+      TouchGesture swipe = make(GESTURE_SWIPE, x, y, timeUs);
+      if (detectSwipe(swipe, timeUs)) out.add(swipe);
+      tapPending = false;
+    } else if (!longPressed) {
+      out.add(make(GESTURE_TAP, x, y, timeUs));
+      if (tapPending && timeUs - lastTapUs <= (uint32_t)config.doubleTapMs * 1000 &&
+          distance(x - lastTapX, y - lastTapY) <= config.doubleTapPx) {
+        out.add(make(GESTURE_DOUBLE_TAP, x, y, timeUs));
+        tapPending = false;  // A third tap starts a new pair
+      } else {
+        tapPending = true;
+        lastTapUs = timeUs;
+        lastTapX = x;
+        lastTapY = y;
+      }
+    } else {
+      tapPending = false;
+    }
+    emit(out);
+  }
+
+  // Once per loop() pass: fires the long press of a finger held still
+  void update(uint32_t nowUs) {
+    if (!down) return;
+    Batch out;
+    checkLongPress(nowUs, out);
+    emit(out);
+  }
+
+  bool isDown() const { return down; }
+  bool isDragging() const { return down && dragging; }
+  uint32_t heldMs(uint32_t nowUs) const { return down ? (nowUs - pressUs) / 1000 : 0; }
+
+private:
+  // Gestures found by one call, reported once the state is consistent
+  struct Batch {
+    TouchGesture items[3];
+    uint8_t count = 0;
+    TouchGesture& add(const TouchGesture& g) {
+      if (count < 3) items[count++] = g;
+      return items[count - 1];
+    }
+  };
+
+  GestureConfig config;
+  GestureCallback callback;
+  bool down;
+  bool dragging;
+  bool longPressed;
+  int16_t startX, startY;
+  int16_t lastX, lastY;      // Position of the last DRAG
+  uint32_t pressUs;
+  bool tapPending;           // A tap that a second one may turn into a double tap
+  uint32_t lastTapUs;
+  int16_t lastTapX, lastTapY;
+  int16_t historyX[GESTURE_HISTORY], historyY[GESTURE_HISTORY];
+  uint32_t historyUs[GESTURE_HISTORY];
+  uint8_t historyCount;
+  uint8_t historyHead;
+
+  static int32_t distance(int32_t dx, int32_t dy) {
+    // Chebyshev distance: close enough for slop radii, no square root
+    if (dx < 0) dx = -dx;
+    if (dy < 0) dy = -dy;
+    return dx > dy ? dx : dy;
+  }
+
+  TouchGesture make(GestureType type, int16_t x, int16_t y, uint32_t timeUs) const {
+    TouchGesture g;
+    g.type = type;
+    g.x = x;
+    g.y = y;
+    g.startX = startX;
+    g.startY = startY;
+    g.dx = 0;
+    g.dy = 0;
+    g.direction = SWIPE_NONE;
+    g.velocity = 0;
+    g.durationMs = (timeUs - pressUs) / 1000;
+    return g;
+  }
+
+  void checkLongPress(uint32_t timeUs, Batch& out) {
+    if (dragging || longPressed) return;
+    if (timeUs - pressUs < (uint32_t)config.longPressMs * 1000) return;
+    longPressed = true;
+    tapPending = false;
+    out.add(make(GESTURE_LONG_PRESS, lastX, lastY, timeUs));
+  }
+
+  void remember(int16_t x, int16_t y, uint32_t timeUs) {
+    historyX[historyHead] = x;
+    historyY[historyHead] = y;
+    historyUs[historyHead] = timeUs;
+    historyHead = (historyHead + 1) % GESTURE_HISTORY;
+    if (historyCount < GESTURE_HISTORY) historyCount++;
+  }
+
+  // Direction from the whole movement, speed from the last swipeWindowMs
+  bool detectSwipe(TouchGesture& g, uint32_t timeUs) {
+    int32_t totalX = g.x - startX;
+    int32_t totalY = g.y - startY;
+    bool horizontal = (totalX < 0 ? -totalX : totalX) >= (totalY < 0 ? -totalY : totalY);
+    int32_t along = horizontal ? totalX : totalY;
+    if ((along < 0 ? -along : along) < config.swipeMinPx) return false;
+
+    // Oldest remembered position still inside the window
+    int oldest = (historyHead + GESTURE_HISTORY - 1) % GESTURE_HISTORY;
+    for (int i = 1; i < historyCount; i++) {
+      int index = (historyHead + GESTURE_HISTORY - 1 - i) % GESTURE_HISTORY;
+      if (timeUs - historyUs[index] > (uint32_t)config.swipeWindowMs * 1000) break;
+      oldest = index;
+    }
+    uint32_t dtUs = timeUs - historyUs[oldest];
+    if (dtUs == 0) return false;
+    int32_t moved = horizontal ? g.x - historyX[oldest] : g.y - historyY[oldest];
+    if ((moved < 0) != (along < 0)) return false;
+    int32_t velocity = (int32_t)((int64_t)(moved < 0 ? -moved : moved) * 1000000 / dtUs);
+    if (velocity < config.swipeMinVelocity) return false;
+
+    g.dx = totalX;
+    g.dy = totalY;
+    g.velocity = velocity;
+    g.direction = horizontal ? (totalX < 0 ? SWIPE_LEFT : SWIPE_RIGHT)
+                             : (totalY < 0 ? SWIPE_UP : SWIPE_DOWN);
+    return true;
+  }
+
+  void emit(const Batch& out) {
+    // The callback may replace itself (a screen change), so look it up each time
+    Batch copy = out;
+    for (uint8_t i = 0; i < copy.count && callback; i++) callback(copy.items[i]);
+  }
+};
+
+#endif // GESTURE_RECOGNIZER_H
@@ -100,7 +100,8 @@ void drawGridCell(int row, int col, bool pressed) {
   uint16_t bgColor, textColor;
   
   if (pressed) {
-    bgColor = THEME_PRIMARY;
+    // Harder presses light the pad brighter
+    bgColor = tft.alphaBlend(128 + touch.velocity, THEME_PRIMARY, THEME_SURFACE);
     textColor = THEME_BG;
   } else if (isBlackKey) {
     bgColor = THEME_SURFACE;
@@ -198,7 +199,7 @@ void handleGridPianoMode() {
     
     // Turn on new note
     if (pressedNote != -1) {
-      sendNoteOn(pressedNote, 100);
+      sendNoteOn(pressedNote, touch.velocity);
     }
     
     gridPressedNote = pressedNote;
@@ -52,8 +52,6 @@ uint8_t bilinearInterpolate(uint8_t v00, uint8_t v10, uint8_t v01, uint8_t v11,
 }
 
 void regenerateGridsPattern() {
-  Serial.printf("Regenerating Grids pattern at X=%d Y=%d\n", grids.patternX, grids.patternY);
-  
   // For each step and voice, interpolate between the 4 corner patterns
   for (int step = 0; step < GRIDS_STEPS; step++) {
     // Read corner values from PROGMEM
@@ -77,26 +75,56 @@ void regenerateGridsPattern() {
   }
 }
 
-void initializeGridsMode() {
-  Serial.println("\n=== Grids Mode Initialization ===");
+// Transport step (MIDI task): one 16th note
+static void gridsStep(const TransportTick& tick, void*) {
+  if (!GeneratorRuntime::isPlaying(ENGINE_GRIDS)) return;
   
-  grids.step = 0;
-  grids.playing = false;
-  grids.lastStepTime = 0;
-  grids.bpm = 120.0;
-  grids.stepInterval = (60000.0 / grids.bpm) / 4.0; // 16th notes
+  uint8_t step = tick.step % GRIDS_STEPS;
+  uint32_t gate = tick.stepUs / 2;
+  grids.step = step;
   
-  grids.patternX = 128;
-  grids.patternY = 128;
-  grids.kickDensity = 200;
-  grids.snareDensity = 150;
-  grids.hatDensity = 180;
-  grids.swing = 0;
-  grids.accentThreshold = 200;
+  // Check each voice against its density threshold
+  bool kickTrigger = grids.kickPattern[step] >= (255 - grids.kickDensity);
+  bool snareTrigger = grids.snarePattern[step] >= (255 - grids.snareDensity);
+  bool hatTrigger = grids.hatPattern[step] >= (255 - grids.hatDensity);
+  
+  // Determine velocity (accent)
+  uint8_t kickVel = grids.kickPattern[step] >= grids.accentThreshold ? 127 : 100;
+  uint8_t snareVel = grids.snarePattern[step] >= grids.accentThreshold ? 127 : 100;
+  uint8_t hatVel = grids.hatPattern[step] >= grids.accentThreshold ? 127 : 90;
+  
+  // Send MIDI notes
+  if (kickTrigger) {
+    scheduleNote(grids.kickNote, kickVel, tick.timeUs, gate);
+  }
+  if (snareTrigger) {
+    scheduleNote(grids.snareNote, snareVel, tick.timeUs, gate);
+  }
+  if (hatTrigger) {
+    scheduleNote(grids.hatNote, hatVel, tick.timeUs, gate);
+  }
+}
+
+void initializeGridsMode() {
+  Serial.println("\n=== Grids Mode Initialization ===");
   
-  regenerateGridsPattern();
+  // The engine keeps playing after the screen closes, so only set it up once
+  if (!grids.engineReady) {
+    grids.step = 0;
+    grids.patternX = 128;
+    grids.patternY = 128;
+    grids.kickDensity = 200;
+    grids.snareDensity = 150;
+    grids.hatDensity = 180;
+    grids.swing = 0;
+    grids.accentThreshold = 200;
+    
+    regenerateGridsPattern();
+    GeneratorRuntime::attach(ENGINE_GRIDS, gridsStep, TRANSPORT_16TH);
+    grids.engineReady = true;
+  }
   
-  Serial.printf("BPM: %.1f, Pattern: (%d,%d)\n", grids.bpm, grids.patternX, grids.patternY);
+  Serial.printf("BPM: %.1f, Pattern: (%d,%d)\n", globalState.bpm, grids.patternX, grids.patternY);
   Serial.println("Grids initialized and drawn");
   
   drawGridsMode();
@@ -171,58 +199,18 @@ void drawGridsMode() {
   int btnH = 50;
   int btnW = (SCREEN_WIDTH - (5 * btnSpacing)) / 4;  // 4 buttons instead of 5
   
-  drawRoundButton(10, btnY, btnW, btnH, grids.playing ? "STOP" : "PLAY", THEME_PRIMARY, false);
+  drawRoundButton(10, btnY, btnW, btnH, GeneratorRuntime::isPlaying(ENGINE_GRIDS) ? "STOP" : "PLAY", THEME_PRIMARY, false);
   drawRoundButton(100, btnY, btnW, btnH, "BPM-", THEME_SECONDARY, false);
   drawRoundButton(190, btnY, btnW, btnH, "BPM+", THEME_SECONDARY, false);
   drawRoundButton(280, btnY, btnW, btnH, "RNDM", THEME_ACCENT, false);
 }
 
 void handleGridsMode() {
-  updateTouch();
-  
-  // Handle playback timing
-  if (grids.playing) {
-    unsigned long now = millis();
-    grids.stepInterval = (60000.0 / grids.bpm) / 4.0; // 16th notes
-    
-    if (now - grids.lastStepTime >= grids.stepInterval) {
-      grids.lastStepTime = now;
-      
-      // Check each voice against its density threshold
-      bool kickTrigger = grids.kickPattern[grids.step] >= (255 - grids.kickDensity);
-      bool snareTrigger = grids.snarePattern[grids.step] >= (255 - grids.snareDensity);
-      bool hatTrigger = grids.hatPattern[grids.step] >= (255 - grids.hatDensity);
-      
-      // Determine velocity (accent)
-      uint8_t kickVel = grids.kickPattern[grids.step] >= grids.accentThreshold ? 127 : 100;
-      uint8_t snareVel = grids.snarePattern[grids.step] >= grids.accentThreshold ? 127 : 100;
-      uint8_t hatVel = grids.hatPattern[grids.step] >= grids.accentThreshold ? 127 : 90;
-      
-      // Send MIDI notes
-      if (kickTrigger) {
-        sendNoteOn(grids.kickNote, kickVel);
-        sendNoteOff(grids.kickNote); // Immediate note off for drums
-      }
-      if (snareTrigger) {
-        sendNoteOn(grids.snareNote, snareVel);
-        sendNoteOff(grids.snareNote);
-      }
-      if (hatTrigger) {
-        sendNoteOn(grids.hatNote, hatVel);
-        sendNoteOff(grids.hatNote);
-      }
-      
-      // Advance step
-      grids.step = (grids.step + 1) % GRIDS_STEPS;
-    }
-  }
+  // Touch state for this frame was taken by loop()
   
   if (touch.justPressed) {
     // Check back button from header first
     if (isButtonPressed(BACK_BTN_X, BACK_BTN_Y, BTN_BACK_W, BTN_BACK_H)) {
-      if (grids.playing) {
-        grids.playing = false;
-      }
       exitToMenu();
       return;
     }
@@ -257,35 +245,32 @@ void handleGridsMode() {
     
     // Only redraw buttons when pressed
     if (playPressed || bpmDownPressed || bpmUpPressed || randomPressed) {
-      drawRoundButton(10, btnY, btnW, btnH, grids.playing ? "STOP" : "PLAY", THEME_PRIMARY, playPressed);
+      drawRoundButton(10, btnY, btnW, btnH, GeneratorRuntime::isPlaying(ENGINE_GRIDS) ? "STOP" : "PLAY", THEME_PRIMARY, playPressed);
       drawRoundButton(100, btnY, btnW, btnH, "BPM-", THEME_SECONDARY, bpmDownPressed);
       drawRoundButton(190, btnY, btnW, btnH, "BPM+", THEME_SECONDARY, bpmUpPressed);
       drawRoundButton(280, btnY, btnW, btnH, "RNDM", THEME_ACCENT, randomPressed);
     }
     if (playPressed) {
-      grids.playing = !grids.playing;
-      if (grids.playing) {
-        grids.step = 0;
-        grids.lastStepTime = millis();
-      }
-      drawGridsMode();
-      Serial.printf("Grids %s\n", grids.playing ? "started" : "stopped");
+      bool playing = !GeneratorRuntime::isPlaying(ENGINE_GRIDS);
+      GeneratorRuntime::setPlaying(ENGINE_GRIDS, playing);
+      drawRoundButton(10, btnY, btnW, btnH, playing ? "STOP" : "PLAY", THEME_PRIMARY, false);
+      Serial.printf("Grids %s\n", playing ? "starting" : "stopping");
       return;
     }
     
     // BPM-
     if (bpmDownPressed) {
-      grids.bpm = constrain(grids.bpm - 5, GRIDS_MIN_BPM, GRIDS_MAX_BPM);
+      setBPM(constrain(globalState.bpm - 5, GRIDS_MIN_BPM, GRIDS_MAX_BPM));
       drawGridsMode();
-      Serial.printf("BPM: %.1f\n", grids.bpm);
+      Serial.printf("BPM: %.1f\n", globalState.bpm);
       return;
     }
     
     // BPM+
     if (bpmUpPressed) {
-      grids.bpm = constrain(grids.bpm + 5, GRIDS_MIN_BPM, GRIDS_MAX_BPM);
+      setBPM(constrain(globalState.bpm + 5, GRIDS_MIN_BPM, GRIDS_MAX_BPM));
       drawGridsMode();
-      Serial.printf("BPM: %.1f\n", grids.bpm);
+      Serial.printf("BPM: %.1f\n", globalState.bpm);
       return;
     }
     
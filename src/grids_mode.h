@@ -16,6 +16,7 @@
 #include "common_definitions.h"
 #include "ui_elements.h"
 #include "midi_utils.h"
+#include "generator_runtime.h"
 
 #define GRIDS_STEPS 16
 #define GRIDS_MIN_BPM 60
@@ -23,11 +24,9 @@
 
 struct GridsState {
   // Playback
-  uint8_t step = 0;
-  bool playing = false;
-  unsigned long lastStepTime = 0;
-  unsigned long stepInterval = 125; // milliseconds per step
-  float bpm = 120.0;
+  // Runs in the background; playing state lives in GeneratorRuntime
+  volatile uint8_t step = 0;
+  bool engineReady = false;         // Pattern set up and step handler attached
   
   // Pattern control (X/Y coordinates, 0-255)
   uint8_t patternX = 128;  // X position in pattern map
@@ -0,0 +1,89 @@
+#ifndef ICON_RLE_H
+#define ICON_RLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Run-length coding of a small RGB565 image with up to 16 colours, for
+// icons that are mostly flat fills (menu icons: fill, outline, text)
+// - Pixels are kept as they sit in the source buffer (sprites hold them in
+//   panel byte order), so decoding gives bytes ready to push
+// - Runs never cross a row, so rows decode one at a time into a line buffer
+// - One byte per run: palette index in the high nibble, length 1-15 in the
+//   low nibble; a low nibble of 0 means the next byte holds length - 16
+//
+// Plain C++ (no Arduino), so the coding can be checked on the host.
+
+#define ICON_RLE_COLORS 16
+
+struct IconRLE {
+  uint16_t palette[ICON_RLE_COLORS];
+  uint8_t colors;
+  uint16_t width, height;
+  const uint8_t* runs;
+  size_t length;  // Bytes in runs
+};
+
+// Builds the palette of w x h pixels into icon; false if they use more
+// than ICON_RLE_COLORS colours
+inline bool iconRLEPalette(const uint16_t* pixels, uint16_t w, uint16_t h, IconRLE& icon) {
+  icon.colors = 0;
+  icon.width = w;
+  icon.height = h;
+  for (size_t i = 0; i < (size_t)w * h; i++) {
+    uint8_t c = 0;
+    while (c < icon.colors && icon.palette[c] != pixels[i]) c++;
+    if (c == icon.colors) {
+      if (icon.colors == ICON_RLE_COLORS) return false;
+      icon.palette[icon.colors++] = pixels[i];
+    }
+  }
+  return true;
+}
+
+// Codes the pixels with the palette of icon into out; with out == nullptr
+// only counts the bytes. Returns the byte count.
+inline size_t iconRLEEncode(const uint16_t* pixels, const IconRLE& icon, uint8_t* out) {
+  size_t n = 0;
+  for (uint16_t y = 0; y < icon.height; y++) {
+    const uint16_t* row = pixels + (size_t)y * icon.width;
+    uint16_t x = 0;
+    while (x < icon.width) {
+      uint16_t run = 1;
+      while (x + run < icon.width && row[x + run] == row[x] && run < 16 + 255) run++;
+      uint8_t c = 0;
+      while (icon.palette[c] != row[x]) c++;
+      if (run < 16) {
+        if (out) out[n] = (uint8_t)(c << 4 | run);
+        n++;
+      } else {
+        if (out) {
+          out[n] = (uint8_t)(c << 4);
+          out[n + 1] = (uint8_t)(run - 16);
+        }
+        n += 2;
+      }
+      x += run;
+    }
+  }
+  return n;
+}
+
+// Decodes one row starting at runs[pos] into line (icon.width pixels);
+// returns the position of the next row
+inline size_t iconRLEDecodeRow(const IconRLE& icon, size_t pos, uint16_t* line) {
+  uint16_t x = 0;
+  while (x < icon.width && pos < icon.length) {
+    uint8_t b = icon.runs[pos++];
+    uint16_t run = b & 0x0F;
+    if (run == 0) {
+      if (pos == icon.length) break;  // Cut short after a long-run marker
+      run = 16 + icon.runs[pos++];
+    }
+    uint16_t color = icon.palette[b >> 4];
+    while (run-- && x < icon.width) line[x++] = color;
+  }
+  return pos;
+}
+
+#endif // ICON_RLE_H
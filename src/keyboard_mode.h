@@ -27,7 +27,7 @@ void initializeKeyboardMode();
 void drawKeyboardMode();
 void handleKeyboardMode();
 void drawKeyboardKey(int row, int keyIndex, bool pressed);
-void playKeyboardNote(int row, int keyIndex, bool on);
+void playKeyboardNote(int row, int keyIndex, bool on, uint8_t velocity = 100);
 
 // Implementations
 void initializeKeyboardMode() {
@@ -245,7 +245,7 @@ void handleKeyboardMode() {
         playKeyboardNote(lastRow, lastKey, false);
         drawKeyboardKey(lastRow, lastKey, false);
       }
-      playKeyboardNote(row, key, true);
+      playKeyboardNote(row, key, true, touch.velocity);  // Sliding keeps the press velocity
       drawKeyboardKey(row, key, true);
       lastKey = key;
       lastRow = row;
@@ -258,11 +258,11 @@ void handleKeyboardMode() {
   }
 }
 
-void playKeyboardNote(int row, int keyIndex, bool on) {
+void playKeyboardNote(int row, int keyIndex, bool on, uint8_t velocity) {
   int note = getNoteInScale(keyboardScale, keyIndex, keyboardOctave + row) + keyboardKey;
   
   if (on) {
-    sendNoteOn(note, 100);
+    sendNoteOn(note, velocity);
   } else {
     sendNoteOff(note);
   }
@@ -0,0 +1,76 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Fixed-size histogram of microsecond durations
+// - 0-7 us get a bucket each, then every power of two is split into four,
+//   so a bucket is never wider than a quarter of its values (under 25% error)
+// - Durations from 2^24 us (about 17 s) up share the last bucket
+// - percentile() answers with the top of the bucket it falls in, never more
+//   than the largest duration seen, which is kept exactly
+// Adding is a few shifts and one increment, cheap enough for the MIDI path.
+//
+// Plain C++ (no Arduino), so it can be checked on the host.
+
+#define LATENCY_HISTOGRAM_BUCKETS 93  // 8 exact, 21 octaves of 4, overflow
+
+class LatencyHistogram {
+public:
+  LatencyHistogram() { reset(); }
+
+  void reset() {
+    memset(buckets, 0, sizeof(buckets));
+    total = 0;
+    largest = 0;
+  }
+
+  void add(uint32_t us) {
+    buckets[bucketOf(us)]++;
+    total++;
+    if (us > largest) largest = us;
+  }
+
+  uint32_t count() const { return total; }
+  uint32_t maxUs() const { return largest; }
+
+  // percent in 0-100; 0 when empty
+  uint32_t percentile(uint8_t percent) const {
+    if (total == 0) return 0;
+    uint32_t rank = (uint32_t)(((uint64_t)total * percent + 99) / 100);
+    if (rank == 0) rank = 1;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+      seen += buckets[i];
+      if (seen >= rank) {
+        uint32_t top = upperBound(i);
+        return top < largest ? top : largest;
+      }
+    }
+    return largest;
+  }
+
+  static uint8_t bucketOf(uint32_t us) {
+    if (us < 8) return (uint8_t)us;
+    uint8_t msb = 31 - __builtin_clz(us);
+    if (msb > 23) return LATENCY_HISTOGRAM_BUCKETS - 1;
+    return (uint8_t)(8 + (msb - 3) * 4 + ((us >> (msb - 2)) & 3));
+  }
+
+  // Largest duration that lands in bucket i
+  static uint32_t upperBound(uint8_t i) {
+    if (i < 8) return i;
+    if (i >= LATENCY_HISTOGRAM_BUCKETS - 1) return UINT32_MAX;
+    uint8_t msb = (i - 8) / 4 + 3;
+    uint8_t sub = (i - 8) % 4;
+    return ((uint32_t)(5 + sub) << (msb - 2)) - 1;
+  }
+
+private:
+  uint32_t buckets[LATENCY_HISTOGRAM_BUCKETS];
+  uint32_t total;
+  uint32_t largest;
+};
+
+#endif // LATENCY_HISTOGRAM_H
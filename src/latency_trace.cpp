@@ -0,0 +1,70 @@
+#include "latency_trace.h"
+
+LatencyHistogram LatencyTrace::histograms[LATENCY_STAGE_COUNT];
+SPSCQueue<LatencySpan, LATENCY_TRACE_RING> LatencyTrace::spans;
+uint32_t LatencyTrace::dispatchUs = 0;
+uint32_t LatencyTrace::handlerUs = 0;
+
+static const char* const stageNames[LATENCY_STAGE_COUNT] = {
+  "touch", "dispatch", "handler", "queue", "tick", "due", "notify"
+};
+
+void LatencyTrace::touchTaken(uint32_t sampleUs) {
+  uint32_t now = micros();
+  fold({sampleUs, now, LATENCY_TOUCH});
+  dispatchUs = now;
+}
+
+void LatencyTrace::handlerStart() {
+  handlerUs = 0;
+  if (!dispatchUs) return;  // Nothing was touched this frame
+  uint32_t now = micros();
+  fold({dispatchUs, now, LATENCY_DISPATCH});
+  dispatchUs = 0;
+  handlerUs = now;
+}
+
+void LatencyTrace::update() {
+  LatencySpan span;
+  while (spans.pop(span)) {
+    if (span.stage < LATENCY_STAGE_COUNT) fold(span);
+  }
+}
+
+const char* LatencyTrace::stageName(LatencyStage stage) {
+  return stage < LATENCY_STAGE_COUNT ? stageNames[stage] : "?";
+}
+
+void LatencyTrace::reset() {
+  update();  // Spans from before the reset are not counted after it
+  for (uint8_t i = 0; i < LATENCY_STAGE_COUNT; i++) histograms[i].reset();
+  spans.resetStats();
+}
+
+void LatencyTrace::printReport() {
+  update();
+  Serial.printf("[Latency] %-8s %8s %8s %8s %8s\n", "stage", "count", "p50 us", "p99 us", "max us");
+  for (uint8_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+    const LatencyHistogram& h = histograms[i];
+    Serial.printf("[Latency] %-8s %8lu %8lu %8lu %8lu\n", stageNames[i], (unsigned long)h.count(),
+                  (unsigned long)h.percentile(50), (unsigned long)h.percentile(99),
+                  (unsigned long)h.maxUs());
+  }
+  if (droppedSpans()) Serial.printf("[Latency] %lu spans dropped\n", (unsigned long)droppedSpans());
+}
+
+String LatencyTrace::toJSON() {
+  update();
+  String json = "{\"unit\":\"us\",\"dropped\":" + String(droppedSpans()) + ",\"stages\":[";
+  for (uint8_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+    const LatencyHistogram& h = histograms[i];
+    if (i > 0) json += ",";
+    json += "{\"name\":\"" + String(stageNames[i]) + "\",";
+    json += "\"count\":" + String(h.count()) + ",";
+    json += "\"p50\":" + String(h.percentile(50)) + ",";
+    json += "\"p99\":" + String(h.percentile(99)) + ",";
+    json += "\"max\":" + String(h.maxUs()) + "}";
+  }
+  json += "]}";
+  return json;
+}
@@ -0,0 +1,84 @@
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <Arduino.h>
+#include "latency_histogram.h"
+#include "spsc_queue.h"
+
+// Where the time goes between a finger (or a clock tick) and a BLE notify
+// Each stage is a span between two trace points, kept as a histogram:
+//   touch     touch task sampled the panel  -> updateTouch() took the event
+//   dispatch  updateTouch() took it         -> loop() called the mode handler
+//   handler   mode handler called           -> its first send* (that frame)
+//   queue     send* enqueued                -> MIDI task took it off the ring
+//   tick      clock timer fired             -> MIDI task ran the step handlers
+//   due       scheduled event due           -> MIDI task took it off the heap
+//   notify    first message of a packet taken -> notify() returned
+// The MIDI task's spans go through a wait-free ring (dropped and counted
+// when full); update() folds them in on the loop task, which owns the
+// histograms. Each trace point costs a micros() call and a ring slot, so it
+// stays on in release builds.
+
+#define LATENCY_TRACE_RING 256  // Power of two; drained every loop() pass
+
+enum LatencyStage : uint8_t {
+  LATENCY_TOUCH,
+  LATENCY_DISPATCH,
+  LATENCY_HANDLER,
+  LATENCY_QUEUE,
+  LATENCY_TICK,
+  LATENCY_DUE,
+  LATENCY_NOTIFY,
+  LATENCY_STAGE_COUNT
+};
+
+// One measured span, timestamps in micros()
+struct LatencySpan {
+  uint32_t startUs;
+  uint32_t endUs;
+  LatencyStage stage;
+};
+
+class LatencyTrace {
+public:
+  // Loop task: updateTouch() took an event sampled at sampleUs
+  static void touchTaken(uint32_t sampleUs);
+  // Loop task: around the mode handler
+  static void handlerStart();
+  static void handlerEnd() { handlerUs = 0; }
+  // Loop task: a message went into the MIDI ring
+  static void enqueued() {
+    if (handlerUs) {
+      fold({handlerUs, (uint32_t)micros(), LATENCY_HANDLER});
+      handlerUs = 0;  // Only the first message of the frame
+    }
+  }
+
+  // MIDI task only
+  static void midiSpan(LatencyStage stage, uint32_t startUs, uint32_t endUs) {
+    spans.push({startUs, endUs, stage});
+  }
+
+  // Loop task: fold in what the MIDI task traced
+  static void update();
+
+  static const char* stageName(LatencyStage stage);
+  static const LatencyHistogram& histogram(LatencyStage stage) { return histograms[stage]; }
+  static uint32_t droppedSpans() { return spans.dropCount(); }
+  static void reset();
+
+  static void printReport();  // Serial: count, p50, p99 and max per stage
+  static String toJSON();
+
+private:
+  static LatencyHistogram histograms[LATENCY_STAGE_COUNT];
+  static SPSCQueue<LatencySpan, LATENCY_TRACE_RING> spans;
+  static uint32_t dispatchUs;  // Touch event taken this frame, 0 if none
+  static uint32_t handlerUs;   // Handler of a touch frame running, 0 if not
+
+  static void fold(const LatencySpan& span) {
+    histograms[span.stage].add(span.endUs - span.startUs);
+  }
+};
+
+#endif // LATENCY_TRACE_H
@@ -348,16 +348,8 @@ void sendLFOValue(int value) {
   if (!globalState.bleConnected) return;
   
   if (lfo.pitchWheelMode) {
-    // Send pitchwheel (14-bit value already calculated)
-    byte lsb = value & 0x7F;
-    byte msb = (value >> 7) & 0x7F;
-    
-    // Pitchwheel: 0xE0, LSB, MSB
-    midiPacket[2] = 0xE0;
-    midiPacket[3] = lsb;
-    midiPacket[4] = msb;
-    pCharacteristic->setValue(midiPacket, 5);
-    pCharacteristic->notify();
+    // Send pitchwheel (14-bit value already calculated, thread re-centers it)
+    sendPitchBend(value - 8192);
   } else {
     // Send regular CC
     sendControlChange(lfo.ccTarget, value);
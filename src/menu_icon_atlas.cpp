@@ -0,0 +1,77 @@
+#include "menu_icon_atlas.h"
+
+IconRLE MenuIconAtlas::icons[MENU_ICON_ATLAS_MAX];
+uint8_t MenuIconAtlas::iconCount = 0;
+int16_t MenuIconAtlas::iconSize = 0;
+bool MenuIconAtlas::built = false;
+
+void MenuIconAtlas::build(uint8_t count, int16_t size, MenuIconPainter paint) {
+  clear();
+  if (count > MENU_ICON_ATLAS_MAX) count = MENU_ICON_ATLAS_MAX;
+  iconCount = count;
+  iconSize = size;
+  built = true;  // Even if nothing fits, so the menu does not retry every draw
+
+  uint32_t start = micros();
+  TFT_eSprite scratch(&tft);
+  scratch.setColorDepth(16);
+  if (!scratch.createSprite(size, size)) {
+    Serial.printf("[Menu] No RAM for a %dx%d icon sprite, icons stay procedural\n", size, size);
+    return;
+  }
+  const uint16_t* pixels = (const uint16_t*)scratch.getPointer();
+
+  uint8_t cached = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    scratch.fillSprite(THEME_BG);  // Shows at the rounded corners
+    paint(scratch, i, size);
+
+    IconRLE& icon = icons[i];
+    if (!iconRLEPalette(pixels, size, size, icon)) continue;
+    size_t length = iconRLEEncode(pixels, icon, nullptr);
+    uint8_t* runs = (uint8_t*)malloc(length);
+    if (!runs) continue;
+    iconRLEEncode(pixels, icon, runs);
+    icon.runs = runs;
+    icon.length = length;
+    cached++;
+  }
+  scratch.deleteSprite();
+
+  Serial.printf("[Menu] Icon atlas: %u/%u icons, %u bytes, built in %lu us\n",
+                cached, count, (unsigned)bytes(), (unsigned long)(micros() - start));
+}
+
+void MenuIconAtlas::clear() {
+  for (uint8_t i = 0; i < MENU_ICON_ATLAS_MAX; i++) {
+    free((void*)icons[i].runs);
+    icons[i].runs = nullptr;
+    icons[i].length = 0;
+  }
+  iconCount = 0;
+  built = false;
+}
+
+bool MenuIconAtlas::draw(uint8_t index, int x, int y) {
+  if (index >= iconCount || !icons[index].runs) return false;
+  const IconRLE& icon = icons[index];
+
+  // Sprite pixels are stored in panel byte order, which is what
+  // pushPixels() sends while byte swapping is off
+  static uint16_t line[SCREEN_WIDTH];  // Icons are never wider than the screen
+  size_t pos = 0;
+  tft.startWrite();
+  tft.setAddrWindow(x, y, icon.width, icon.height);
+  for (uint16_t row = 0; row < icon.height; row++) {
+    pos = iconRLEDecodeRow(icon, pos, line);
+    tft.pushPixels(line, icon.width);
+  }
+  tft.endWrite();
+  return true;
+}
+
+size_t MenuIconAtlas::bytes() {
+  size_t total = 0;
+  for (uint8_t i = 0; i < iconCount; i++) total += icons[i].length;
+  return total;
+}
@@ -0,0 +1,39 @@
+#ifndef MENU_ICON_ATLAS_H
+#define MENU_ICON_ATLAS_H
+
+#include "common_definitions.h"
+#include "icon_rle.h"
+
+// Menu icons rendered once and kept as palettised runs (icon_rle.h)
+// - build() paints each icon into a scratch sprite, the same drawing the
+//   menu used to do on the panel, and keeps the coded pixels; the sprite
+//   is freed again once all icons are coded
+// - draw() streams an icon to the panel row by row, one address window
+//   per icon instead of dozens of primitives
+// - An icon that needs more colours than the palette holds, or that found
+//   no RAM, stays uncached; draw() returns false and the menu paints it
+// Built on the first menu draw, rebuilt only when the icon size changes.
+// Loop task only.
+
+#define MENU_ICON_ATLAS_MAX 24
+
+// Paints icon index with its top-left corner at (0, 0)
+typedef void (*MenuIconPainter)(TFT_eSPI& gfx, uint8_t index, int16_t size);
+
+class MenuIconAtlas {
+public:
+  static void build(uint8_t count, int16_t size, MenuIconPainter paint);
+  static void clear();
+  static bool isBuilt(uint8_t count, int16_t size) { return built && count == iconCount && size == iconSize; }
+
+  static bool draw(uint8_t index, int x, int y);  // false if not cached
+  static size_t bytes();  // Runs held by the atlas
+
+private:
+  static IconRLE icons[MENU_ICON_ATLAS_MAX];
+  static uint8_t iconCount;
+  static int16_t iconSize;
+  static bool built;
+};
+
+#endif // MENU_ICON_ATLAS_H
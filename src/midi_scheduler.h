@@ -0,0 +1,124 @@
+#ifndef MIDI_SCHEDULER_H
+#define MIDI_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Fixed-capacity binary min-heap of future events, ordered by due time
+// - T must have a uint32_t timestampUs member (micros() timebase)
+// - Comparisons are wrap-safe for events within +/-35 minutes of each other
+// - Events due at the same microsecond come out in the order they went in,
+//   so a note-off scheduled before a retriggering note-on stays ahead of it
+//
+// Owned by the MIDI task only - not thread safe. Plain C++ for host builds.
+
+template <typename T, size_t N>
+class TimedEventHeap {
+public:
+  TimedEventHeap() : count(0), sequence(0) {}
+
+  bool push(const T& event) {
+    if (count >= N) return false;
+    size_t i = count++;
+    entries[i].event = event;
+    entries[i].order = sequence++;
+    siftUp(i);
+    return true;
+  }
+
+  // Remove and return the earliest event if it is due at or before nowUs
+  bool popDue(uint32_t nowUs, T& event) {
+    if (count == 0 || (int32_t)(entries[0].event.timestampUs - nowUs) > 0) return false;
+    event = entries[0].event;
+    entries[0] = entries[--count];
+    siftDown(0);
+    return true;
+  }
+
+  // Due time of the earliest event (only valid when !isEmpty())
+  uint32_t nextDueUs() const { return entries[0].event.timestampUs; }
+
+  size_t size() const { return count; }
+  bool isEmpty() const { return count == 0; }
+  static constexpr size_t capacity() { return N; }
+  void clear() { count = 0; }
+
+private:
+  struct Entry {
+    T event;
+    uint32_t order;  // Insertion sequence, breaks ties between equal due times
+  };
+
+  Entry entries[N];
+  size_t count;
+  uint32_t sequence;
+
+  static bool earlier(const Entry& a, const Entry& b) {
+    int32_t dt = (int32_t)(a.event.timestampUs - b.event.timestampUs);
+    if (dt != 0) return dt < 0;
+    return (int32_t)(a.order - b.order) < 0;
+  }
+
+  void siftUp(size_t i) {
+    while (i > 0) {
+      size_t parent = (i - 1) / 2;
+      if (!earlier(entries[i], entries[parent])) break;
+      Entry tmp = entries[i];
+      entries[i] = entries[parent];
+      entries[parent] = tmp;
+      i = parent;
+    }
+  }
+
+  void siftDown(size_t i) {
+    while (true) {
+      size_t left = 2 * i + 1;
+      size_t right = left + 1;
+      size_t smallest = i;
+      if (left < count && earlier(entries[left], entries[smallest])) smallest = left;
+      if (right < count && earlier(entries[right], entries[smallest])) smallest = right;
+      if (smallest == i) break;
+      Entry tmp = entries[i];
+      entries[i] = entries[smallest];
+      entries[smallest] = tmp;
+      i = smallest;
+    }
+  }
+};
+
+// Note-ons not yet matched by a note-off, per channel and note
+// - A generator that retriggers a note before its previous note-off is due
+//   (a long gate, a slide) leaves two offs for one sounding note; the first
+//   would cut the new note short. release() is false for every off but the
+//   one matching the last note-on, so the note ends with its latest gate.
+// - Only scheduled offs go through release(); a live off (key lifted) calls
+//   reset() and always goes out, so an unbalanced mode cannot hang a note.
+//
+// Owned by the MIDI task only - not thread safe. Plain C++ for host builds.
+
+class NoteOverlap {
+public:
+  NoteOverlap() { clear(); }
+
+  void noteOn(uint8_t ch, uint8_t note) {
+    uint8_t& n = pending[ch & 0x0F][note & 0x7F];
+    if (n < 255) n++;
+  }
+
+  // A scheduled note-off: true if it ends the note and should go out. An
+  // off matching no note-on (the note was already released) ends nothing.
+  bool release(uint8_t ch, uint8_t note) {
+    uint8_t& n = pending[ch & 0x0F][note & 0x7F];
+    if (n == 0) return false;
+    return --n == 0;
+  }
+
+  void reset(uint8_t ch, uint8_t note) { pending[ch & 0x0F][note & 0x7F] = 0; }
+  void clear() { memset(pending, 0, sizeof(pending)); }
+
+private:
+  uint8_t pending[16][128];
+};
+
+#endif // MIDI_SCHEDULER_H
@@ -3,6 +3,8 @@
 
 #include "common_definitions.h"
 #include "ui_elements.h"  // For Button class
+#include "transport.h"
+#include "generator_runtime.h"
 
 // External variables
 extern uint8_t midiChannel;
@@ -18,17 +20,16 @@ extern const Scale scales[];
 extern const int NUM_SCALES;
 
 // Legacy MIDI utility functions (kept for backward compatibility)
+// Routed through the MIDI thread so all output shares one BLE packet stream
 inline void sendMIDI(byte cmd, byte note, byte vel) {
   if (!globalState.bleConnected) return;
   
-  // Apply MIDI channel (channels 1-16 are encoded as 0-15 in the lower nibble)
-  byte channelCmd = (cmd & 0xF0) | ((midiChannel - 1) & 0x0F);
-  
-  midiPacket[2] = channelCmd;
-  midiPacket[3] = note;
-  midiPacket[4] = vel;
-  pCharacteristic->setValue(midiPacket, 5);
-  pCharacteristic->notify();
+  switch (cmd & 0xF0) {
+    case 0x90: MIDIThread::sendNoteOn(note, vel); break;
+    case 0x80: MIDIThread::sendNoteOff(note, vel); break;
+    case 0xB0: MIDIThread::sendCC(note, vel); break;
+    case 0xE0: MIDIThread::sendPitchBend((int16_t)(((vel & 0x7F) << 7) | (note & 0x7F)) - 8192); break;
+  }
 }
 
 // Threaded MIDI functions (preferred - use these for new code)
@@ -48,6 +49,29 @@ inline void sendPitchBend(int16_t value) {
   MIDIThread::sendPitchBend(value);
 }
 
+// Scheduled output - generators look ahead and hand the MIDI core exact times
+#define MIDI_LOOKAHEAD_US 50000  // How far ahead of "now" steps are scheduled
+
+// Note-on at onUs with its own note-off, so stopping never leaves a stuck note.
+// Gates may be longer than a step: a retrigger outlives the earlier note's off.
+inline void scheduleNote(uint8_t note, uint8_t velocity, uint32_t onUs, uint32_t lengthUs) {
+  MIDIThread::scheduleNoteOn(note, velocity, onUs);
+  MIDIThread::scheduleNoteOff(note, onUs + lengthUs);
+}
+
+// Step timing for lookahead generators. Returns true (and the step's due time)
+// when the next step falls inside the lookahead window, then advances.
+// After a stall longer than one step the grid restarts from now rather than
+// bursting out every missed step.
+inline bool takeScheduledStep(uint32_t& nextStepUs, uint32_t intervalUs, uint32_t& stepTimeUs) {
+  uint32_t now = micros();
+  if ((int32_t)(now - nextStepUs) > (int32_t)intervalUs) nextStepUs = now;
+  if ((int32_t)(nextStepUs - now) > MIDI_LOOKAHEAD_US) return false;
+  stepTimeUs = nextStepUs;
+  nextStepUs += intervalUs;
+  return true;
+}
+
 inline void setBPM(float bpm) {
   MIDIThread::setBPM(bpm);
   globalState.bpm = bpm;
@@ -58,10 +82,31 @@ inline float getBPM() {
   return MIDIThread::getBPM();
 }
 
+// Play/stop for the step modes. With an external clock present the master
+// owns the transport, so these leave it alone.
+// sendClock false: run the generators without sending START, clock and STOP
+inline void startTransport(bool sendClock = true) {
+  if (midiClock.isReceiving) return;
+  globalState.isPlaying = true;
+  MIDIThread::setClockOutput(sendClock);
+  MIDIThread::sendStart();
+}
+
+inline void stopTransport() {
+  if (midiClock.isReceiving) return;
+  globalState.isPlaying = false;
+  MIDIThread::sendStop();
+}
+
 inline void stopAllModes() {
-  // Stop all MIDI notes using threaded system
-  for (int i = 0; i < 128; i++) {
-    MIDIThread::sendNoteOff(i, 0);
+  // Foreground generators (arp, RNG) stop with their screen. Background
+  // engines keep playing, and the transport with them.
+  GeneratorRuntime::stopForeground();
+  
+  if (!GeneratorRuntime::anyPlaying()) {
+    // Drop pending scheduled events, then release only the notes still sounding
+    MIDIThread::cancelScheduled();
+    MIDIThread::panic();
   }
   
   // Clear Button objects to prevent drawing on other screens
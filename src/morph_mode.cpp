@@ -254,8 +254,7 @@ void generateMIDIFromGesture(const GesturePoint& point) {
   velocity = constrain(velocity, 1, 127);
   
   // Send note
-  sendNoteOn(pitch, velocity);
-  sendNoteOff(pitch); // Immediate note off for percussive feel
+  scheduleNote(pitch, velocity, micros(), 100000); // Short gate for percussive feel
   
   // Send CC based on X position (e.g., CC74 for filter)
   int ccValue = (int)(point.x * 127);
@@ -537,7 +536,7 @@ void handleMorphMode() {
     
     // Back button
     else if (isButtonPressed(BACK_BTN_X, BACK_BTN_Y, BTN_BACK_W, BTN_BACK_H)) {
-      currentMode = MENU;
+      exitToMenu();
       return;
     }
   }
@@ -4,6 +4,7 @@
 #include "common_definitions.h"
 #include "ui_elements.h"
 #include "midi_utils.h"
+#include "play_area_renderer.h"
 
 // Physics Drop mode variables
 struct DropBall {
@@ -42,12 +43,19 @@ int dropKey = 0;
 int dropOctave = 4;
 bool platformMode = false; // false = drop mode, true = platform edit mode
 
+// Balls and platforms live between the header and the buttons
+#define DROP_BUTTONS_Y 200
+#define DROP_FRAME_MS 25  // 40 FPS
+
 // Function declarations
 void initializePhysicsDropMode();
 void drawPhysicsDropMode();
 void handlePhysicsDropMode();
-void drawDropBalls();
-void drawPlatforms();
+void drawDropBalls(TFT_eSPI& gfx, int16_t ox, int16_t oy);
+void drawPlatforms(TFT_eSPI& gfx, int16_t ox, int16_t oy);
+void paintPhysicsDropArea(TFT_eSPI& gfx, int16_t ox, int16_t oy);
+void invalidateDropBall(int i);
+void invalidatePlatform(int p);
 void updatePhysics();
 void spawnDropBall(int x, int y);
 void addPlatform(int x, int y);
@@ -103,50 +111,34 @@ void drawPhysicsDropMode() {
   tft.drawString("Oct:" + String(dropOctave), SCREEN_WIDTH / 2 - 30, statusY, 1);
   tft.drawString("Balls:" + String(numActiveDropBalls), SCREEN_WIDTH - 80, statusY, 1);
   
-  drawPlatforms();
-  drawDropBalls();
+  // Platforms and balls are rendered off-screen, strip by strip
+  PlayAreaRenderer::begin(0, CONTENT_TOP, SCREEN_WIDTH, DROP_BUTTONS_Y - CONTENT_TOP, paintPhysicsDropArea);
+  PlayAreaRenderer::invalidateAll();
+  PlayAreaRenderer::render();
 }
 
-void drawDropBalls() {
+void drawDropBalls(TFT_eSPI& gfx, int16_t ox, int16_t oy) {
   for (int i = 0; i < MAX_DROP_BALLS; i++) {
     if (!dropBalls[i].active) continue;
-    
-    // Fade out old balls
-    unsigned long age = millis() - dropBalls[i].spawnTime;
-    if (age > 5000) {
-      dropBalls[i].active = false;
-      numActiveDropBalls--;
-      continue;
-    }
-    
-    tft.fillCircle(dropBalls[i].x, dropBalls[i].y, dropBalls[i].size, dropBalls[i].color);
-    tft.drawCircle(dropBalls[i].x, dropBalls[i].y, dropBalls[i].size, THEME_TEXT);
+    gfx.fillCircle(dropBalls[i].x - ox, dropBalls[i].y - oy, dropBalls[i].size, dropBalls[i].color);
+    gfx.drawCircle(dropBalls[i].x - ox, dropBalls[i].y - oy, dropBalls[i].size, THEME_TEXT);
   }
 }
 
-void drawPlatforms() {
+void drawPlatforms(TFT_eSPI& gfx, int16_t ox, int16_t oy) {
   for (int i = 0; i < numPlatforms; i++) {
-    uint16_t color = platforms[i].color;
-    
     // Flash when hit
-    if (platforms[i].active) {
-      unsigned long elapsed = millis() - platforms[i].activeTime;
-      if (elapsed < 200) {
-        color = THEME_TEXT;
-      } else {
-        platforms[i].active = false;
-      }
-    }
+    uint16_t color = platforms[i].active ? THEME_TEXT : platforms[i].color;
     
     // Draw angled rectangle (simplified as normal rectangle for now)
-    tft.fillRect(platforms[i].x, platforms[i].y, platforms[i].w, platforms[i].h, color);
-    tft.drawRect(platforms[i].x, platforms[i].y, platforms[i].w, platforms[i].h, THEME_TEXT);
+    gfx.fillRect(platforms[i].x - ox, platforms[i].y - oy, platforms[i].w, platforms[i].h, color);
+    gfx.drawRect(platforms[i].x - ox, platforms[i].y - oy, platforms[i].w, platforms[i].h, THEME_TEXT);
     
     // Show note name
-    tft.setTextColor(THEME_BG, color);
-    tft.drawCentreString(platforms[i].noteName, 
-                        platforms[i].x + platforms[i].w/2, 
-                        platforms[i].y + platforms[i].h/2 - 4, 1);
+    gfx.setTextColor(THEME_BG, color);
+    gfx.drawCentreString(platforms[i].noteName, 
+                        platforms[i].x + platforms[i].w/2 - ox, 
+                        platforms[i].y + platforms[i].h/2 - 4 - oy, 1);
   }
 }
 
@@ -284,43 +276,29 @@ void addPlatform(int x, int y) {
 
 void updatePhysics() {
   static unsigned long lastUpdate = 0;
-  static float lastX[MAX_DROP_BALLS], lastY[MAX_DROP_BALLS];
-  static bool initialized = false;
-  
-  if (millis() - lastUpdate < 50) return; // 20 FPS to reduce flickering
-  
-  // Initialize last positions
-  if (!initialized) {
-    for (int i = 0; i < MAX_DROP_BALLS; i++) {
-      lastX[i] = dropBalls[i].x;
-      lastY[i] = dropBalls[i].y;
-    }
-    initialized = true;
-  }
-  
-  // Clear previous ball positions only
-  for (int i = 0; i < MAX_DROP_BALLS; i++) {
-    if (dropBalls[i].active) {
-      tft.fillCircle(lastX[i], lastY[i], dropBalls[i].size + 1, THEME_BG);
-    }
-  }
+  if (millis() - lastUpdate < DROP_FRAME_MS) return;
+  const float dt = DROP_FRAME_MS / 50.0f;  // Motion is tuned in 50ms steps
   
   for (int i = 0; i < MAX_DROP_BALLS; i++) {
     if (!dropBalls[i].active) continue;
+    invalidateDropBall(i);  // Where it was
     
-    // Store last position
-    lastX[i] = dropBalls[i].x;
-    lastY[i] = dropBalls[i].y;
+    // Fade out old balls
+    if (millis() - dropBalls[i].spawnTime > 5000) {
+      dropBalls[i].active = false;
+      numActiveDropBalls--;
+      continue;
+    }
     
     // Apply gravity
-    dropBalls[i].vy += dropBalls[i].gravity;
+    dropBalls[i].vy += dropBalls[i].gravity * dt;
     
     // Apply friction
-    dropBalls[i].vx *= dropBalls[i].friction;
+    dropBalls[i].vx *= powf(dropBalls[i].friction, dt);
     
     // Update position
-    dropBalls[i].x += dropBalls[i].vx;
-    dropBalls[i].y += dropBalls[i].vy;
+    dropBalls[i].x += dropBalls[i].vx * dt;
+    dropBalls[i].y += dropBalls[i].vy * dt;
     
     // Boundary collisions
     if (dropBalls[i].x - dropBalls[i].size <= 10) {
@@ -338,22 +316,43 @@ void updatePhysics() {
       // Ground hit - play note
       if (abs(dropBalls[i].vy) > 1) {
         int velocity = random(60, 100);
-        sendNoteOn(dropBalls[i].note, velocity);
-        sendNoteOff(dropBalls[i].note);
+        scheduleNote(dropBalls[i].note, velocity, micros(), 100000);  // Short percussive gate
       }
     }
   }
   
   checkPlatformCollisions();
+  for (int i = 0; i < MAX_DROP_BALLS; i++) {
+    if (dropBalls[i].active) invalidateDropBall(i);  // Where it is now
+  }
   
-  // Redraw platforms (they don't move so less flickering)
-  drawPlatforms();
-  // Draw balls at new positions
-  drawDropBalls();
+  // End the flash of platforms hit more than 200ms ago
+  for (int p = 0; p < numPlatforms; p++) {
+    if (platforms[p].active && millis() - platforms[p].activeTime >= 200) {
+      platforms[p].active = false;
+      invalidatePlatform(p);
+    }
+  }
   
+  PlayAreaRenderer::render();
   lastUpdate = millis();
 }
 
+void invalidateDropBall(int i) {
+  int r = dropBalls[i].size + 2;  // Outline and rounding
+  PlayAreaRenderer::invalidate((int)dropBalls[i].x - r, (int)dropBalls[i].y - r, 2 * r + 1, 2 * r + 1);
+}
+
+void invalidatePlatform(int p) {
+  PlayAreaRenderer::invalidate(platforms[p].x, platforms[p].y, platforms[p].w + 1, platforms[p].h + 1);
+}
+
+// Everything in the play area, for PlayAreaRenderer
+void paintPhysicsDropArea(TFT_eSPI& gfx, int16_t ox, int16_t oy) {
+  drawPlatforms(gfx, ox, oy);
+  drawDropBalls(gfx, ox, oy);
+}
+
 void checkPlatformCollisions() {
   for (int b = 0; b < MAX_DROP_BALLS; b++) {
     if (!dropBalls[b].active) continue;
@@ -374,11 +373,11 @@ void checkPlatformCollisions() {
         // Play platform note
         if (!platforms[p].active) {
           int velocity = random(70, 110);
-          sendNoteOn(platforms[p].note, velocity);
-          sendNoteOff(platforms[p].note);
+          scheduleNote(platforms[p].note, velocity, micros(), 100000);
           
           platforms[p].active = true;
           platforms[p].activeTime = millis();
+          invalidatePlatform(p);
         }
         
         break;
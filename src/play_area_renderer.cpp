@@ -0,0 +1,128 @@
+#include "play_area_renderer.h"
+
+TFT_eSprite PlayAreaRenderer::strips[2] = {TFT_eSprite(&tft), TFT_eSprite(&tft)};
+PlayAreaPaintFunction PlayAreaRenderer::paint = nullptr;
+int16_t PlayAreaRenderer::areaX = 0;
+int16_t PlayAreaRenderer::areaY = 0;
+int16_t PlayAreaRenderer::areaW = 0;
+int16_t PlayAreaRenderer::areaH = 0;
+int16_t PlayAreaRenderer::stripH = 0;
+uint8_t PlayAreaRenderer::stripCount = 0;
+bool PlayAreaRenderer::buffered = false;
+uint32_t PlayAreaRenderer::dirty = 0;
+uint16_t PlayAreaRenderer::background = THEME_BG;
+bool PlayAreaRenderer::dmaReady = false;
+
+void PlayAreaRenderer::begin(int x, int y, int w, int h, PlayAreaPaintFunction paintFn, uint16_t bg) {
+  if (paint && x == areaX && y == areaY && w == areaW && h == areaH) {
+    paint = paintFn;  // Same area: keep the sprites
+    background = bg;
+    return;
+  }
+  end();
+  if (w <= 0 || h <= 0 || !paintFn) return;
+
+  paint = paintFn;
+  background = bg;
+  areaX = x;
+  areaY = y;
+  areaW = w;
+  areaH = h;
+
+  // As many rows as fit the budget, but no more than PLAY_AREA_MAX_STRIPS strips
+  int rows = PLAY_AREA_STRIP_BYTES / (w * 2);
+  int minRows = (h + PLAY_AREA_MAX_STRIPS - 1) / PLAY_AREA_MAX_STRIPS;
+  if (rows < minRows) rows = minRows;
+  if (rows > h) rows = h;
+  stripH = rows;
+  stripCount = (h + rows - 1) / rows;
+
+  buffered = true;
+  for (uint8_t i = 0; i < 2 && buffered; i++) {
+    strips[i].setColorDepth(16);
+    strips[i].setAttribute(PSRAM_ENABLE, false);  // DMA reads internal RAM only
+    buffered = strips[i].createSprite(w, rows) != nullptr;
+  }
+  if (!buffered) {
+    strips[0].deleteSprite();
+    Serial.printf("[PlayArea] No RAM for two %dx%d strips, drawing to the panel\n", w, rows);
+    return;
+  }
+
+  static bool dmaTried = false;
+  if (!dmaTried) {
+    dmaTried = true;
+#if PLAY_AREA_USE_DMA
+    dmaReady = tft.initDMA();
+    Serial.printf("[PlayArea] DMA %s\n", dmaReady ? "ready" : "unavailable, pushing blocking");
+#else
+    dmaReady = false;
+    Serial.println("[PlayArea] 18-bit panel, pushing blocking");
+#endif
+  }
+}
+
+void PlayAreaRenderer::end() {
+  strips[0].deleteSprite();
+  strips[1].deleteSprite();
+  buffered = false;
+  paint = nullptr;
+  areaX = areaY = areaW = areaH = 0;
+  stripH = 0;
+  stripCount = 0;
+  dirty = 0;
+}
+
+void PlayAreaRenderer::invalidate(int x, int y, int w, int h) {
+  if (!paint) return;
+  int y0 = max(y, (int)areaY);
+  int y1 = min(y + h, areaY + areaH);
+  if (y1 <= y0 || x + w <= areaX || x >= areaX + areaW) return;
+  for (int i = (y0 - areaY) / stripH; i <= (y1 - 1 - areaY) / stripH; i++) dirty |= 1UL << i;
+}
+
+void PlayAreaRenderer::invalidateAll() {
+  if (!paint) return;
+  dirty = stripCount >= 32 ? 0xFFFFFFFFUL : (1UL << stripCount) - 1;
+}
+
+void PlayAreaRenderer::render() {
+  if (!dirty || !paint) return;
+  if (!buffered) {
+    renderDirect();
+    return;
+  }
+
+  uint8_t next = 0;
+  tft.startWrite();
+  for (uint8_t i = 0; i < stripCount; i++) {
+    if (!(dirty & (1UL << i))) continue;
+    int16_t y = areaY + i * stripH;
+    int16_t h = min((int)stripH, areaY + areaH - y);
+
+    // The other sprite may still be on its way to the panel
+    TFT_eSprite& strip = strips[next];
+    strip.fillSprite(background);
+    paint(strip, areaX, y);
+    uint16_t* pixels = (uint16_t*)strip.getPointer();
+    if (dmaReady) tft.pushImageDMA(areaX, y, areaW, h, pixels);  // Waits for the previous strip
+    else tft.pushImage(areaX, y, areaW, h, pixels);
+    next ^= 1;
+  }
+  if (dmaReady) tft.dmaWait();
+  tft.endWrite();
+  dirty = 0;
+}
+
+void PlayAreaRenderer::renderDirect() {
+  for (uint8_t i = 0; i < stripCount; i++) {
+    if (!(dirty & (1UL << i))) continue;
+    int16_t y = areaY + i * stripH;
+    int16_t h = min((int)stripH, areaY + areaH - y);
+    tft.setViewport(areaX, y, areaW, h, false);
+    tft.fillRect(areaX, y, areaW, h, background);
+    paint(tft, 0, 0);
+    tft.resetViewport();
+  }
+  dirty = 0;
+}
@@ -0,0 +1,62 @@
+#ifndef PLAY_AREA_RENDERER_H
+#define PLAY_AREA_RENDERER_H
+
+#include "common_definitions.h"
+
+// Off-screen rendering of an animated play area (ZEN, DROP)
+// - The area is cut into full-width strips. Two strip sprites in internal
+//   RAM take turns: while one is pushed to the panel with pushImageDMA, the
+//   next strip is painted into the other, so the panel never shows a half
+//   erased frame and the CPU does not wait for SPI
+// - The mode's paint function draws the whole scene into each strip, with
+//   the strip's screen position as the origin; the sprite clips the rest
+// - Only strips touched by invalidate() since the last render() are painted
+//   and pushed, so a few moving balls cost a few strips, not the whole area
+// - Without DMA the strips are pushed blocking; without the RAM for them
+//   render() paints straight to the panel, as the modes did before
+// - ILI9488 panels take 18-bit pixels over SPI. TFT_eSPI converts them in
+//   pushImage() but sends a DMA buffer as it is, so there the strips are
+//   always pushed blocking
+// One play area at a time; drawMenu() calls end() to give the RAM back.
+// Loop task only.
+
+#define PLAY_AREA_STRIP_BYTES 12288  // Per sprite; two are allocated
+
+#if defined(ILI9488_DRIVER)
+#define PLAY_AREA_USE_DMA 0  // 18-bit panel: DMA would show wrong colours
+#else
+#define PLAY_AREA_USE_DMA 1
+#endif
+#define PLAY_AREA_MAX_STRIPS 32
+
+// Paints the scene; screen point (x, y) goes to (x - ox, y - oy) on gfx
+typedef void (*PlayAreaPaintFunction)(TFT_eSPI& gfx, int16_t ox, int16_t oy);
+
+class PlayAreaRenderer {
+public:
+  // Keeps the sprites when the area and its size did not change
+  static void begin(int x, int y, int w, int h, PlayAreaPaintFunction paint, uint16_t background = THEME_BG);
+  static void end();
+
+  static void invalidate(int x, int y, int w, int h);  // Screen coordinates
+  static void invalidateAll();
+  static void render();
+
+  static bool isBuffered() { return buffered; }  // false: painting to the panel
+  static bool usesDMA() { return dmaReady; }
+
+private:
+  static TFT_eSprite strips[2];
+  static PlayAreaPaintFunction paint;
+  static int16_t areaX, areaY, areaW, areaH;
+  static int16_t stripH;
+  static uint8_t stripCount;
+  static bool buffered;  // false when the sprites could not be allocated
+  static uint32_t dirty;  // Bit per strip
+  static uint16_t background;
+  static bool dmaReady;
+
+  static void renderDirect();
+};
+
+#endif // PLAY_AREA_RENDERER_H
@@ -60,7 +60,7 @@ void initializeRagaMode() {
   raga.playing = false;
   raga.droneEnabled = false;
   raga.currentStep = 0;
-  raga.lastNoteTime = 0;
+  raga.nextNoteUs = 0;
   raga.currentNote = -1;
   raga.octaveRange = 2;
   
@@ -183,7 +183,7 @@ void drawRagaMode() {
   drawRoundButton(btn4X, raga.ctrlY, raga.ctrlW, raga.ctrlH, "ROOT+", THEME_ACCENT, btn4Pressed);
 }
 
-void playRagaNote(uint8_t scaleIndex, bool slide) {
+void playRagaNote(uint8_t scaleIndex, bool slide, uint32_t noteTimeUs, uint32_t lengthUs) {
   const RagaScale& current = ragaScales[raga.currentRaga];
   
   if (scaleIndex >= current.numNotes || current.notes[scaleIndex] == 255) return;
@@ -191,36 +191,25 @@ void playRagaNote(uint8_t scaleIndex, bool slide) {
   // Calculate MIDI note
   uint8_t note = raga.rootNote + current.notes[scaleIndex];
   
-  // Apply microtonal adjustment using pitch bend
-  int16_t cents = current.microtonalCents[scaleIndex];
-  if (cents != 0) {
-    // MIDI pitch bend: 8192 = center, ±8191 range
-    // ±2 semitones = ±200 cents typical
-    int16_t bendValue = 8192 + (cents * 8192 / 200);
-    bendValue = constrain(bendValue, 0, 16383);
-    
-    // Send pitch bend (14-bit value)
-    sendPitchBend(bendValue);
-  }
-  
-  // If sliding, send gradual pitch bend from previous note
+  // If sliding, glide the pitch wheel into the new note over the 40ms before it
   if (slide && raga.currentNote >= 0) {
-    // Quick slide effect
     for (int i = 0; i < 5; i++) {
-      int16_t slideValue = 8192 + ((i - 2) * 400);
-      slideValue = constrain(slideValue, 0, 16383);
-      sendPitchBend(slideValue);
-      delay(10);
+      int16_t slideValue = (i - 2) * 400;  // Signed, the MIDI thread centers it
+      MIDIThread::schedulePitchBend(slideValue, noteTimeUs - (4 - i) * 10000);
     }
   }
   
-  // Stop previous note
-  if (raga.currentNote >= 0) {
-    sendNoteOff(raga.currentNote);
+  // Apply microtonal adjustment using pitch bend (re-center after a slide)
+  int16_t cents = current.microtonalCents[scaleIndex];
+  if (cents != 0 || slide) {
+    // ±2 semitones = ±200 cents typical
+    int16_t bendValue = cents * 8192 / 200;
+    bendValue = constrain(bendValue, -8192, 8191);
+    MIDIThread::schedulePitchBend(bendValue, noteTimeUs);
   }
   
-  // Play new note
-  sendNoteOn(note, 100);
+  // Play new note legato - it ends as the next one starts
+  scheduleNote(note, 100, noteTimeUs, lengthUs);
   raga.currentNote = note;
 }
 
@@ -238,24 +227,23 @@ void stopDrone() {
 }
 
 void handleRagaMode() {
-  updateTouch();
+  // Touch state for this frame was taken by loop()
   
   // Handle automatic phrase playback
   if (raga.playing) {
-    unsigned long now = millis();
     // Map tempo (0-255) to BPM (40-200), then calculate note delay
     int bpm = 40 + ((raga.tempo * 160) / 255);
-    // At 120 BPM, notes play every 500ms (8th notes)
-    unsigned long noteDelay = (60000 / bpm) / 2; // Half beat = 8th note
+    // At 120 BPM, notes play every 250ms (8th notes)
+    uint32_t noteDelay = (60000000UL / bpm) / 2; // Half beat = 8th note
+    uint32_t noteTime;
     
-    if (now - raga.lastNoteTime >= noteDelay) {
-      raga.lastNoteTime = now;
+    if (takeScheduledStep(raga.nextNoteUs, noteDelay, noteTime)) {
       
       const RagaScale& current = ragaScales[raga.currentRaga];
       
       // Simple ascending/descending pattern with occasional slides
       bool slide = (random(100) < 30); // 30% chance of slide
-      playRagaNote(raga.currentStep, slide);
+      playRagaNote(raga.currentStep, slide, noteTime, noteDelay);
       
       // Move to next note in scale
       if (random(100) < 70) {
@@ -276,6 +264,7 @@ void handleRagaMode() {
       if (raga.playing) {
         raga.playing = false;
         if (raga.currentNote >= 0) {
+          MIDIThread::cancelScheduled();
           sendNoteOff(raga.currentNote);
           raga.currentNote = -1;
         }
@@ -284,7 +273,7 @@ void handleRagaMode() {
         stopDrone();
         raga.droneEnabled = false;
       }
-      sendPitchBend(8192);
+      sendPitchBend(0);  // Center
       exitToMenu();
       return;
     }
@@ -301,10 +290,11 @@ void handleRagaMode() {
         raga.currentRaga = (RagaType)i;
         raga.currentStep = 0;
         if (raga.currentNote >= 0) {
+          MIDIThread::cancelScheduled();
           sendNoteOff(raga.currentNote);
           raga.currentNote = -1;
         }
-        sendPitchBend(8192);
+        sendPitchBend(0);  // Center
         drawRagaMode();
         return;
       }
@@ -332,13 +322,14 @@ void handleRagaMode() {
       raga.playing = !raga.playing;
       if (raga.playing) {
         raga.currentStep = 0;
-        raga.lastNoteTime = millis();
+        raga.nextNoteUs = micros();
       } else {
         if (raga.currentNote >= 0) {
+          MIDIThread::cancelScheduled();
           sendNoteOff(raga.currentNote);
           raga.currentNote = -1;
         }
-        sendPitchBend(8192);
+        sendPitchBend(0);  // Center
       }
       drawRagaMode();
       return;
@@ -45,7 +45,7 @@ struct RagaState {
   bool droneEnabled;
   uint8_t tempo;         // Delay between notes (0-255)
   uint8_t currentStep;
-  unsigned long lastNoteTime;
+  uint32_t nextNoteUs;   // micros() due time of the next phrase note
   int8_t currentNote;    // Current playing note
   uint8_t octaveRange;   // 1-3 octaves
   
@@ -63,7 +63,7 @@ extern const RagaScale ragaScales[RAGA_COUNT];
 void initializeRagaMode();
 void drawRagaMode();
 void handleRagaMode();
-void playRagaNote(uint8_t scaleIndex, bool slide);
+void playRagaNote(uint8_t scaleIndex, bool slide, uint32_t noteTimeUs, uint32_t lengthUs);
 void startDrone();
 void stopDrone();
 
@@ -4,6 +4,7 @@
 #include "common_definitions.h"
 #include "ui_elements.h"
 #include "midi_utils.h"
+#include "generator_runtime.h"
 
 // Random Generator mode variables
 struct RandomGen {
@@ -12,15 +13,15 @@ struct RandomGen {
   int minOctave = 3;
   int maxOctave = 6;
   int probability = 50; // 0-100%
-  int bpm = 120; // BPM instead of interval
   int subdivision = 4; // 4=quarter, 8=eighth, 16=sixteenth
-  bool isPlaying = false;
-  unsigned long lastNoteTime = 0;
-  unsigned long nextNoteTime = 0;
-  int currentNote = -1;
-  unsigned long noteInterval = 500; // Calculated from BPM
+  volatile int currentNote = -1;
+  int8_t transportId = -1;  // Transport subscription
+  volatile bool needsRedraw = false;  // Set by the transport, cleared by the redraw
 };
 
+// Transport ticks per note for a subdivision of the bar
+#define RANDOM_TICKS_PER_NOTE(subdivision) (TRANSPORT_PPQN * 4 / (subdivision))
+
 RandomGen randomGen;
 
 // Function declarations
@@ -28,9 +29,13 @@ void initializeRandomGeneratorMode();
 void drawRandomGeneratorMode();
 void handleRandomGeneratorMode();
 void drawRandomGenControls();
-void updateRandomGenerator();
-void playRandomNote();
-void calculateNoteInterval();
+void playRandomNote(uint32_t noteTimeUs, uint32_t lengthUs);
+
+// Transport step (MIDI task): one note per subdivision
+static void randomGenStep(const TransportTick& tick, void*) {
+  if (!GeneratorRuntime::isPlaying(ENGINE_RNG) || !globalState.bleConnected) return;
+  playRandomNote(tick.timeUs, tick.stepUs);
+}
 
 // Implementations
 void initializeRandomGeneratorMode() {
@@ -39,12 +44,11 @@ void initializeRandomGeneratorMode() {
   randomGen.minOctave = 3;
   randomGen.maxOctave = 6;
   randomGen.probability = 50;
-  randomGen.bpm = 120;
   randomGen.subdivision = 4;
-  randomGen.isPlaying = false;
   randomGen.currentNote = -1;
-  calculateNoteInterval();
-  randomGen.nextNoteTime = millis() + randomGen.noteInterval;
+  randomGen.needsRedraw = false;
+  randomGen.transportId = GeneratorRuntime::attach(ENGINE_RNG, randomGenStep,
+                                                   RANDOM_TICKS_PER_NOTE(randomGen.subdivision));
   
   drawRandomGeneratorMode();
 }
@@ -62,8 +66,8 @@ void drawRandomGenControls() {
   int spacing = 5;
   
   // Play/Stop and Root note on same line
-  drawRoundButton(10, y, 60, btnHeight, randomGen.isPlaying ? "STOP" : "PLAY", 
-                 randomGen.isPlaying ? THEME_ERROR : THEME_SUCCESS);
+  drawRoundButton(10, y, 60, btnHeight, GeneratorRuntime::isPlaying(ENGINE_RNG) ? "STOP" : "PLAY", 
+                 GeneratorRuntime::isPlaying(ENGINE_RNG) ? THEME_ERROR : THEME_SUCCESS);
   
   tft.setTextColor(THEME_TEXT, THEME_BG);
   tft.drawString("Key:", 80, y + 15, 1);
@@ -107,7 +111,7 @@ void drawRandomGenControls() {
   
   // BPM and subdivision controls
   tft.drawString("BPM:", 10, y + 15, 1);
-  tft.drawString(String(randomGen.bpm), 45, y + 15, 1);
+  tft.drawString(String((int)globalState.bpm), 45, y + 15, 1);
   drawRoundButton(75, y, 45, btnHeight, "-", THEME_SECONDARY);
   drawRoundButton(125, y, 45, btnHeight, "+", THEME_SECONDARY);
   
@@ -133,6 +137,12 @@ void drawRandomGenControls() {
 }
 
 void handleRandomGeneratorMode() {
+  // Notes are played by the transport; show what it changed
+  if (randomGen.needsRedraw) {
+    randomGen.needsRedraw = false;
+    drawRandomGenControls();
+  }
+  
   // Back button - larger touch area
   if (touch.justPressed && isButtonPressed(BACK_BTN_X, BACK_BTN_Y, BTN_BACK_W, BTN_BACK_H)) {
     exitToMenu();
@@ -168,8 +178,8 @@ void handleRandomGeneratorMode() {
   bool anyPressed = playPressed || keyUpPressed || keyDownPressed || scalePressed || minOctDownPressed || minOctUpPressed || maxOctDownPressed || maxOctUpPressed || probDownPressed || probUpPressed || bpmDownPressed || bpmUpPressed || subdivLeftPressed || subdivRightPressed;
   
   if (anyPressed) {
-    drawRoundButton(10, y1, 60, 25, randomGen.isPlaying ? "STOP" : "PLAY", 
-                   randomGen.isPlaying ? THEME_ERROR : THEME_SUCCESS, playPressed);
+    drawRoundButton(10, y1, 60, 25, GeneratorRuntime::isPlaying(ENGINE_RNG) ? "STOP" : "PLAY", 
+                   GeneratorRuntime::isPlaying(ENGINE_RNG) ? THEME_ERROR : THEME_SUCCESS, playPressed);
     
     String rootName = getNoteNameFromMIDI(randomGen.rootNote);
     drawRoundButton(110, y1, 35, 25, rootName, THEME_PRIMARY, false);
@@ -198,13 +208,8 @@ void handleRandomGeneratorMode() {
     
     // Play/Stop and Root note controls
     if (isButtonPressed(10, y, 60, btnHeight)) {
-      randomGen.isPlaying = !randomGen.isPlaying;
-      if (randomGen.isPlaying) {
-        randomGen.nextNoteTime = millis() + randomGen.noteInterval;
-      } else if (randomGen.currentNote != -1) {
-        sendNoteOff(randomGen.currentNote);
-        randomGen.currentNote = -1;
-      }
+      // The last note's own note-off is already scheduled
+      GeneratorRuntime::setPlaying(ENGINE_RNG, !GeneratorRuntime::isPlaying(ENGINE_RNG));
       drawRandomGenControls();
       return;
     }
@@ -275,14 +280,12 @@ void handleRandomGeneratorMode() {
     
     // BPM controls
     if (isButtonPressed(75, y, 45, btnHeight)) {
-      randomGen.bpm = max(60, randomGen.bpm - 5);
-      calculateNoteInterval();
+      setBPM(max(60.0f, globalState.bpm - 5));
       drawRandomGenControls();
       return;
     }
     if (isButtonPressed(125, y, 45, btnHeight)) {
-      randomGen.bpm = min(200, randomGen.bpm + 5);
-      calculateNoteInterval();
+      setBPM(min(200.0f, globalState.bpm + 5));
       drawRandomGenControls();
       return;
     }
@@ -291,40 +294,24 @@ void handleRandomGeneratorMode() {
     if (isButtonPressed(260, y, 45, btnHeight)) {
       if (randomGen.subdivision == 16) randomGen.subdivision = 8;
       else if (randomGen.subdivision == 8) randomGen.subdivision = 4;
-      calculateNoteInterval();
+      Transport::setDivision(randomGen.transportId, RANDOM_TICKS_PER_NOTE(randomGen.subdivision));
       drawRandomGenControls();
       return;
     }
     if (isButtonPressed(310, y, 45, btnHeight)) {
       if (randomGen.subdivision == 4) randomGen.subdivision = 8;
       else if (randomGen.subdivision == 8) randomGen.subdivision = 16;
-      calculateNoteInterval();
+      Transport::setDivision(randomGen.transportId, RANDOM_TICKS_PER_NOTE(randomGen.subdivision));
       drawRandomGenControls();
       return;
     }
   }
-  
-  // Update random generator
-  updateRandomGenerator();
 }
 
-void updateRandomGenerator() {
-  if (!randomGen.isPlaying || !globalState.bleConnected) return;
-  
-  unsigned long now = millis();
-  
-  if (now >= randomGen.nextNoteTime) {
-    playRandomNote();
-    randomGen.nextNoteTime = now + randomGen.noteInterval;
-  }
-}
-
-void playRandomNote() {
-  // Stop current note if playing
-  if (randomGen.currentNote != -1) {
-    sendNoteOff(randomGen.currentNote);
-    randomGen.currentNote = -1;
-  }
+// Each note lasts until the next step; its note-off is queued ahead of the
+// next note-on at the same instant
+void playRandomNote(uint32_t noteTimeUs, uint32_t lengthUs) {
+  randomGen.currentNote = -1;
   
   // Check probability
   if (random(100) < randomGen.probability) {
@@ -335,23 +322,13 @@ void playRandomNote() {
     int note = randomGen.rootNote % 12 + scale.intervals[degree] + (octave * 12);
     
     if (note >= 0 && note <= 127) {
-      sendNoteOn(note, 100);
+      scheduleNote(note, 100, noteTimeUs, lengthUs);
       randomGen.currentNote = note;
       
-      Serial.printf("Random note: %s (prob: %d%%)\n", 
-                   getNoteNameFromMIDI(note).c_str(), randomGen.probability);
-      
-      // Update display
-      drawRandomGenControls();
+      // Update display (from the loop)
+      randomGen.needsRedraw = true;
     }
   }
 }
 
-void calculateNoteInterval() {
-  // Calculate note interval from BPM and subdivision
-  float beatsPerSecond = randomGen.bpm / 60.0;
-  float notesPerSecond = beatsPerSecond * (randomGen.subdivision / 4.0);
-  randomGen.noteInterval = 1000.0 / notesPerSecond;
-}
-
 #endif
\ No newline at end of file
@@ -4,16 +4,27 @@
 #include "common_definitions.h"
 #include "ui_elements.h"
 #include "midi_utils.h"
+#include "generator_runtime.h"
+#include "ui_compositor.h"
+#include "step_grid.h"
 
 // Sequencer mode variables
 #define SEQ_STEPS 16
 #define SEQ_TRACKS 4
 bool sequencePattern[SEQ_TRACKS][SEQ_STEPS];
-int currentStep = 0;
-unsigned long lastStepTime = 0;
-unsigned long noteOffTime[SEQ_TRACKS] = {0};
-int stepInterval;
-bool sequencerPlaying = false;
+volatile int currentStep = 0;
+volatile bool seqStepChanged = false;     // Set by the transport, cleared by the redraw
+bool seqEngineReady = false;              // Pattern kept (and playing) across visits
+
+// 808-style track labels and colors
+const char* const seqTrackLabels[SEQ_TRACKS] = {"KICK", "SNRE", "HHAT", "OPEN"};
+const uint16_t seqTrackColors[SEQ_TRACKS] = {THEME_ERROR, THEME_WARNING, THEME_PRIMARY, THEME_ACCENT};
+
+// What each grid cell shows, as last painted
+#define SEQ_CELL_ON 1
+#define SEQ_CELL_PLAYHEAD 2
+void paintSequencerCell(uint8_t track, uint8_t step, uint8_t state);
+StepGrid<SEQ_TRACKS, SEQ_STEPS> seqGrid(paintSequencerCell);
 
 // Control buttons
 Button seqBtnPlayStop;
@@ -22,27 +33,46 @@ Button seqBtnBpmDown;
 Button seqBtnBpmUp;
 Button seqBtnMenu;
 
+// Compositor layers of the screen, registered by drawSequencerMode()
+int8_t seqLayerHeader = -1;
+int8_t seqLayerBpm = -1;
+
 // Function declarations
 void initializeSequencerMode();
 void drawSequencerMode();
 void handleSequencerMode();
 void drawSequencerGrid();
+void updateSequencerGrid();
+void drawSequencerControls();
+void drawSequencerBPM();
 void toggleSequencerStep(int track, int step);
-void updateSequencer();
-void playSequencerStep();
+void playSequencerStep(uint32_t stepTimeUs);
+
+// Transport step (MIDI task): one 16th note. While PLAY is on the pattern
+// also follows an external master's Start/Stop.
+void sequencerStep(const TransportTick& tick, void*) {
+  if (!GeneratorRuntime::isPlaying(ENGINE_BEATS)) return;
+  
+  currentStep = tick.step % SEQ_STEPS;
+  playSequencerStep(tick.timeUs);
+  seqStepChanged = true;
+}
 
 // Implementations
 void initializeSequencerMode() {
-  stepInterval = 60000 / (int)globalState.bpm / 4; // 16th notes
-  sequencerPlaying = false;
-  currentStep = 0;
-  
-  // Clear all patterns
-  for (int t = 0; t < SEQ_TRACKS; t++) {
-    for (int s = 0; s < SEQ_STEPS; s++) {
-      sequencePattern[t][s] = false;
+  // Start from an empty pattern only the first time; after that the
+  // pattern (and its playback) carries on while other screens are open
+  if (!seqEngineReady) {
+    currentStep = 0;
+    for (int t = 0; t < SEQ_TRACKS; t++) {
+      for (int s = 0; s < SEQ_STEPS; s++) {
+        sequencePattern[t][s] = false;
+      }
     }
+    GeneratorRuntime::attach(ENGINE_BEATS, sequencerStep, TRANSPORT_16TH);
+    seqEngineReady = true;
   }
+  seqStepChanged = false;
   
   // Calculate control button layout from screen dimensions
   int btnY = SCREEN_HEIGHT - 60;
@@ -52,8 +82,8 @@ void initializeSequencerMode() {
   
   // Initialize control buttons with calculated positioning
   seqBtnPlayStop.setBounds(btnSpacing, btnY, btn1W, btnH);
-  seqBtnPlayStop.setText(sequencerPlaying ? "STOP" : "PLAY");
-  seqBtnPlayStop.setColor(sequencerPlaying ? THEME_ERROR : THEME_SUCCESS);
+  seqBtnPlayStop.setText(GeneratorRuntime::isPlaying(ENGINE_BEATS) ? "STOP" : "PLAY");
+  seqBtnPlayStop.setColor(GeneratorRuntime::isPlaying(ENGINE_BEATS) ? THEME_ERROR : THEME_SUCCESS);
   
   seqBtnClear.setBounds(btnSpacing * 2 + btn1W, btnY, btn1W, btnH);
   seqBtnClear.setText("CLEAR");
@@ -74,30 +104,43 @@ void initializeSequencerMode() {
   drawSequencerMode();
 }
 
+static void drawSequencerHeader() {
+  drawModuleHeader("BEATS");  // Unified header with status icons
+}
+
 void drawSequencerMode() {
   tft.fillScreen(THEME_BG);
-  
-  // Use unified header with status icons
-  drawModuleHeader("BEATS");
-  
+  drawSequencerHeader();
   drawSequencerGrid();
+  drawSequencerControls();
+  drawSequencerBPM();
   
-  // Calculate button layout from screen dimensions
+  // Later changes repaint only their part of the screen
+  int gridY = CONTENT_TOP + 5;
   int btnY = SCREEN_HEIGHT - 60;
-  int btnH = 45;
-  int btnSpacing = 10;
-  int btn1W = (SCREEN_WIDTH - (6 * btnSpacing)) / 5;
-  
-  // Transport controls - draw buttons with initial state
-  seqBtnPlayStop.setText(sequencerPlaying ? "STOP" : "PLAY");
-  seqBtnPlayStop.setColor(sequencerPlaying ? THEME_ERROR : THEME_SUCCESS);
+  UICompositor::reset();
+  seqLayerHeader = UICompositor::addLayer(0, 0, SCREEN_WIDTH, CONTENT_TOP, drawSequencerHeader);
+  UICompositor::addLayer(0, gridY - 1, SCREEN_WIDTH, btnY - gridY, drawSequencerGrid);
+  UICompositor::addLayer(0, btnY, SCREEN_WIDTH, SCREEN_HEIGHT - btnY, drawSequencerControls);
+  seqLayerBpm = UICompositor::addLayer(0, btnY + 15, SCREEN_WIDTH, 16, drawSequencerBPM);
+}
+
+void drawSequencerControls() {
+  // Transport controls - draw buttons with the current state
+  seqBtnPlayStop.setText(GeneratorRuntime::isPlaying(ENGINE_BEATS) ? "STOP" : "PLAY");
+  seqBtnPlayStop.setColor(GeneratorRuntime::isPlaying(ENGINE_BEATS) ? THEME_ERROR : THEME_SUCCESS);
   seqBtnPlayStop.draw(true);
   seqBtnClear.draw(true);
   seqBtnBpmDown.draw(true);
   seqBtnBpmUp.draw(true);
   seqBtnMenu.draw(true);
-  
+}
+
+void drawSequencerBPM() {
   // BPM display - positioned to the right of buttons
+  int btnY = SCREEN_HEIGHT - 60;
+  int btnSpacing = 10;
+  int btn1W = (SCREEN_WIDTH - (6 * btnSpacing)) / 5;
   tft.setTextColor(THEME_TEXT, THEME_BG);
   int bpmX = btnSpacing * 5 + btn1W * 4 + 20;
   if (midiClock.isReceiving) {
@@ -107,8 +150,8 @@ void drawSequencerMode() {
   }
 }
 
-void drawSequencerGrid() {
-  // Calculate grid layout from screen dimensions
+// Grid layout calculated from screen dimensions
+void sequencerCellRect(int track, int step, int& x, int& y, int& w, int& h) {
   int gridSpacing = 10;
   int gridX = gridSpacing;
   int gridY = CONTENT_TOP + 5;
@@ -118,52 +161,72 @@ void drawSequencerGrid() {
   // Calculate cell size to fill available space
   int labelWidth = 35;
   int cellSpacing = 2;
-  int cellW = (availableWidth - labelWidth - (SEQ_STEPS + 1) * cellSpacing) / SEQ_STEPS;
-  int cellH = (availableHeight - (SEQ_TRACKS + 1) * cellSpacing) / SEQ_TRACKS;
-  
-  // 808-style track labels and colors
-  String trackLabels[] = {"KICK", "SNRE", "HHAT", "OPEN"};
-  uint16_t trackColors[] = {THEME_ERROR, THEME_WARNING, THEME_PRIMARY, THEME_ACCENT};
+  w = (availableWidth - labelWidth - (SEQ_STEPS + 1) * cellSpacing) / SEQ_STEPS;
+  h = (availableHeight - (SEQ_TRACKS + 1) * cellSpacing) / SEQ_TRACKS;
+  x = gridX + labelWidth + step * (w + cellSpacing);
+  y = gridY + track * (h + cellSpacing);
+}
+
+void drawSequencerGrid() {
+  // Track name with color coding
+  for (int track = 0; track < SEQ_TRACKS; track++) {
+    int x, y, w, h;
+    sequencerCellRect(track, 0, x, y, w, h);
+    tft.setTextColor(seqTrackColors[track], THEME_BG);
+    tft.drawString(seqTrackLabels[track], 10, y + h/2 - 6, 1);
+  }
   
+  seqGrid.invalidate();
+  updateSequencerGrid();
+}
+
+// Repaints the cells whose step or playhead changed
+void updateSequencerGrid() {
+  bool playing = GeneratorRuntime::isPlaying(ENGINE_BEATS);
+  int playhead = currentStep;
   for (int track = 0; track < SEQ_TRACKS; track++) {
-    int y = gridY + track * (cellH + cellSpacing);
-    
-    // Track name with color coding
-    tft.setTextColor(trackColors[track], THEME_BG);
-    tft.drawString(trackLabels[track], gridX, y + cellH/2 - 6, 1);
-    
-    // Steps - 16 steps in 808 style
     for (int step = 0; step < SEQ_STEPS; step++) {
-      int x = gridX + labelWidth + step * (cellW + cellSpacing);
-      
-      bool active = sequencePattern[track][step];
-      bool current = (sequencerPlaying && step == currentStep);
-      
-      uint16_t color;
-      if (current && active) color = THEME_TEXT;
-      else if (current) color = trackColors[track];
-      else if (active) color = trackColors[track];
-      else color = THEME_SURFACE;
-      
-      // Highlight every 4th step (like 808)
-      if (step % 4 == 0) {
-        tft.drawRect(x-1, y-1, cellW+2, cellH+2, THEME_TEXT_DIM);
-      }
-      
-      tft.fillRect(x, y, cellW, cellH, color);
-      tft.drawRect(x, y, cellW, cellH, THEME_TEXT_DIM);
+      uint8_t state = sequencePattern[track][step] ? SEQ_CELL_ON : 0;
+      if (playing && step == playhead) state |= SEQ_CELL_PLAYHEAD;
+      seqGrid.set(track, step, state);
     }
   }
 }
 
+void paintSequencerCell(uint8_t track, uint8_t step, uint8_t state) {
+  int x, y, cellW, cellH;
+  sequencerCellRect(track, step, x, y, cellW, cellH);
+  bool active = state & SEQ_CELL_ON;
+  bool current = state & SEQ_CELL_PLAYHEAD;
+  
+  uint16_t color;
+  if (current && active) color = THEME_TEXT;
+  else if (current) color = seqTrackColors[track];
+  else if (active) color = seqTrackColors[track];
+  else color = THEME_SURFACE;
+  
+  // Highlight every 4th step (like 808)
+  if (step % 4 == 0) {
+    tft.drawRect(x-1, y-1, cellW+2, cellH+2, THEME_TEXT_DIM);
+  }
+  
+  tft.fillRect(x, y, cellW, cellH, color);
+  tft.drawRect(x, y, cellW, cellH, THEME_TEXT_DIM);
+}
+
 void handleSequencerMode() {
   // Back button - larger touch area
   if (touch.justPressed && isButtonPressed(BACK_BTN_X, BACK_BTN_Y, BTN_BACK_W, BTN_BACK_H)) {
-    sequencerPlaying = false;
     exitToMenu();
     return;
   }
   
+  // Steps are played by the transport; redraw what it changed
+  if (seqStepChanged) {
+    seqStepChanged = false;
+    updateSequencerGrid();  // Old and new playhead columns
+  }
+  
   // Calculate button layout from screen dimensions
   int btnY = SCREEN_HEIGHT - 60;
   int btnH = 45;
@@ -181,12 +244,9 @@ void handleSequencerMode() {
   if (touch.justPressed) {
     // Transport controls
     if (isButtonPressed(btnSpacing, btnY, btn1W, btnH)) {
-      sequencerPlaying = !sequencerPlaying;
-      if (sequencerPlaying) {
-        currentStep = 0;
-        lastStepTime = millis();
-      }
-      drawSequencerMode();
+      GeneratorRuntime::setPlaying(ENGINE_BEATS, !GeneratorRuntime::isPlaying(ENGINE_BEATS));
+      UICompositor::invalidate(btnSpacing, btnY, btn1W, btnH);  // PLAY/STOP
+      updateSequencerGrid();                                      // Playhead
       return;
     }
     
@@ -197,112 +257,55 @@ void handleSequencerMode() {
           sequencePattern[t][s] = false;
         }
       }
-      drawSequencerGrid();
+      updateSequencerGrid();
       return;
     }
     
     if (isButtonPressed(btnSpacing * 3 + btn1W * 2, btnY, btn1W, btnH)) {
       float newBpm = max(60.0f, globalState.bpm - 1.0f);
       setBPM(newBpm);
-      stepInterval = 60000 / (int)globalState.bpm / 4;
-      drawSequencerMode();
+      UICompositor::invalidateLayer(seqLayerHeader);  // BPM indicator
+      UICompositor::invalidateLayer(seqLayerBpm);
       return;
     }
     
     if (isButtonPressed(btnSpacing * 4 + btn1W * 3, btnY, btn1W, btnH)) {
       float newBpm = min(200.0f, globalState.bpm + 1.0f);
       setBPM(newBpm);
-      stepInterval = 60000 / (int)globalState.bpm / 4;
-      drawSequencerMode();
+      UICompositor::invalidateLayer(seqLayerHeader);  // BPM indicator
+      UICompositor::invalidateLayer(seqLayerBpm);
       return;
     }
     
-    // Grid interaction - recalculate grid layout
-    int gridSpacing = 10;
-    int gridX = gridSpacing;
-    int gridY = CONTENT_TOP + 5;
-    int availableWidth = SCREEN_WIDTH - (2 * gridSpacing);
-    int availableHeight = SCREEN_HEIGHT - gridY - 80;
-    int labelWidth = 35;
-    int cellSpacing = 2;
-    int cellW = (availableWidth - labelWidth - (SEQ_STEPS + 1) * cellSpacing) / SEQ_STEPS;
-    int cellH = (availableHeight - (SEQ_TRACKS + 1) * cellSpacing) / SEQ_TRACKS;
-    
+    // Grid interaction
     for (int track = 0; track < SEQ_TRACKS; track++) {
       for (int step = 0; step < SEQ_STEPS; step++) {
-        int x = gridX + labelWidth + step * (cellW + cellSpacing);
-        int y = gridY + track * (cellH + cellSpacing);
+        int x, y, cellW, cellH;
+        sequencerCellRect(track, step, x, y, cellW, cellH);
         
         if (isButtonPressed(x, y, cellW, cellH)) {
           toggleSequencerStep(track, step);
-          drawSequencerGrid();
+          updateSequencerGrid();
           return;
         }
       }
     }
   }
-  
-  // Update sequencer timing
-  updateSequencer();
 }
 
 void toggleSequencerStep(int track, int step) {
   sequencePattern[track][step] = !sequencePattern[track][step];
 }
 
-void updateSequencer() {
-  if (!sequencerPlaying) return;
-  
-  unsigned long now = millis();
-  
-  // Check for notes to turn off
-  int drumNotes[] = {36, 38, 42, 46};
-  for (int track = 0; track < SEQ_TRACKS; track++) {
-    if (noteOffTime[track] > 0 && now >= noteOffTime[track]) {
-      sendNoteOff(drumNotes[track]);
-      noteOffTime[track] = 0;
-    }
-  }
-  
-  // Use MIDI clock if available, otherwise use internal timing
-  unsigned long effectiveInterval;
-  if (midiClock.isReceiving && midiClock.clockInterval > 0) {
-    // MIDI clock is 24 ppqn, we want 16th notes (4 per quarter note)
-    // So 6 clock pulses per 16th note
-    effectiveInterval = midiClock.clockInterval * 6;
-    
-    // Auto-start on MIDI start message
-    if (midiClock.isPlaying && !sequencerPlaying) {
-      sequencerPlaying = true;
-      currentStep = 0;
-      lastStepTime = now;
-    }
-  } else {
-    effectiveInterval = stepInterval;
-  }
-  
-  if (now - lastStepTime >= effectiveInterval) {
-    playSequencerStep();
-    currentStep = (currentStep + 1) % SEQ_STEPS;
-    lastStepTime = now;
-    drawSequencerGrid();
-  }
-}
-
-void playSequencerStep() {
+void playSequencerStep(uint32_t stepTimeUs) {
   if (!globalState.bleConnected) return;
   
   int drumNotes[] = {36, 38, 42, 46}; // Kick, Snare, Hi-hat, Open Hi-hat
-  int noteLengths[] = {200, 150, 50, 300}; // Note lengths in ms
-  
-  unsigned long now = millis();
+  uint32_t noteLengths[] = {200000, 150000, 50000, 300000}; // Note lengths in us
   
   for (int track = 0; track < SEQ_TRACKS; track++) {
     if (sequencePattern[track][currentStep]) {
-      // Turn on note
-      sendNoteOn(drumNotes[track], 100);
-      // Schedule note off
-      noteOffTime[track] = now + noteLengths[track];
+      scheduleNote(drumNotes[track], 100, stepTimeUs, noteLengths[track]);
     }
   }
 }
@@ -0,0 +1,78 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Lock-free single-producer/single-consumer ring buffer
+// - push() may only be called from one task, pop() from one other task
+// - Both are wait-free: no kernel calls, no critical sections
+// - Capacity N must be a power of two; indices run free and wrap naturally
+// - Overflowing pushes are dropped and counted, never block the producer
+//
+// Plain C++11 (no FreeRTOS), so it builds and runs on the host as well.
+
+#ifndef SPSC_CACHE_LINE
+#define SPSC_CACHE_LINE 64
+#endif
+
+template <typename T, size_t N>
+class SPSCQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SPSCQueue capacity must be a power of two");
+
+public:
+  SPSCQueue() : head(0), tail(0), drops(0), highWater(0) {}
+
+  // Producer side
+  bool push(const T& item) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    uint32_t used = h - tail.load(std::memory_order_acquire);
+    if (used >= N) {
+      drops.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    slots[h & (N - 1)] = item;
+    head.store(h + 1, std::memory_order_release);
+
+    if (used + 1 > highWater.load(std::memory_order_relaxed)) {
+      highWater.store(used + 1, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  // Consumer side
+  bool pop(T& item) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return false;
+    item = slots[t & (N - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Either side (approximate while the other side is running)
+  size_t size() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+  bool isEmpty() const { return size() == 0; }
+  static constexpr size_t capacity() { return N; }
+
+  // Statistics
+  uint32_t dropCount() const { return drops.load(std::memory_order_relaxed); }
+  uint32_t highWaterMark() const { return highWater.load(std::memory_order_relaxed); }
+  void resetStats() {
+    drops.store(0, std::memory_order_relaxed);
+    highWater.store(0, std::memory_order_relaxed);
+  }
+
+private:
+  // Producer and consumer indices live on separate cache lines so the two
+  // cores do not invalidate each other on every operation
+  alignas(SPSC_CACHE_LINE) std::atomic<uint32_t> head;
+  alignas(SPSC_CACHE_LINE) std::atomic<uint32_t> tail;
+  alignas(SPSC_CACHE_LINE) T slots[N];
+  std::atomic<uint32_t> drops;
+  std::atomic<uint32_t> highWater;
+};
+
+#endif // SPSC_QUEUE_H
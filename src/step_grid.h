@@ -0,0 +1,53 @@
+#ifndef STEP_GRID_H
+#define STEP_GRID_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Remembers what each cell of a step display last looked like, so a
+// playhead move or a toggled step repaints only the cells that changed
+// - The mode reduces a cell to a small state code (on, playhead, accent...)
+//   and calls set() for every cell each time it redraws; set() calls the
+//   painter only when the code differs from the one last painted
+// - invalidate() forgets everything, after the cells were wiped (full draw,
+//   compositor repaint), so the next pass paints them all
+// - Rows and columns are the mode's own: tracks and steps (BEATS), one row
+//   of steps (TB-3PO), voices and ring positions (EUCLIDEAN)
+//
+// Plain C++ (no Arduino), so it can be checked on the host.
+
+#define STEP_CELL_UNKNOWN 0xFF  // Never a state code
+
+template <uint8_t ROWS, uint8_t COLS>
+class StepGrid {
+public:
+  typedef void (*Painter)(uint8_t row, uint8_t col, uint8_t state);
+
+  explicit StepGrid(Painter paint) : paint(paint), painted(0) { invalidate(); }
+
+  void invalidate() { memset(cells, STEP_CELL_UNKNOWN, sizeof(cells)); }
+
+  // Paints the cell if its state changed; true if it did
+  bool set(uint8_t row, uint8_t col, uint8_t state) {
+    if (row >= ROWS || col >= COLS || cells[row][col] == state) return false;
+    cells[row][col] = state;
+    paint(row, col, state);
+    painted++;
+    return true;
+  }
+
+  // A full draw painted the cell itself
+  void assume(uint8_t row, uint8_t col, uint8_t state) {
+    if (row < ROWS && col < COLS) cells[row][col] = state;
+  }
+
+  uint8_t state(uint8_t row, uint8_t col) const { return cells[row][col]; }
+  uint32_t paintedCells() const { return painted; }  // Since start, for benchmarks
+
+private:
+  Painter paint;
+  uint8_t cells[ROWS][COLS];
+  uint32_t painted;
+};
+
+#endif // STEP_GRID_H
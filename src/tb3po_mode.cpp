@@ -3,6 +3,8 @@
  *******************************************************************/
 
 #include "tb3po_mode.h"
+#include "ui_compositor.h"
+#include "step_grid.h"
 
 TB3POState tb3po;
 
@@ -121,6 +123,11 @@ static void regenerateAll() {
   applyDensity();
 }
 
+void regenerateTB3POPattern() {
+  regeneratePitches();
+  applyDensity();
+}
+
 // Get MIDI note for step
 static int getMIDINoteForStep(int stepNum) {
   const Scale& scale = scales[tb3po.scaleIndex];
@@ -154,45 +161,115 @@ static bool stepIsAccent(int stepNum) {
   return (tb3po.accents & (1 << stepNum)) != 0;
 }
 
+// Steps still covered by the note of an earlier step (MIDI task only)
+static uint32_t lastStepIndex = UINT32_MAX;
+static uint8_t tiedSteps = 0;
+
+// A tie is scheduled with its whole length; stopping in the middle ends it
+static void releaseTie() {
+  if (tiedSteps == 0) return;
+  tiedSteps = 0;
+  if (tb3po.currentNote >= 0) MIDIThread::sendNoteOff(tb3po.currentNote, 0);
+}
+
+static void tb3poTransportEvent(TransportEvent event, void*) {
+  if (event == TRANSPORT_STOP) releaseTie();
+}
+
+// Transport step (MIDI task): one 16th note
+static void tb3poStep(const TransportTick& tick, void*) {
+  if (!GeneratorRuntime::isPlaying(ENGINE_TB3PO)) {
+    releaseTie();  // Stopped while other engines keep the transport running
+    return;
+  }
+  
+  uint8_t step = tick.step % tb3po.numSteps;
+  tb3po.step = step;
+  
+  // A tie only carries on into the very next step (not after a stop)
+  if (tick.step != lastStepIndex + 1) tiedSteps = 0;
+  lastStepIndex = tick.step;
+  
+  // Play current step if gated. Slid notes are held past the next step's
+  // note-on so the synth sees legato; others get a half-step gate. A slide
+  // into the same pitch is a tie, as on a 303: the note is held through the
+  // next step instead of being struck again.
+  if (tiedSteps > 0) {
+    tiedSteps--;
+  } else if (stepIsGated(step)) {
+    int note = getMIDINoteForStep(step);
+    int velocity = stepIsAccent(step) ? 127 : 100;
+    uint8_t last = step;
+    while (tiedSteps < tb3po.numSteps - 1 && stepIsSlid(last)) {
+      uint8_t next = (last + 1) % tb3po.numSteps;
+      if (!stepIsGated(next) || getMIDINoteForStep(next) != note) break;
+      tiedSteps++;
+      last = next;
+    }
+    uint32_t gate = tiedSteps * tick.stepUs + (stepIsSlid(last) ? tick.stepUs + tick.stepUs / 8 : tick.stepUs / 2);
+    scheduleNote(note, velocity, tick.timeUs, gate);
+    tb3po.currentNote = note;
+  }
+  
+  tb3po.stepChanged = true;
+}
+
+// Screen layout, shared by the full draw, the layers and the touch handler
+#define TB3PO_INFO_H 100              // Status, parameter and scale lines
+#define TB3PO_STEPS_Y (CONTENT_TOP + 110)
+#define TB3PO_STEP_W 28
+#define TB3PO_STEP_H 40
+#define TB3PO_BTN_Y (SCREEN_HEIGHT - 70)
+#define TB3PO_BTN_H 50
+
+// Compositor layers, registered by drawTB3POMode()
+static int8_t layerHeader = -1;
+static int8_t layerInfo = -1;
+
+static void drawTB3POHeader() {
+  drawModuleHeader("TB-3PO", true);
+}
+
 void initializeTB3POMode() {
   Serial.println("\n=== TB-3PO Mode Initialization ===");
   
-  tb3po.step = 0;
-  tb3po.playing = false;
-  tb3po.currentNote = -1;
-  tb3po.lastStepTime = 0;
   tb3po.readyForInput = false; // Wait for touch release before accepting input
-  tb3po.density = 7;
-  tb3po.scaleIndex = 0; // Major scale
-  tb3po.rootNote = 0;   // C
-  tb3po.octaveOffset = 0;
-  tb3po.lockSeed = false;
-  tb3po.numSteps = 16;
-  tb3po.bpm = 120.0;
-  tb3po.useInternalClock = true;
   
-  Serial.printf("BPM: %.1f, Steps: %d, Density: %d\n", tb3po.bpm, tb3po.numSteps, tb3po.density);
+  // The sequence may still be playing from an earlier visit - keep it
+  if (!tb3po.engineReady) {
+    tb3po.step = 0;
+    tb3po.currentNote = -1;
+    tb3po.density = 7;
+    tb3po.scaleIndex = 0; // Major scale
+    tb3po.rootNote = 0;   // C
+    tb3po.octaveOffset = 0;
+    tb3po.lockSeed = false;
+    tb3po.numSteps = 16;
+    
+    regenerateAll();
+    GeneratorRuntime::attach(ENGINE_TB3PO, tb3poStep, TRANSPORT_16TH, tb3poTransportEvent);
+    tb3po.engineReady = true;
+  }
+  tb3po.stepChanged = false;
   
-  regenerateAll();
+  Serial.printf("BPM: %.1f, Steps: %d, Density: %d\n", globalState.bpm, tb3po.numSteps, tb3po.density);
   
   Serial.printf("Seed: 0x%04X, Gates: 0x%04X, Slides: 0x%04X, Accents: 0x%04X\n",
                 tb3po.seed, tb3po.gates, tb3po.slides, tb3po.accents);
   
   tft.fillScreen(THEME_BG);
-  drawModuleHeader("TB-3PO", true);
+  drawTB3POHeader();
   drawTB3POMode();
   
   Serial.println("TB-3PO initialized and drawn");
 }
 
-void drawTB3POMode() {
-  tft.fillRect(0, CONTENT_TOP, SCREEN_WIDTH, SCREEN_HEIGHT - CONTENT_TOP, THEME_BG);
-  
+static void drawTB3POInfo() {
   int y = CONTENT_TOP + 10;
   
   // Title and status
   tft.setTextColor(THEME_TEXT, THEME_BG);
-  tft.drawString(tb3po.playing ? "PLAYING" : "STOPPED", 10, y, 2);
+  tft.drawString(GeneratorRuntime::isPlaying(ENGINE_TB3PO) ? "PLAYING" : "STOPPED", 10, y, 2);
   
   // Seed display
   tft.drawString(tb3po.lockSeed ? "SEED LOCKED" : "SEED AUTO", 200, y, 2);
@@ -201,7 +278,7 @@ void drawTB3POMode() {
   y += 30;
   
   // BPM
-  tft.drawString("BPM: " + String((int)tb3po.bpm), 10, y, 2);
+  tft.drawString("BPM: " + String((int)globalState.bpm), 10, y, 2);
   
   // Steps
   tft.drawString("STEPS: " + String(tb3po.numSteps), 150, y, 2);
@@ -221,96 +298,93 @@ void drawTB3POMode() {
   if (tb3po.octaveOffset != 0) {
     tft.drawString("OCT: " + String(tb3po.octaveOffset > 0 ? "+" : "") + String(tb3po.octaveOffset), 350, y, 2);
   }
+}
+
+static void drawTB3POButtons() {
+  // Control buttons - calculate from screen dimensions
+  int btnSpacing = 10;
+  int btnW = (SCREEN_WIDTH - (5 * btnSpacing)) / 4;
   
-  y += 40;
+  drawRoundButton(10, TB3PO_BTN_Y, btnW, TB3PO_BTN_H, GeneratorRuntime::isPlaying(ENGINE_TB3PO) ? "STOP" : "PLAY", THEME_PRIMARY, false);
+  drawRoundButton(110, TB3PO_BTN_Y, btnW, TB3PO_BTN_H, "REGEN", THEME_SECONDARY, false);
+  drawRoundButton(210, TB3PO_BTN_Y, btnW, TB3PO_BTN_H, "SEED", THEME_ACCENT, false);
+  drawRoundButton(310, TB3PO_BTN_Y, btnW, TB3PO_BTN_H, "SCALE", THEME_SUCCESS, false);
+}
+
+// What each step box shows, as last painted
+#define TB3PO_CELL_GATE 1
+#define TB3PO_CELL_SLIDE 2
+#define TB3PO_CELL_ACCENT 4
+#define TB3PO_CELL_PLAYHEAD 8
+
+static void paintTB3POStep(uint8_t, uint8_t i, uint8_t state) {
+  int x = 10 + (i * TB3PO_STEP_W);
+  int y = TB3PO_STEPS_Y;
+  int stepWidth = TB3PO_STEP_W;
+  int stepHeight = TB3PO_STEP_H;
   
-  // Step sequence visualization
-  int stepWidth = 28;
-  int stepHeight = 40;
-  int startX = 10;
+  bool isCurrentStep = state & TB3PO_CELL_PLAYHEAD;
+  bool isGated = state & TB3PO_CELL_GATE;
   
-  for (int i = 0; i < tb3po.numSteps; i++) {
-    int x = startX + (i * stepWidth);
-    
-    bool isCurrentStep = (i == tb3po.step && tb3po.playing);
-    bool isGated = stepIsGated(i);
-    bool isSlid = stepIsSlid(i);
-    bool isAccent = stepIsAccent(i);
-    
-    // Step box
-    uint16_t boxColor = isCurrentStep ? THEME_PRIMARY : THEME_SURFACE;
-    if (!isGated) boxColor = THEME_TEXT_DIM;
-    
-    tft.fillRoundRect(x, y, stepWidth - 2, stepHeight, 3, boxColor);
-    
-    // Accent indicator (top)
-    if (isAccent && isGated) {
-      tft.fillCircle(x + stepWidth/2 - 1, y + 5, 3, THEME_WARNING);
-    }
-    
-    // Slide indicator (bottom)
-    if (isSlid && isGated) {
-      tft.fillRect(x + 2, y + stepHeight - 6, stepWidth - 6, 4, THEME_ACCENT);
-    }
-    
-    // Step number
-    tft.setTextColor(isCurrentStep ? THEME_BG : THEME_TEXT, boxColor);
-    tft.drawString(String(i + 1), x + (stepWidth/2) - 6, y + stepHeight/2 - 4, 1);
-  }
+  // Step box
+  uint16_t boxColor = isCurrentStep ? THEME_PRIMARY : THEME_SURFACE;
+  if (!isGated) boxColor = THEME_TEXT_DIM;
   
-  y += stepHeight + 20;
+  tft.fillRoundRect(x, y, stepWidth - 2, stepHeight, 3, boxColor);
   
-  // Control buttons - calculate from screen dimensions
-  int btnSpacing = 10;
-  int btnY = SCREEN_HEIGHT - 70;
-  int btnH = 50;
-  int btnW = (SCREEN_WIDTH - (5 * btnSpacing)) / 4;
+  // Accent indicator (top)
+  if ((state & TB3PO_CELL_ACCENT) && isGated) {
+    tft.fillCircle(x + stepWidth/2 - 1, y + 5, 3, THEME_WARNING);
+  }
+  
+  // Slide indicator (bottom)
+  if ((state & TB3PO_CELL_SLIDE) && isGated) {
+    tft.fillRect(x + 2, y + stepHeight - 6, stepWidth - 6, 4, THEME_ACCENT);
+  }
   
-  drawRoundButton(10, btnY, btnW, btnH, tb3po.playing ? "STOP" : "PLAY", THEME_PRIMARY, false);
-  drawRoundButton(110, btnY, btnW, btnH, "REGEN", THEME_SECONDARY, false);
-  drawRoundButton(210, btnY, btnW, btnH, "SEED", THEME_ACCENT, false);
-  drawRoundButton(310, btnY, btnW, btnH, "SCALE", THEME_SUCCESS, false);
+  // Step number
+  tft.setTextColor(isCurrentStep ? THEME_BG : THEME_TEXT, boxColor);
+  tft.drawString(String(i + 1), x + (stepWidth/2) - 6, y + stepHeight/2 - 4, 1);
 }
 
-// Efficient update of just the step visualization
+static StepGrid<1, TB3PO_MAX_STEPS> stepGrid(paintTB3POStep);
+
+// All step boxes, after the area under them was cleared
+static void drawTB3POSteps() {
+  stepGrid.invalidate();
+  updateTB3POSteps();
+}
+
+// Efficient update of just the step boxes that changed
 void updateTB3POSteps() {
-  int y = CONTENT_TOP + 135;  // Position matching drawTB3POMode
-  int stepWidth = 28;
-  int stepHeight = 40;
-  int startX = 10;
-  
+  bool playing = GeneratorRuntime::isPlaying(ENGINE_TB3PO);
+  uint8_t playhead = tb3po.step;
   for (int i = 0; i < tb3po.numSteps; i++) {
-    int x = startX + (i * stepWidth);
-    
-    bool isCurrentStep = (i == tb3po.step && tb3po.playing);
-    bool isGated = stepIsGated(i);
-    bool isSlid = stepIsSlid(i);
-    bool isAccent = stepIsAccent(i);
-    
-    // Step box
-    uint16_t boxColor = isCurrentStep ? THEME_PRIMARY : THEME_SURFACE;
-    if (!isGated) boxColor = THEME_TEXT_DIM;
-    
-    tft.fillRoundRect(x, y, stepWidth - 2, stepHeight, 3, boxColor);
-    
-    // Accent indicator (top)
-    if (isAccent && isGated) {
-      tft.fillCircle(x + stepWidth/2 - 1, y + 5, 3, THEME_WARNING);
-    }
-    
-    // Slide indicator (bottom)
-    if (isSlid && isGated) {
-      tft.fillRect(x + 2, y + stepHeight - 6, stepWidth - 6, 4, THEME_ACCENT);
-    }
-    
-    // Step number
-    tft.setTextColor(isCurrentStep ? THEME_BG : THEME_TEXT, boxColor);
-    tft.drawString(String(i + 1), x + (stepWidth/2) - 6, y + stepHeight/2 - 4, 1);
+    uint8_t state = 0;
+    if (stepIsGated(i)) state |= TB3PO_CELL_GATE;
+    if (stepIsSlid(i)) state |= TB3PO_CELL_SLIDE;
+    if (stepIsAccent(i)) state |= TB3PO_CELL_ACCENT;
+    if (playing && i == playhead) state |= TB3PO_CELL_PLAYHEAD;
+    stepGrid.set(0, i, state);
   }
 }
 
+void drawTB3POMode() {
+  tft.fillRect(0, CONTENT_TOP, SCREEN_WIDTH, SCREEN_HEIGHT - CONTENT_TOP, THEME_BG);
+  drawTB3POInfo();
+  drawTB3POSteps();
+  drawTB3POButtons();
+  
+  // Touches repaint only what they change
+  UICompositor::reset();
+  layerHeader = UICompositor::addLayer(0, 0, SCREEN_WIDTH, CONTENT_TOP, drawTB3POHeader);
+  layerInfo = UICompositor::addLayer(0, CONTENT_TOP, SCREEN_WIDTH, TB3PO_INFO_H, drawTB3POInfo);
+  UICompositor::addLayer(0, TB3PO_STEPS_Y, SCREEN_WIDTH, TB3PO_STEP_H, drawTB3POSteps);
+  UICompositor::addLayer(0, TB3PO_BTN_Y, SCREEN_WIDTH, TB3PO_BTN_H, drawTB3POButtons);
+}
+
 void handleTB3POMode() {
-  updateTouch();
+  // Touch state for this frame was taken by loop()
   
   // Wait for initial touch release before accepting button input
   if (!tb3po.readyForInput) {
@@ -318,13 +392,12 @@ void handleTB3POMode() {
       tb3po.readyForInput = true;
       Serial.println("TB3PO ready for input");
     }
-    // Still handle playback timing even during wait
   }
   
   // Calculate button layout matching drawTB3POMode
   int btnSpacing = 10;
-  int btnY = SCREEN_HEIGHT - 70;
-  int btnH = 50;
+  int btnY = TB3PO_BTN_Y;
+  int btnH = TB3PO_BTN_H;
   int btnW = (SCREEN_WIDTH - (5 * btnSpacing)) / 4;
   
   int btn1X = btnSpacing;
@@ -340,51 +413,16 @@ void handleTB3POMode() {
   
   // Only redraw buttons when pressed
   if (playPressed || regenPressed || seedPressed || scalePressed) {
-    drawRoundButton(10, btnY, 90, btnH, tb3po.playing ? "STOP" : "PLAY", THEME_PRIMARY, playPressed);
+    drawRoundButton(10, btnY, 90, btnH, GeneratorRuntime::isPlaying(ENGINE_TB3PO) ? "STOP" : "PLAY", THEME_PRIMARY, playPressed);
     drawRoundButton(110, btnY, 90, btnH, "REGEN", THEME_SECONDARY, regenPressed);
     drawRoundButton(210, btnY, 90, btnH, "SEED", THEME_ACCENT, seedPressed);
     drawRoundButton(310, btnY, 90, btnH, "SCALE", THEME_SUCCESS, scalePressed);
   }
   
-  // Handle playback timing
-  if (tb3po.playing && tb3po.useInternalClock) {
-    unsigned long now = millis();
-    
-    // Calculate step interval from BPM (16th notes)
-    tb3po.stepInterval = (60000.0 / tb3po.bpm) / 4.0;
-    
-    if (now - tb3po.lastStepTime >= tb3po.stepInterval) {
-      tb3po.lastStepTime = now;
-      
-      Serial.printf("TB3PO Step %d: gate=%d accent=%d slide=%d\n", 
-                    tb3po.step, stepIsGated(tb3po.step), 
-                    stepIsAccent(tb3po.step), stepIsSlid(tb3po.step));
-      
-      // Stop previous note if playing
-      if (tb3po.currentNote >= 0) {
-        sendNoteOff(tb3po.currentNote);
-        Serial.printf("  Note OFF: %d\n", tb3po.currentNote);
-        tb3po.currentNote = -1;
-      }
-      
-      // Play current step if gated
-      if (stepIsGated(tb3po.step)) {
-        int note = getMIDINoteForStep(tb3po.step);
-        int velocity = stepIsAccent(tb3po.step) ? 127 : 100;
-        
-        Serial.printf("  Note ON: %d vel=%d\n", note, velocity);
-        sendNoteOn(note, velocity);
-        tb3po.currentNote = note;
-      }
-      
-      // Advance step
-      tb3po.step++;
-      if (tb3po.step >= tb3po.numSteps) {
-        tb3po.step = 0;
-      }
-      
-      updateTB3POSteps();  // Only redraw step indicators, not entire screen
-    }
+  // Steps are played by the transport; redraw what it changed
+  if (tb3po.stepChanged) {
+    tb3po.stepChanged = false;
+    updateTB3POSteps();  // Only the step boxes that changed
   }
   
   // Debug touch state changes only
@@ -401,25 +439,21 @@ void handleTB3POMode() {
     
     // Play/Stop button
     if (playPressed) {
-      Serial.printf("PLAY/STOP pressed. Was playing: %d\n", tb3po.playing);
-      tb3po.playing = !tb3po.playing;
-      if (!tb3po.playing && tb3po.currentNote >= 0) {
-        sendNoteOff(tb3po.currentNote);
-        tb3po.currentNote = -1;
-      }
-      if (tb3po.playing) {
-        tb3po.lastStepTime = millis();
-        Serial.printf("Now playing. Step interval: %lu ms\n", tb3po.stepInterval);
-      } else {
-        Serial.println("Stopped");
-      }
-      drawTB3POMode();
+      bool wasPlaying = GeneratorRuntime::isPlaying(ENGINE_TB3PO);
+      Serial.printf("PLAY/STOP pressed. Was playing: %d\n", wasPlaying);
+      // Stopping leaves the last note's scheduled note-off to release it,
+      // so other engines' pending notes are not disturbed
+      GeneratorRuntime::setPlaying(ENGINE_TB3PO, !wasPlaying);
+      UICompositor::invalidate(10, CONTENT_TOP + 10, 100, 16);  // PLAYING/STOPPED
+      updateTB3POSteps();                                        // Playhead
+      UICompositor::invalidate(btn1X, btnY, btnW, btnH);         // PLAY/STOP
     }
     // Regenerate button
     else if (regenPressed) {
       Serial.println("REGEN pressed");
       regenerateAll();
-      drawTB3POMode();
+      UICompositor::invalidateLayer(layerInfo);
+      updateTB3POSteps();
     }
     // Seed lock button
     else if (seedPressed) {
@@ -429,7 +463,8 @@ void handleTB3POMode() {
         reseed();
         regenerateAll();
       }
-      drawTB3POMode();
+      UICompositor::invalidateLayer(layerInfo);
+      updateTB3POSteps();
     }
     // Scale button
     else if (scalePressed) {
@@ -439,18 +474,14 @@ void handleTB3POMode() {
         tb3po.scaleIndex = 0;
       }
       regenerateAll();
-      drawTB3POMode();
+      UICompositor::invalidateLayer(layerInfo);
+      updateTB3POSteps();
     }
 
     // Check back button from header (standard position)
     else if (isButtonPressed(BACK_BTN_X, BACK_BTN_Y, BTN_BACK_W, BTN_BACK_H)) {
       Serial.println("BACK pressed (header)");
-      if (tb3po.currentNote >= 0) {
-        sendNoteOff(tb3po.currentNote);
-      }
-      tb3po.playing = false;
-      currentMode = MENU;
-      tft.fillScreen(THEME_BG);
+      exitToMenu();  // TB-3PO keeps playing if it was
     }
     // Density control (tap on density display area)
     else if (isButtonPressed(300, CONTENT_TOP + 30, 150, 20)) {
@@ -458,15 +489,17 @@ void handleTB3POMode() {
       tb3po.density++;
       if (tb3po.density > 14) tb3po.density = 0;
       applyDensity();
-      drawTB3POMode();
+      UICompositor::invalidateLayer(layerInfo);
+      updateTB3POSteps();
     }
     // BPM control
     else if (isButtonPressed(10, CONTENT_TOP + 30, 120, 20)) {
-      float newBpm = tb3po.bpm + 10;
+      float newBpm = globalState.bpm + 10;
       if (newBpm > TB3PO_MAX_BPM) newBpm = TB3PO_MIN_BPM;
-      Serial.printf("BPM pressed: %.1f -> %.1f\n", tb3po.bpm, newBpm);
-      tb3po.bpm = newBpm;
-      drawTB3POMode();
+      Serial.printf("BPM pressed: %.1f -> %.1f\n", globalState.bpm, newBpm);
+      setBPM(newBpm);
+      UICompositor::invalidateLayer(layerHeader);  // BPM indicator
+      UICompositor::invalidateLayer(layerInfo);
     }
     // Root note control
     else if (isButtonPressed(250, CONTENT_TOP + 60, 80, 20)) {
@@ -474,7 +507,8 @@ void handleTB3POMode() {
       tb3po.rootNote++;
       if (tb3po.rootNote > 11) tb3po.rootNote = 0;
       regenerateAll();
-      drawTB3POMode();
+      UICompositor::invalidateLayer(layerInfo);
+      updateTB3POSteps();
     } else {
       Serial.println("TB3PO touch - no button hit");
     }
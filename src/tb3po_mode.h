@@ -14,6 +14,7 @@
 #include "common_definitions.h"
 #include "ui_elements.h"
 #include "midi_utils.h"
+#include "generator_runtime.h"
 
 #define TB3PO_MAX_STEPS 16
 #define TB3PO_MIN_BPM 60
@@ -29,12 +30,11 @@ struct TB3POState {
   uint8_t notes[TB3PO_MAX_STEPS] = {0}; // Note indices in scale
   
   // Playback
-  uint8_t step = 0;
+  volatile uint8_t step = 0;        // Step last played
   uint8_t numSteps = 16;
-  bool playing = false;
-  unsigned long lastStepTime = 0;
-  unsigned long stepInterval = 125; // milliseconds per step (120 BPM, 16th notes)
-  int currentNote = -1;
+  volatile int currentNote = -1;    // Last note scheduled (its note-off is scheduled too)
+  volatile bool stepChanged = false;  // Set by the transport, cleared by the redraw
+  bool engineReady = false;         // Runs in the background once set up
   
   // Generation parameters
   uint16_t seed = 12345;
@@ -44,10 +44,6 @@ struct TB3POState {
   uint8_t rootNote = 0;     // Root note 0-11 (C-B)
   int8_t octaveOffset = 0;  // -3 to +3
   
-  // BPM control
-  float bpm = 120.0;
-  bool useInternalClock = true;
-  
   // Touch handling
   bool readyForInput = false; // Wait for initial touch release before accepting input
 };
@@ -59,5 +55,6 @@ void initializeTB3POMode();
 void drawTB3POMode();
 void updateTB3POSteps();  // Efficient partial redraw
 void handleTB3POMode();
+void regenerateTB3POPattern();  // From tb3po.seed: the same seed gives the same pattern
 
 #endif
@@ -0,0 +1,173 @@
+#ifndef TEMPO_TRACKER_H
+#define TEMPO_TRACKER_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Follows an incoming MIDI clock: tempo and phase from tick arrival times
+// - Least-squares line through the last TEMPO_WINDOW arrivals (tick index vs
+//   microseconds). BLE bunches clock bytes into connection events, so single
+//   intervals jitter by tens of ms; the fit averages that out to well under
+//   1 BPM and gives where the beat actually is, not just how fast it goes.
+// - A jump in tempo (arrivals drifting off the line) shrinks the window so
+//   the fit re-converges in a few ticks; a long gap resets it.
+// - addTick() runs on one task (the BLE callback); estimate() may be called
+//   from any other and always returns a consistent snapshot.
+//
+// Plain C++ (no Arduino/FreeRTOS) so it can be benchmarked on the host.
+
+#define TEMPO_WINDOW 96             // Ticks in the fit (4 beats at 24 PPQN)
+#define TEMPO_MIN_TICKS 12          // Fit is reported as locked from here
+#define TEMPO_RESET_GAP_US 500000   // Silence that restarts tracking
+
+struct TempoEstimate {
+  uint32_t anchorUs;    // Fitted arrival time of tick anchorTick
+  uint32_t anchorTick;  // Ticks since reset (MIDI Start)
+  float tickUs;         // Fitted tick period
+  bool locked;
+};
+
+class TempoTracker {
+public:
+  explicit TempoTracker(uint16_t ppqn = 24) : ppqn(ppqn), sequence(0) { reset(); }
+
+  // Start over (MIDI Start, or a long gap). Tick 0 is the next arrival.
+  void reset() {
+    count = 0;
+    head = 0;
+    nextTick = 0;
+    outliers = 0;
+    current = {0, 0, 0.0f, false};
+    publish();
+  }
+
+  void addTick(uint32_t arrivalUs) {
+    if (count > 0 && (int32_t)(arrivalUs - times[(head + TEMPO_WINDOW - 1) % TEMPO_WINDOW]) > TEMPO_RESET_GAP_US) {
+      reset();
+    }
+
+    // An arrival far off the current line for two ticks running means the
+    // tempo changed: keep only the most recent few points and refit
+    if (current.locked) {
+      int32_t error = (int32_t)(arrivalUs - predict(current, nextTick));
+      int32_t limit = (int32_t)(current.tickUs * 3.0f);
+      if (limit < 40000) limit = 40000;
+      if (error > limit || error < -limit) {
+        if (++outliers >= 2) {
+          trim(4);
+          outliers = 0;
+        }
+      } else {
+        outliers = 0;
+      }
+    }
+
+    times[head] = arrivalUs;
+    head = (head + 1) % TEMPO_WINDOW;
+    if (count < TEMPO_WINDOW) count++;
+    nextTick++;
+    fit();
+  }
+
+  TempoEstimate estimate() const {
+    TempoEstimate e;
+    uint32_t seq;
+    do {
+      seq = sequence.load(std::memory_order_acquire);
+      e.anchorUs = shared.anchorUs;
+      e.anchorTick = shared.anchorTick;
+      e.tickUs = shared.tickUs;
+      e.locked = shared.locked;
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || seq != sequence.load(std::memory_order_relaxed));
+    return e;
+  }
+
+  float bpm() const {
+    TempoEstimate e = estimate();
+    return e.tickUs > 0.0f ? 60000000.0f / (e.tickUs * ppqn) : 0.0f;
+  }
+
+  // Fitted time of tick n (n may be past the last arrival)
+  static uint32_t predict(const TempoEstimate& e, uint32_t tick) {
+    return e.anchorUs + (int32_t)((float)(int32_t)(tick - e.anchorTick) * e.tickUs);
+  }
+
+  // Fitted time of the 'division'-tick boundary nearest to timeUs
+  // (division 6 = 16th notes, 24 = beats at 24 PPQN)
+  static uint32_t nearestBoundaryUs(const TempoEstimate& e, uint32_t timeUs, uint16_t division) {
+    if (!e.locked || e.tickUs <= 0.0f) return timeUs;
+    float ticks = (float)(int32_t)(timeUs - e.anchorUs) / e.tickUs;
+    int32_t tick = (int32_t)e.anchorTick + (int32_t)(ticks + (ticks >= 0 ? 0.5f : -0.5f));
+    int32_t boundary = ((tick + division / 2) / division) * division;
+    return predict(e, (uint32_t)boundary);
+  }
+
+  // Position within the beat at nowUs, 0.0 (on the beat) to 1.0
+  float beatPhase(uint32_t nowUs) const {
+    TempoEstimate e = estimate();
+    if (!e.locked) return 0.0f;
+    float ticks = (float)e.anchorTick + (float)(int32_t)(nowUs - e.anchorUs) / e.tickUs;
+    float beats = ticks / ppqn;
+    return beats - (float)(int32_t)beats;
+  }
+
+private:
+  uint16_t ppqn;
+  uint32_t times[TEMPO_WINDOW];  // Ring of arrival times, oldest at head - count
+  uint16_t count;
+  uint16_t head;
+  uint32_t nextTick;             // Index the next arrival will get
+  uint8_t outliers;
+
+  TempoEstimate current;         // Owned by the addTick() side
+  TempoEstimate shared;          // Published copy, guarded by sequence
+  std::atomic<uint32_t> sequence;
+
+  void trim(uint16_t keep) {
+    if (count > keep) count = keep;
+  }
+
+  // y = a + b*x over x = 0..n-1 (oldest first), y relative to the oldest
+  // arrival. Sums are exact in 64-bit integers; only the final divide is floating point.
+  void fit() {
+    int n = count;
+    uint32_t first = times[(head + TEMPO_WINDOW - n) % TEMPO_WINDOW];
+    if (n < 2) {
+      current = {first, nextTick - 1, current.tickUs, false};
+      publish();
+      return;
+    }
+
+    int64_t sy = 0, sxy = 0;
+    for (int i = 0; i < n; i++) {
+      int64_t y = (int32_t)(times[(head + TEMPO_WINDOW - n + i) % TEMPO_WINDOW] - first);
+      sy += y;
+      sxy += y * i;
+    }
+    int64_t sx = (int64_t)n * (n - 1) / 2;
+    int64_t sxx = (int64_t)(n - 1) * n * (2 * n - 1) / 6;
+    int64_t denom = n * sxx - sx * sx;
+
+    double slope = (double)(n * sxy - sx * sy) / (double)denom;
+    double intercept = ((double)sy - slope * (double)sx) / n;
+
+    // Anchor at the newest tick - the point the loop extrapolates from
+    current.tickUs = (float)slope;
+    current.anchorTick = nextTick - 1;
+    current.anchorUs = first + (int32_t)(intercept + slope * (n - 1));
+    current.locked = n >= TEMPO_MIN_TICKS && slope > 0.0;
+    publish();
+  }
+
+  // Copy current into shared; an odd sequence number marks a write in progress
+  void publish() {
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    shared = current;
+    sequence.store(seq + 2, std::memory_order_release);
+  }
+};
+
+#endif // TEMPO_TRACKER_H
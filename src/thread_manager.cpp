@@ -1,4 +1,9 @@
 #include "common_definitions.h"
+#include "ble_midi_packet.h"
+#include "midi_scheduler.h"
+#include "clock_engine.h"
+#include "transport.h"
+#include "latency_trace.h"
 #include <Arduino.h>
 
 // Global state instance
@@ -6,11 +11,19 @@ GlobalState globalState;
 
 // TouchThread implementation
 TouchCallback TouchThread::activeCallback = nullptr;
+TouchMapper TouchThread::mapPoint = nullptr;
 TouchState TouchThread::currentState;
 SemaphoreHandle_t TouchThread::touchMutex = nullptr;
+SPSCQueue<TouchEvent, TOUCH_EVENT_QUEUE_SIZE> TouchThread::events;
+TouchFilter TouchThread::filter;
+TouchFilterConfig TouchThread::pendingConfig;
+volatile bool TouchThread::configPending = false;
 
-void TouchThread::begin() {
+extern XPT2046_Touchscreen ts;
+
+void TouchThread::begin(TouchMapper mapper) {
   touchMutex = xSemaphoreCreateMutex();
+  mapPoint = mapper;
   currentState.wasPressed = false;
   currentState.isPressed = false;
   currentState.justPressed = false;
@@ -34,6 +47,10 @@ void TouchThread::update() {
   // Main loop update - handled by task now
 }
 
+bool TouchThread::popEvent(TouchEvent& event) {
+  return events.pop(event);
+}
+
 void TouchThread::registerCallback(TouchCallback callback) {
   if (xSemaphoreTake(touchMutex, portMAX_DELAY)) {
     activeCallback = callback;
@@ -48,6 +65,14 @@ void TouchThread::unregisterCallback() {
   }
 }
 
+void TouchThread::configureFilter(const TouchFilterConfig& config) {
+  if (xSemaphoreTake(touchMutex, portMAX_DELAY)) {
+    pendingConfig = config;
+    configPending = true;
+    xSemaphoreGive(touchMutex);
+  }
+}
+
 TouchState TouchThread::getState() {
   TouchState state;
   if (xSemaphoreTake(touchMutex, portMAX_DELAY)) {
@@ -57,94 +82,274 @@ TouchState TouchThread::getState() {
   return state;
 }
 
+void TouchThread::publish(TouchEventType type, int16_t x, int16_t y, uint8_t velocity, uint32_t timeUs) {
+  TouchEvent event = {timeUs, x, y, type, velocity};
+  events.push(event);  // A full queue drops (and counts) the event
+  
+  if (xSemaphoreTake(touchMutex, portMAX_DELAY)) {
+    currentState.wasPressed = currentState.isPressed;
+    currentState.isPressed = type != TOUCH_RELEASE;
+    currentState.justPressed = type == TOUCH_PRESS;
+    currentState.justReleased = type == TOUCH_RELEASE;
+    currentState.x = x;
+    currentState.y = y;
+    currentState.timestampUs = timeUs;
+    currentState.velocity = velocity;
+    if (activeCallback) activeCallback(x, y, type != TOUCH_RELEASE);
+    xSemaphoreGive(touchMutex);
+  }
+}
+
 void TouchThread::touchTask(void* parameter) {
-  // Touch thread simply updates state periodically
-  // The actual touch reading and calibration is handled by updateTouch()
-  // This keeps compatibility with existing calibration system
+  const TickType_t period = pdMS_TO_TICKS(1000 / TOUCH_SAMPLE_HZ);
+  TickType_t lastWake = xTaskGetTickCount();
+  bool down = false;  // A press has been published
+  int16_t x = 0, y = 0;
   
   while (true) {
-    // Thread runs but actual touch processing happens in main loop via updateTouch()
-    // This structure allows future migration to full threaded touch handling
-    vTaskDelay(10 / portTICK_PERIOD_MS);
+    // Fixed rate, independent of how long the loop spends drawing
+    vTaskDelayUntil(&lastWake, period);
+    uint32_t now = micros();
+    
+    if (configPending && xSemaphoreTake(touchMutex, portMAX_DELAY)) {
+      filter.configure(pendingConfig);
+      configPending = false;
+      down = false;  // configure() resets the filter; the touch starts over
+      xSemaphoreGive(touchMutex);
+    }
+    
+    uint16_t rawX = 0, rawY = 0, z = 0;
+    if (ts.tirqTouched()) {
+      TS_Point p = ts.getPoint();  // z is 0 below the library's touch threshold
+      rawX = p.x;
+      rawY = p.y;
+      z = p.z;
+    }
+    
+    int16_t sampleX, sampleY;
+    switch (filter.update(rawX, rawY, z)) {
+      case FILTER_PRESS:
+        if (mapPoint && mapPoint(filter.x(), filter.y(), sampleX, sampleY)) {
+          down = true;
+          x = sampleX;
+          y = sampleY;
+          publish(TOUCH_PRESS, x, y, filter.velocity(), now);
+        }
+        break;
+      case FILTER_DOWN:
+        if (down && mapPoint(filter.x(), filter.y(), sampleX, sampleY) &&
+            (sampleX != x || sampleY != y)) {
+          x = sampleX;
+          y = sampleY;
+          publish(TOUCH_MOVE, x, y, filter.velocity(), now);
+        }
+        break;
+      case FILTER_RELEASE:
+        if (down) {
+          down = false;
+          publish(TOUCH_RELEASE, x, y, filter.velocity(), now);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+// MIDIInput implementation
+BLEMIDIParser MIDIInput::parser;
+SPSCQueue<MIDIInputEvent, MIDI_INPUT_QUEUE_SIZE> MIDIInput::inputQueue;
+MIDIRealtimeHandler MIDIInput::realtimeHandler = nullptr;
+
+void MIDIInput::begin(MIDIRealtimeHandler handler) {
+  realtimeHandler = handler;
+  parser.setHandler(onEvent);
+}
+
+void MIDIInput::receive(const uint8_t* data, size_t length) {
+  parser.parse(data, length);
+}
+
+bool MIDIInput::read(MIDIInputEvent& event) {
+  return inputQueue.pop(event);
+}
+
+void MIDIInput::onEvent(const MIDIInputEvent& event, void*) {
+  if (event.status >= 0xF8) {
+    if (realtimeHandler) realtimeHandler(event.status);
+    return;
   }
+  inputQueue.push(event);  // Overflow is counted, the BLE stack is never blocked
 }
 
 // MIDIThread implementation
-QueueHandle_t MIDIThread::midiQueue = nullptr;
+SPSCQueue<MIDIThread::MIDIMessage, MIDI_QUEUE_SIZE> MIDIThread::midiQueue;
 SemaphoreHandle_t MIDIThread::midiMutex = nullptr;
+volatile uint16_t MIDIThread::negotiatedMTU = BLE_MIDI_DEFAULT_MTU;
+volatile uint32_t MIDIThread::flushDeadlineUs = 1000;  // One RTOS tick
+MIDIStats MIDIThread::stats = {};
+TaskHandle_t MIDIThread::taskHandle = nullptr;
+ActiveNoteMap MIDIThread::activeNotes;
+TimedEventHeap<MIDIThread::MIDIMessage, MIDI_SCHEDULE_SIZE> MIDIThread::scheduled;
+NoteOverlap MIDIThread::overlap;
+SPSCQueue<MIDICapture, MIDI_CAPTURE_SIZE> MIDIThread::captured;
+volatile bool MIDIThread::captureEnabled = false;
 
 void MIDIThread::begin() {
   midiMutex = xSemaphoreCreateMutex();
-  midiQueue = xQueueCreate(64, sizeof(MIDIMessage));
   
-  // Create MIDI handling task on Core 1
+  // Create MIDI handling task on Core 1, above the loop task so transport
+  // steps are never held up by drawing
   xTaskCreatePinnedToCore(
     midiTask,
     "MIDITask",
     4096,
     nullptr,
-    1,  // Priority
-    nullptr,
+    5,  // Priority
+    &taskHandle,
     1   // Core 1
   );
+  
+  // Clock ticks come from a hardware timer and wake the task directly
+  ClockEngine::begin(taskHandle);
+  ClockEngine::setBPM(globalState.bpm);
 }
 
-void MIDIThread::sendNoteOn(uint8_t note, uint8_t velocity) {
+void MIDIThread::enqueue(MIDIMessage::Type type, uint8_t data1, uint8_t data2, int16_t data16) {
   MIDIMessage msg;
-  msg.type = MIDIMessage::NOTE_ON;
-  msg.data1 = note;
-  msg.data2 = velocity;
-  xQueueSend(midiQueue, &msg, 0);
+  msg.type = type;
+  msg.data1 = data1;
+  msg.data2 = data2;
+  msg.data16 = data16;
+  msg.timestampUs = micros();
+  post(msg);
+}
+
+// The loop hands messages over through the ring; the MIDI task's own
+// Transport handlers cannot (the ring has one producer) and don't need to
+void MIDIThread::post(const MIDIMessage& msg) {
+  if (xTaskGetCurrentTaskHandle() != taskHandle) {
+    LatencyTrace::enqueued();
+    midiQueue.push(msg);  // Wait-free; overflow is counted, not blocked on
+    return;
+  }
+  
+  if (msg.type == MIDIMessage::CANCEL_SCHEDULED) {
+    scheduled.clear();
+    overlap.clear();  // The offs it was counting are gone
+  } else if (!scheduled.push(msg)) {
+    stats.scheduleDropped++;  // Due or not, the heap hands it back in time order
+  }
+  stats.scheduledPending = scheduled.size();
+}
+
+void MIDIThread::sendNoteOn(uint8_t note, uint8_t velocity) {
+  enqueue(MIDIMessage::NOTE_ON, note, velocity);
 }
 
 void MIDIThread::sendNoteOff(uint8_t note, uint8_t velocity) {
-  MIDIMessage msg;
-  msg.type = MIDIMessage::NOTE_OFF;
-  msg.data1 = note;
-  msg.data2 = velocity;
-  xQueueSend(midiQueue, &msg, 0);
+  enqueue(MIDIMessage::NOTE_OFF, note, velocity);
 }
 
 void MIDIThread::sendCC(uint8_t controller, uint8_t value) {
-  MIDIMessage msg;
-  msg.type = MIDIMessage::CC;
-  msg.data1 = controller;
-  msg.data2 = value;
-  xQueueSend(midiQueue, &msg, 0);
+  enqueue(MIDIMessage::CC, controller, value);
 }
 
 void MIDIThread::sendPitchBend(int16_t value) {
-  MIDIMessage msg;
-  msg.type = MIDIMessage::PITCH_BEND;
-  msg.data16 = value;
-  xQueueSend(midiQueue, &msg, 0);
+  enqueue(MIDIMessage::PITCH_BEND, 0, 0, value);
 }
 
 void MIDIThread::sendClock() {
-  MIDIMessage msg;
-  msg.type = MIDIMessage::CLOCK;
-  xQueueSend(midiQueue, &msg, 0);
+  enqueue(MIDIMessage::CLOCK);
 }
 
 void MIDIThread::sendStart() {
-  MIDIMessage msg;
-  msg.type = MIDIMessage::START;
-  xQueueSend(midiQueue, &msg, 0);
+  ClockEngine::start();  // Sends START, then clock from the next timer tick
+}
+
+void MIDIThread::sendContinue() {
+  ClockEngine::resume();  // CONTINUE, then clock from the current position
 }
 
 void MIDIThread::sendStop() {
-  MIDIMessage msg;
-  msg.type = MIDIMessage::STOP;
-  xQueueSend(midiQueue, &msg, 0);
+  ClockEngine::stop();
+}
+
+void MIDIThread::setClockOutput(bool enabled) {
+  ClockEngine::setOutput(enabled);
+}
+
+void MIDIThread::schedule(const MIDIMessage& event, uint32_t dueTimeUs) {
+  MIDIMessage msg = event;
+  msg.timestampUs = dueTimeUs;
+  post(msg);  // The MIDI task holds it in its heap until due
+}
+
+void MIDIThread::scheduleNoteOn(uint8_t note, uint8_t velocity, uint32_t dueTimeUs) {
+  MIDIMessage msg = {MIDIMessage::NOTE_ON, note, velocity, 0, 0};
+  schedule(msg, dueTimeUs);
+}
+
+void MIDIThread::scheduleNoteOff(uint8_t note, uint32_t dueTimeUs) {
+  MIDIMessage msg = {MIDIMessage::NOTE_OFF, note, 0, 0, 0};
+  schedule(msg, dueTimeUs);
+}
+
+void MIDIThread::scheduleCC(uint8_t controller, uint8_t value, uint32_t dueTimeUs) {
+  MIDIMessage msg = {MIDIMessage::CC, controller, value, 0, 0};
+  schedule(msg, dueTimeUs);
+}
+
+void MIDIThread::schedulePitchBend(int16_t value, uint32_t dueTimeUs) {
+  MIDIMessage msg = {MIDIMessage::PITCH_BEND, 0, 0, value, 0};
+  schedule(msg, dueTimeUs);
+}
+
+void MIDIThread::scheduleCCRamp(uint8_t controller, uint8_t from, uint8_t to,
+                                uint32_t startUs, uint32_t durationUs, uint8_t steps) {
+  if (steps == 0) steps = 1;
+  for (uint8_t i = 1; i <= steps; i++) {
+    uint8_t value = from + ((int)(to - from) * i) / steps;
+    scheduleCC(controller, value, startUs + (uint32_t)((uint64_t)durationUs * i / steps));
+  }
+}
+
+void MIDIThread::cancelScheduled() {
+  enqueue(MIDIMessage::CANCEL_SCHEDULED);
+}
+
+void MIDIThread::panic(bool allNotesOffCC) {
+  enqueue(MIDIMessage::PANIC, allNotesOffCC ? 1 : 0);
+}
+
+bool MIDIThread::isNoteActive(uint8_t channel, uint8_t note) {
+  return activeNotes.isActive(channel - 1, note);
+}
+
+uint8_t MIDIThread::activeNoteCount(uint8_t channel) {
+  return activeNotes.count(channel - 1);
+}
+
+void MIDIThread::getActiveNotes(uint8_t channel, uint32_t out[4]) {
+  activeNotes.snapshot(channel - 1, out);
 }
 
 void MIDIThread::setBPM(float bpm) {
   if (xSemaphoreTake(midiMutex, portMAX_DELAY)) {
     globalState.bpm = constrain(bpm, 20.0, 300.0);
+    ClockEngine::setBPM(globalState.bpm);
     xSemaphoreGive(midiMutex);
   }
 }
 
+void MIDIThread::setMTU(uint16_t mtu) {
+  negotiatedMTU = mtu;
+}
+
+void MIDIThread::setFlushDeadline(uint32_t deadlineUs) {
+  flushDeadlineUs = deadlineUs;
+}
+
 float MIDIThread::getBPM() {
   float bpm = 120.0;
   if (xSemaphoreTake(midiMutex, portMAX_DELAY)) {
@@ -154,93 +359,250 @@ float MIDIThread::getBPM() {
   return bpm;
 }
 
+MIDIStats MIDIThread::getStats() {
+  MIDIStats snapshot = stats;
+  snapshot.dropped = midiQueue.dropCount();
+  snapshot.highWaterMark = midiQueue.highWaterMark();
+  snapshot.scheduleDropped = stats.scheduleDropped;
+  snapshot.scheduledPending = stats.scheduledPending;
+  return snapshot;
+}
+
+void MIDIThread::setCapture(bool enabled) {
+  // Stale entries from an earlier capture are the loop's to drop
+  MIDICapture discard;
+  while (captured.pop(discard)) {}
+  captureEnabled = enabled;
+}
+
+bool MIDIThread::popCapture(MIDICapture& midi) {
+  return captured.pop(midi);
+}
+
+void MIDIThread::resetStats() {
+  midiQueue.resetStats();
+  stats = MIDIStats();
+}
+
+uint8_t MIDIThread::encodeMessage(const MIDIMessage& msg, uint8_t* out) {
+  uint8_t channel = globalState.currentMidiChannel - 1;  // 0-15
+  
+  switch (msg.type) {
+    case MIDIMessage::NOTE_ON:
+      out[0] = 0x90 | channel;  // Note On + channel
+      out[1] = msg.data1;       // Note
+      out[2] = msg.data2;       // Velocity
+      return 3;
+      
+    case MIDIMessage::NOTE_OFF:
+      out[0] = 0x80 | channel;  // Note Off + channel
+      out[1] = msg.data1;       // Note
+      out[2] = msg.data2;       // Velocity
+      return 3;
+      
+    case MIDIMessage::CC:
+      out[0] = 0xB0 | channel;  // CC + channel
+      out[1] = msg.data1;       // Controller
+      out[2] = msg.data2;       // Value
+      return 3;
+      
+    case MIDIMessage::PITCH_BEND:
+      {
+        uint16_t bend = msg.data16 + 8192;  // Center at 8192
+        out[0] = 0xE0 | channel;            // Pitch Bend + channel
+        out[1] = bend & 0x7F;               // LSB
+        out[2] = (bend >> 7) & 0x7F;        // MSB
+      }
+      return 3;
+      
+    case MIDIMessage::CLOCK:
+      out[0] = 0xF8;  // MIDI Clock
+      return 1;
+      
+    case MIDIMessage::START:
+      out[0] = 0xFA;  // MIDI Start
+      globalState.isPlaying = true;
+      return 1;
+      
+    case MIDIMessage::STOP:
+      out[0] = 0xFC;  // MIDI Stop
+      globalState.isPlaying = false;
+      return 1;
+      
+    case MIDIMessage::CONTINUE:
+      out[0] = 0xFB;  // MIDI Continue
+      globalState.isPlaying = true;
+      return 1;
+      
+    case MIDIMessage::TICK:
+    case MIDIMessage::CANCEL_SCHEDULED:
+    case MIDIMessage::PANIC:
+      return 0;  // Handled by the task, nothing goes on the wire
+  }
+  return 0;
+}
+
+// 13-bit BLE-MIDI millisecond timestamp for the time an event was generated
+// (or was due), not the time it happens to be sent. The event time is taken
+// relative to the 64-bit timer so it stays continuous when micros() wraps.
+uint16_t MIDIThread::bleTimestamp(uint32_t eventUs) {
+  int64_t nowUs = esp_timer_get_time();
+  int32_t ageUs = (int32_t)((uint32_t)nowUs - eventUs);
+  return (uint16_t)(((nowUs - ageUs) / 1000) & 0x1FFF);
+}
+
 void MIDIThread::midiTask(void* parameter) {
   MIDIMessage msg;
-  unsigned long lastClockTime = 0;
-  unsigned long clockInterval = 0;
+  uint32_t batchTimes[BLE_MIDI_MAX_PACKET / 2];  // Enqueue times of messages in the packet
+  uint8_t batchCount = 0;
+  uint32_t packetStartUs = 0;  // When its first message was taken
+  BLEMIDIPacket packet;
+  uint8_t bytes[3];
   
-  while (true) {
-    // Calculate clock interval from BPM
-    if (xSemaphoreTake(midiMutex, 1)) {
-      clockInterval = (unsigned long)((60000.0 / globalState.bpm) / 24.0);  // 24 PPQN
-      xSemaphoreGive(midiMutex);
-    }
-    
-    // Send MIDI clock if playing
-    if (globalState.isPlaying) {
-      unsigned long now = millis();
-      if (now - lastClockTime >= clockInterval) {
-        sendClock();
-        lastClockTime = now;
+  // Notify the packet and account latency for every message it carried
+  auto flush = [&]() {
+    if (!packet.isEmpty()) {
+      pCharacteristic->setValue((uint8_t*)packet.data(), packet.size());
+      pCharacteristic->notify();
+      
+      uint32_t now = micros();
+      LatencyTrace::midiSpan(LATENCY_NOTIFY, packetStartUs, now);
+      for (uint8_t i = 0; i < batchCount; i++) {
+        uint32_t latency = now - batchTimes[i];
+        stats.latencyLastUs = latency;
+        stats.latencyAvgUs += ((int32_t)latency - (int32_t)stats.latencyAvgUs) / 16;
+        if (latency > stats.latencyMaxUs) stats.latencyMaxUs = latency;
       }
+      stats.sent += batchCount;
+    }
+    packet.clear();
+    batchCount = 0;
+  };
+  
+  auto capture = [&](const uint8_t* data, uint8_t len, uint32_t eventUs) {
+    MIDICapture midi = {eventUs, len, {data[0], len > 1 ? data[1] : (uint8_t)0, len > 2 ? data[2] : (uint8_t)0}};
+    captured.push(midi);
+  };
+  
+  // Add one encoded message to the packet, sending the packet first if it is full
+  auto emit = [&](const uint8_t* data, uint8_t len, uint32_t eventUs) {
+    if (captureEnabled) capture(data, len, eventUs);
+    uint16_t timestamp = bleTimestamp(eventUs);
+    if (!packet.append(data, len, timestamp)) {
+      flush();
+      packet.append(data, len, timestamp);
     }
+    if (batchCount == 0) packetStartUs = micros();
+    batchTimes[batchCount++] = eventUs;
+    activeNotes.update(data, len);
+  };
+  
+  while (true) {
+    // Drain queued MIDI messages into as few BLE notifications as possible.
+    // A packet is sent when it is full, or when the queue is empty and the
+    // first message in it has waited flushDeadlineUs for more to arrive.
+    packet.setMTU(negotiatedMTU);
+    unsigned long batchStart = micros();
     
-    // Process queued MIDI messages
-    if (xQueueReceive(midiQueue, &msg, 1 / portTICK_PERIOD_MS)) {
+    while (true) {
+      // Clock/start/stop from the timer first, then due scheduled events, then the loop's ring
+      bool haveMessage = ClockEngine::popRealtime(msg);
+      
+      // Transport ticks run the generators' step handlers; what they schedule
+      // for this instant is popped from the heap straight after
+      if (haveMessage && msg.type == MIDIMessage::TICK) {
+        LatencyTrace::midiSpan(LATENCY_TICK, msg.timestampUs, micros());
+        Transport::handleTick(msg.timestampUs);
+        continue;
+      }
+      if (haveMessage && msg.type == MIDIMessage::START) Transport::handleEvent(TRANSPORT_START);
+      if (haveMessage && msg.type == MIDIMessage::CONTINUE) Transport::handleEvent(TRANSPORT_CONTINUE);
+      if (haveMessage && msg.type == MIDIMessage::STOP) Transport::handleEvent(TRANSPORT_STOP);
+      if (haveMessage && msg.data1 == MIDI_REALTIME_LOCAL) continue;  // Clock output off
+      
+      bool fromSchedule = false;
+      if (!haveMessage) {
+        uint32_t now = micros();
+        haveMessage = fromSchedule = scheduled.popDue(now, msg);
+        if (haveMessage) LatencyTrace::midiSpan(LATENCY_DUE, msg.timestampUs, now);
+      }
+      
+      if (!haveMessage) {
+        haveMessage = midiQueue.pop(msg);
+        
+        if (haveMessage && msg.type == MIDIMessage::CANCEL_SCHEDULED) {
+          scheduled.clear();
+          overlap.clear();
+          stats.scheduledPending = 0;
+          continue;
+        }
+        
+        // Not due yet - park it in the heap, it comes back out at its deadline
+        if (haveMessage && (int32_t)(msg.timestampUs - micros()) > 0) {
+          if (!scheduled.push(msg)) stats.scheduleDropped++;
+          stats.scheduledPending = scheduled.size();
+          continue;
+        }
+        if (haveMessage) LatencyTrace::midiSpan(LATENCY_QUEUE, msg.timestampUs, micros());
+      }
+      
+      if (!haveMessage) {
+        if (packet.isEmpty() || micros() - batchStart >= flushDeadlineUs) break;
+        vTaskDelay(1 / portTICK_PERIOD_MS);  // Give the loop a chance to add more
+        continue;
+      }
+      
+      // A scheduled off whose note was retriggered since ends nothing; the
+      // off of the last note-on does
+      if (msg.type == MIDIMessage::NOTE_ON || msg.type == MIDIMessage::NOTE_OFF) {
+        uint8_t ch = globalState.currentMidiChannel - 1;
+        if (msg.type == MIDIMessage::NOTE_ON && msg.data2 > 0) overlap.noteOn(ch, msg.data1);
+        else if (!fromSchedule) overlap.reset(ch, msg.data1);
+        else if (!overlap.release(ch, msg.data1)) continue;
+      }
+      if (msg.type == MIDIMessage::PANIC) overlap.clear();
+      
       if (!globalState.bleConnected) {
+        // Recordings still see the notes a run would have played. Realtime
+        // messages are left out: encoding them changes the transport state.
+        if (captureEnabled && msg.type <= MIDIMessage::PITCH_BEND) {
+          uint8_t len = encodeMessage(msg, bytes);
+          capture(bytes, len, msg.timestampUs);
+        }
+        if (msg.type == MIDIMessage::PANIC) activeNotes.clear();  // Nothing sounds without a link
         continue;  // Skip if no BLE connection
       }
       
-      uint8_t channel = globalState.currentMidiChannel - 1;  // 0-15
-      
-      switch (msg.type) {
-        case MIDIMessage::NOTE_ON:
-          midiPacket[2] = 0x90 | channel;  // Note On + channel
-          midiPacket[3] = msg.data1;       // Note
-          midiPacket[4] = msg.data2;       // Velocity
-          pCharacteristic->setValue(midiPacket, 5);
-          pCharacteristic->notify();
-          break;
-          
-        case MIDIMessage::NOTE_OFF:
-          midiPacket[2] = 0x80 | channel;  // Note Off + channel
-          midiPacket[3] = msg.data1;       // Note
-          midiPacket[4] = msg.data2;       // Velocity
-          pCharacteristic->setValue(midiPacket, 5);
-          pCharacteristic->notify();
-          break;
-          
-        case MIDIMessage::CC:
-          midiPacket[2] = 0xB0 | channel;  // CC + channel
-          midiPacket[3] = msg.data1;       // Controller
-          midiPacket[4] = msg.data2;       // Value
-          pCharacteristic->setValue(midiPacket, 5);
-          pCharacteristic->notify();
-          break;
-          
-        case MIDIMessage::PITCH_BEND:
-          {
-            uint16_t bend = msg.data16 + 8192;  // Center at 8192
-            midiPacket[2] = 0xE0 | channel;     // Pitch Bend + channel
-            midiPacket[3] = bend & 0x7F;        // LSB
-            midiPacket[4] = (bend >> 7) & 0x7F; // MSB
-            pCharacteristic->setValue(midiPacket, 5);
-            pCharacteristic->notify();
+      // Panic: release only what is actually sounding
+      if (msg.type == MIDIMessage::PANIC) {
+        for (uint8_t ch = 0; ch < 16; ch++) {
+          if (!activeNotes.anyActive(ch)) continue;
+          if (msg.data1) {
+            bytes[0] = 0xB0 | ch; bytes[1] = 123; bytes[2] = 0;  // All Notes Off
+            emit(bytes, 3, msg.timestampUs);
+          } else {
+            for (int note = activeNotes.nextActive(ch, 0); note >= 0;
+                 note = note < 127 ? activeNotes.nextActive(ch, note + 1) : -1) {
+              bytes[0] = 0x80 | ch; bytes[1] = note; bytes[2] = 0;
+              emit(bytes, 3, msg.timestampUs);
+            }
           }
-          break;
-          
-        case MIDIMessage::CLOCK:
-          midiPacket[2] = 0xF8;  // MIDI Clock
-          pCharacteristic->setValue(midiPacket, 3);
-          pCharacteristic->notify();
-          break;
-          
-        case MIDIMessage::START:
-          midiPacket[2] = 0xFA;  // MIDI Start
-          pCharacteristic->setValue(midiPacket, 3);
-          pCharacteristic->notify();
-          globalState.isPlaying = true;
-          break;
-          
-        case MIDIMessage::STOP:
-          midiPacket[2] = 0xFC;  // MIDI Stop
-          pCharacteristic->setValue(midiPacket, 3);
-          pCharacteristic->notify();
-          globalState.isPlaying = false;
-          break;
+        }
+        continue;
       }
+      
+      uint8_t len = encodeMessage(msg, bytes);
+      emit(bytes, len, msg.timestampUs);
+      
+      if (packet.isFull() || micros() - batchStart >= flushDeadlineUs) break;
+    }
+    
+    if (globalState.bleConnected) {
+      flush();
     }
+    packet.clear();
+    batchCount = 0;
     
-    vTaskDelay(1 / portTICK_PERIOD_MS);  // 1ms tick
+    ulTaskNotifyTake(pdTRUE, 1 / portTICK_PERIOD_MS);  // 1ms tick, or sooner on a clock tick
   }
 }
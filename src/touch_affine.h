@@ -0,0 +1,105 @@
+#ifndef TOUCH_AFFINE_H
+#define TOUCH_AFFINE_H
+
+#include <stdint.h>
+#include <math.h>
+
+// Raw touch panel coordinates to screen pixels with a full 2x3 affine map
+//   screenX = a*rawX + b*rawY + c
+//   screenY = d*rawX + e*rawY + f
+// which covers scale, offset, swapped axes, mirroring, rotation and skew of
+// the panel against the display in one step.
+// - solve() fits it to any number of calibration points by least squares
+//   (floating point, once per calibration) and reports the residual error
+// - apply() is the per-sample path: Q16 integer multiply-adds, no float
+//
+// Plain C++ (no Arduino) so the fit can be checked on the host.
+
+#define TOUCH_AFFINE_SHIFT 16
+
+struct TouchCalPoint {
+  int16_t screenX, screenY;  // Where the crosshair was drawn
+  uint16_t rawX, rawY;       // What the panel read there
+};
+
+struct TouchAffine {
+  int32_t m[6];          // a b c d e f in Q16
+  float errorRmsPx;      // Residual over the calibration points, after rounding to Q16
+  float errorMaxPx;
+
+  void apply(uint16_t rawX, uint16_t rawY, int32_t& x, int32_t& y) const {
+    // |a|,|b| stay far below 2^14 for any real panel (under 4 px per raw
+    // unit), so each product fits easily in 32 bits
+    const int32_t round = 1 << (TOUCH_AFFINE_SHIFT - 1);
+    x = (m[0] * (int32_t)rawX + m[1] * (int32_t)rawY + m[2] + round) >> TOUCH_AFFINE_SHIFT;
+    y = (m[3] * (int32_t)rawX + m[4] * (int32_t)rawY + m[5] + round) >> TOUCH_AFFINE_SHIFT;
+  }
+
+  // Needs at least 3 points not on one line; false if they are degenerate
+  bool solve(const TouchCalPoint* points, int count) {
+    if (count < 3) return false;
+
+    // Normal equations, with raw values centred on their mean so the sums
+    // stay well conditioned
+    double meanX = 0, meanY = 0;
+    for (int i = 0; i < count; i++) {
+      meanX += points[i].rawX;
+      meanY += points[i].rawY;
+    }
+    meanX /= count;
+    meanY /= count;
+
+    double sxx = 0, sxy = 0, syy = 0;
+    double sxU = 0, syU = 0, sU = 0;  // Against screen X
+    double sxV = 0, syV = 0, sV = 0;  // Against screen Y
+    for (int i = 0; i < count; i++) {
+      double rx = points[i].rawX - meanX;
+      double ry = points[i].rawY - meanY;
+      sxx += rx * rx;
+      sxy += rx * ry;
+      syy += ry * ry;
+      sxU += rx * points[i].screenX;
+      syU += ry * points[i].screenX;
+      sU += points[i].screenX;
+      sxV += rx * points[i].screenY;
+      syV += ry * points[i].screenY;
+      sV += points[i].screenY;
+    }
+
+    // With centred inputs the constant term separates out: 2x2 per axis
+    double det = sxx * syy - sxy * sxy;
+    if (fabs(det) < 1e-6 * (sxx * syy + 1.0)) return false;
+
+    double a = (sxU * syy - syU * sxy) / det;
+    double b = (syU * sxx - sxU * sxy) / det;
+    double c = sU / count - a * meanX - b * meanY;
+    double d = (sxV * syy - syV * sxy) / det;
+    double e = (syV * sxx - sxV * sxy) / det;
+    double f = sV / count - d * meanX - e * meanY;
+
+    const double one = (double)(1L << TOUCH_AFFINE_SHIFT);
+    const double coefficients[6] = {a, b, c, d, e, f};
+    for (int i = 0; i < 6; i++) {
+      double q = coefficients[i] * one;
+      if (q > 2147483647.0 || q < -2147483648.0) return false;
+      m[i] = (int32_t)(q < 0 ? q - 0.5 : q + 0.5);
+    }
+
+    // Residual as the device will see it (integer path)
+    double sumSq = 0, worst = 0;
+    for (int i = 0; i < count; i++) {
+      int32_t x, y;
+      apply(points[i].rawX, points[i].rawY, x, y);
+      double dx = x - points[i].screenX;
+      double dy = y - points[i].screenY;
+      double err = sqrt(dx * dx + dy * dy);
+      sumSq += err * err;
+      if (err > worst) worst = err;
+    }
+    errorRmsPx = (float)sqrt(sumSq / count);
+    errorMaxPx = (float)worst;
+    return true;
+  }
+};
+
+#endif // TOUCH_AFFINE_H
@@ -7,9 +7,16 @@
 #include <TFT_eSPI.h>
 #include <XPT2046_Touchscreen.h>
 #include "common_definitions.h"
+#include "touch_affine.h"
 
 #define CALIBRATION_FILE "/calibration.txt"
-#define CALIBRATION_MAGIC 0xCAFE
+#define CALIBRATION_MAGIC 0xCAFE          // Min/max + swap (older files)
+#define CALIBRATION_MAGIC_AFFINE 0xCAFF   // Least-squares affine transform
+#define CALIBRATION_POINTS 9              // 3x3 grid of crosshairs
+#define CALIBRATION_MIN_POINTS 5          // Fewer than this and calibration fails
+#define CALIBRATION_INSET 30              // Crosshair distance from the screen edges
+#define CALIBRATION_MAX_RMS_PX 6.0f       // Worse than this and the user is asked again
+#define CALIBRATION_ATTEMPTS 3
 
 struct TouchCalibration {
   uint16_t magic;
@@ -20,6 +27,8 @@ struct TouchCalibration {
   bool swap_xy;
   uint8_t rotation;  // 0, 1, 2, or 3 for 0°, 90°, 180°, 270°
   bool valid;
+  bool useAffine;      // Set for CALIBRATION_MAGIC_AFFINE; min/max fields unused then
+  TouchAffine affine;  // Raw to screen, already in the display rotation
 };
 
 extern TFT_eSPI tft;
@@ -36,9 +45,10 @@ inline void drawCalibrationCrosshair(int x, int y, uint16_t color) {
 }
 
 inline bool waitForTouch(int targetX, int targetY, uint16_t &rawX, uint16_t &rawY) {
-  // Draw instruction
+  // Draw instruction, clear of crosshairs on the bottom row
+  int textY = targetY > SCREEN_HEIGHT - 80 ? SCREEN_HEIGHT/2 + 30 : SCREEN_HEIGHT - 40;
   tft.setTextColor(TFT_WHITE, TFT_BLACK);
-  tft.drawCentreString("Touch the crosshair", SCREEN_WIDTH/2, SCREEN_HEIGHT - 40, 4);
+  tft.drawCentreString("Touch the crosshair", SCREEN_WIDTH/2, textY, 4);
   
   unsigned long timeout = millis() + 30000; // 30 second timeout
   bool touched = false;
@@ -47,24 +57,34 @@ inline bool waitForTouch(int targetX, int targetY, uint16_t &rawX, uint16_t &raw
   while (millis() < timeout && !touched) {
     if (ts.tirqTouched() && ts.touched()) {
       delay(50); // Debounce
-      if (ts.touched()) {
+      
+      // Average a few readings while the finger rests on the crosshair
+      uint32_t sumX = 0, sumY = 0;
+      int samples = 0;
+      for (int i = 0; i < 16 && ts.touched(); i++) {
         TS_Point p = ts.getPoint();
-        rawX = p.x;
-        rawY = p.y;
+        sumX += p.x;
+        sumY += p.y;
+        samples++;
+        delay(5);
+      }
+      if (samples >= 4) {
+        rawX = sumX / samples;
+        rawY = sumY / samples;
         touched = true;
         
         // Visual feedback
         drawCalibrationCrosshair(targetX, targetY, TFT_GREEN);
-        tft.fillRect(0, SCREEN_HEIGHT - 50, SCREEN_WIDTH, 50, TFT_BLACK);
-        tft.drawCentreString("Got it!", SCREEN_WIDTH/2, SCREEN_HEIGHT - 30, 4);
+        tft.fillRect(0, textY - 10, SCREEN_WIDTH, 50, TFT_BLACK);
+        tft.drawCentreString("Got it!", SCREEN_WIDTH/2, textY, 4);
         delay(500);
-        
-        // Wait for release
-        while (ts.touched()) {
-          delay(10);
-        }
-        delay(200);
       }
+      
+      // Wait for release
+      while (ts.touched()) {
+        delay(10);
+      }
+      delay(200);
     }
     delay(10);
   }
@@ -82,110 +102,68 @@ inline bool performCalibration() {
   
   delay(2000);
   
-  // Define calibration points (screen coordinates)
-  struct CalPoint {
-    int screenX, screenY;
-    uint16_t rawX, rawY;
-  };
+  // 3x3 grid of calibration points (screen coordinates), edges included
+  // so the fit is accurate where the old min/max scaling was worst
+  TouchCalPoint points[CALIBRATION_POINTS];
+  const int16_t columns[3] = {CALIBRATION_INSET, SCREEN_WIDTH/2, SCREEN_WIDTH - CALIBRATION_INSET};
+  const int16_t rows[3] = {CALIBRATION_INSET, SCREEN_HEIGHT/2, SCREEN_HEIGHT - CALIBRATION_INSET};
   
-  CalPoint points[3] = {
-    {40, 40, 0, 0},                              // Top-left
-    {SCREEN_WIDTH - 40, SCREEN_HEIGHT/2, 0, 0},  // Right-center
-    {40, SCREEN_HEIGHT - 40, 0, 0}               // Bottom-left
-  };
+  // Raw readings are taken in the touch rotation used from now on
+  ts.setRotation(tft.getRotation());
   
-  // Collect touch data for each point
-  for (int i = 0; i < 3; i++) {
-    tft.fillScreen(TFT_BLACK);
-    tft.setTextColor(TFT_CYAN, TFT_BLACK);
-    char msg[32];
-    sprintf(msg, "Point %d of 3", i + 1);
-    tft.drawCentreString(msg, SCREEN_WIDTH/2, 20, 4);
-    
-    drawCalibrationCrosshair(points[i].screenX, points[i].screenY, TFT_RED);
+  TouchAffine best;
+  bool solved = false;
+  
+  for (int attempt = 0; attempt < CALIBRATION_ATTEMPTS; attempt++) {
+    // Collect touch data for each point; after a timeout, use what we have
+    int collected = 0;
+    for (int i = 0; i < CALIBRATION_POINTS; i++) {
+      TouchCalPoint& point = points[collected];
+      point.screenX = columns[i % 3];
+      point.screenY = rows[i / 3];
+      
+      tft.fillScreen(TFT_BLACK);
+      tft.setTextColor(TFT_CYAN, TFT_BLACK);
+      char msg[32];
+      sprintf(msg, "Point %d of %d", i + 1, CALIBRATION_POINTS);
+      tft.drawCentreString(msg, SCREEN_WIDTH/2, 20 + (point.screenY < 80 ? SCREEN_HEIGHT/2 - 40 : 0), 4);
+      
+      drawCalibrationCrosshair(point.screenX, point.screenY, TFT_RED);
+      
+      if (!waitForTouch(point.screenX, point.screenY, point.rawX, point.rawY)) break;
+      collected++;
+    }
     
-    if (!waitForTouch(points[i].screenX, points[i].screenY, 
-                      points[i].rawX, points[i].rawY)) {
+    TouchAffine fit;
+    if (collected < CALIBRATION_MIN_POINTS || !fit.solve(points, collected)) {
       tft.fillScreen(TFT_BLACK);
       tft.setTextColor(TFT_RED, TFT_BLACK);
-      tft.drawCentreString("CALIBRATION TIMEOUT", SCREEN_WIDTH/2, SCREEN_HEIGHT/2, 4);
+      tft.drawCentreString(collected < CALIBRATION_MIN_POINTS ? "CALIBRATION TIMEOUT" : "CALIBRATION FAILED",
+                           SCREEN_WIDTH/2, SCREEN_HEIGHT/2, 4);
       delay(2000);
-      return false;
+      if (collected < CALIBRATION_MIN_POINTS) return false;
+      continue;
     }
-  }
-  
-  // Calculate calibration values
-  calibration.x_min = points[0].rawX;
-  calibration.x_max = points[1].rawX;
-  calibration.y_min = points[0].rawY;
-  calibration.y_max = points[2].rawY;
-  
-  // Determine if we need to swap X and Y
-  int xRange = abs((int)calibration.x_max - (int)calibration.x_min);
-  int yRange = abs((int)calibration.y_max - (int)calibration.y_min);
-  calibration.swap_xy = (xRange < yRange);
-  
-  if (calibration.swap_xy) {
-    uint16_t temp = calibration.x_min;
-    calibration.x_min = calibration.y_min;
-    calibration.y_min = temp;
-    temp = calibration.x_max;
-    calibration.x_max = calibration.y_max;
-    calibration.y_max = temp;
-  }
-  
-  // Ensure min < max
-  if (calibration.x_min > calibration.x_max) {
-    uint16_t temp = calibration.x_min;
-    calibration.x_min = calibration.x_max;
-    calibration.x_max = temp;
-  }
-  if (calibration.y_min > calibration.y_max) {
-    uint16_t temp = calibration.y_min;
-    calibration.y_min = calibration.y_max;
-    calibration.y_max = temp;
-  }
-  
-  // Detect rotation by testing a fourth point
-  tft.fillScreen(TFT_BLACK);
-  tft.setTextColor(TFT_CYAN, TFT_BLACK);
-  tft.drawCentreString("Testing rotation...", SCREEN_WIDTH/2, 20, 4);
-  tft.drawCentreString("Touch the crosshair", SCREEN_WIDTH/2, 60, 2);
-  
-  // Test point at bottom-right (opposite of top-left)
-  uint16_t testRawX, testRawY;
-  int testPointX = SCREEN_WIDTH - 40;
-  int testPointY = SCREEN_HEIGHT - 40;
-  drawCalibrationCrosshair(testPointX, testPointY, TFT_YELLOW);
-  
-  if (waitForTouch(testPointX, testPointY, testRawX, testRawY)) {
-    // Map test point with current calibration
-    int testX = map(testRawX, calibration.x_min, calibration.x_max, 0, SCREEN_WIDTH);
-    int testY = map(testRawY, calibration.y_min, calibration.y_max, 0, SCREEN_HEIGHT);
     
-    // Determine rotation based on where the test point landed
-    // For 320×240 landscape, rotation=1 is correct (USB on right)
-    // We assume landscape orientation for all CYD boards
+    Serial.printf("Touch calibration: %d points, error %.2f px RMS, %.2f px max\n",
+                  collected, fit.errorRmsPx, fit.errorMaxPx);
+    if (!solved || fit.errorRmsPx < best.errorRmsPx) best = fit;
+    solved = true;
+    if (fit.errorRmsPx <= CALIBRATION_MAX_RMS_PX) break;
     
-    if (testX < SCREEN_WIDTH/2 && testY < SCREEN_HEIGHT/2) {
-      // Touch landed in top-left quadrant instead of bottom-right - 180° rotation
-      calibration.rotation = 2;
-    } else if (testX < SCREEN_WIDTH/2 && testY > SCREEN_HEIGHT/2) {
-      // Touch landed in bottom-left quadrant instead of bottom-right - possible 90° rotation
-      calibration.rotation = 3;
-    } else if (testX > SCREEN_WIDTH/2 && testY < SCREEN_HEIGHT/2) {
-      // Touch landed in top-right quadrant instead of bottom-right - possible 270° rotation
-      calibration.rotation = 1;
-    } else {
-      // Touch landed in correct quadrant - use rotation 1 for landscape
-      calibration.rotation = 1;
-    }
-  } else {
-    // Timeout on test point, assume landscape rotation 1
-    calibration.rotation = 1;
+    // A badly placed touch spoils the fit - go round again
+    tft.fillScreen(TFT_BLACK);
+    tft.setTextColor(TFT_ORANGE, TFT_BLACK);
+    tft.drawCentreString("INACCURATE - AGAIN PLEASE", SCREEN_WIDTH/2, SCREEN_HEIGHT/2, 4);
+    delay(2000);
   }
+  if (!solved) return false;
   
-  calibration.magic = CALIBRATION_MAGIC;
+  // The transform maps straight to pixels in the current display rotation
+  calibration.affine = best;
+  calibration.useAffine = true;
+  calibration.rotation = tft.getRotation();
+  calibration.magic = CALIBRATION_MAGIC_AFFINE;
   calibration.valid = true;
   
   // Show results
@@ -194,15 +172,11 @@ inline bool performCalibration() {
   tft.drawCentreString("CALIBRATION COMPLETE", SCREEN_WIDTH/2, SCREEN_HEIGHT/2 - 60, 4);
   tft.setTextColor(TFT_WHITE, TFT_BLACK);
   char buffer[64];
-  sprintf(buffer, "X: %d - %d", calibration.x_min, calibration.x_max);
-  tft.drawCentreString(buffer, SCREEN_WIDTH/2, SCREEN_HEIGHT/2 - 20, 2);
-  sprintf(buffer, "Y: %d - %d", calibration.y_min, calibration.y_max);
-  tft.drawCentreString(buffer, SCREEN_WIDTH/2, SCREEN_HEIGHT/2 + 5, 2);
-  sprintf(buffer, "Swap XY: %s", calibration.swap_xy ? "Yes" : "No");
-  tft.drawCentreString(buffer, SCREEN_WIDTH/2, SCREEN_HEIGHT/2 + 30, 2);
+  sprintf(buffer, "Error: %.1f px RMS, %.1f px max", best.errorRmsPx, best.errorMaxPx);
+  tft.drawCentreString(buffer, SCREEN_WIDTH/2, SCREEN_HEIGHT/2 - 10, 2);
   sprintf(buffer, "Rotation: %d deg", calibration.rotation * 90);
-  tft.drawCentreString(buffer, SCREEN_WIDTH/2, SCREEN_HEIGHT/2 + 55, 2);
-  tft.drawCentreString("Saving to memory...", SCREEN_WIDTH/2, SCREEN_HEIGHT/2 + 90, 2);
+  tft.drawCentreString(buffer, SCREEN_WIDTH/2, SCREEN_HEIGHT/2 + 20, 2);
+  tft.drawCentreString("Saving to memory...", SCREEN_WIDTH/2, SCREEN_HEIGHT/2 + 60, 2);
   
   delay(2000);
   
@@ -228,6 +202,7 @@ inline void initTouchCalibration() {
       calibration.y_max = 3800;
       calibration.swap_xy = false;
       calibration.rotation = 1;  // Always use rotation 1 for landscape
+      calibration.useAffine = false;
       calibration.valid = true;
     }
   }
@@ -237,6 +212,59 @@ inline void initTouchCalibration() {
 // which has access to SD_CS #define and sdSPI object
 // We don't define it here to avoid linker issues
 
+// Raw panel reading to screen coordinates (the TouchThread's TouchMapper)
+inline bool mapTouchPoint(uint16_t rawX, uint16_t rawY, int16_t& x, int16_t& y) {
+  if (!calibration.valid) return false;
+  
+  if (calibration.useAffine) {
+    int32_t affineX, affineY;
+    calibration.affine.apply(rawX, rawY, affineX, affineY);
+    x = constrain(affineX, 0, SCREEN_WIDTH - 1);
+    y = constrain(affineY, 0, SCREEN_HEIGHT - 1);
+    return true;
+  }
+  
+  // Apply XY swap if calibrated that way
+  if (calibration.swap_xy) {
+    uint16_t temp = rawX;
+    rawX = rawY;
+    rawY = temp;
+  }
+  
+  // Map using calibrated values to screen dimensions
+  int mappedX = map(rawX, calibration.x_min, calibration.x_max, 0, SCREEN_WIDTH);
+  int mappedY = map(rawY, calibration.y_min, calibration.y_max, 0, SCREEN_HEIGHT);
+  int screenX, screenY;
+  
+  // Apply rotation (default to 0 if not set)
+  uint8_t rot = calibration.rotation;
+  if (rot > 3) rot = 0;  // Safety check
+  
+  switch (rot) {
+    case 0:  // No rotation
+      screenX = mappedX;
+      screenY = mappedY;
+      break;
+    case 1:  // 90° clockwise
+      screenX = SCREEN_HEIGHT - mappedY;
+      screenY = mappedX;
+      break;
+    case 2:  // 180°
+      screenX = SCREEN_WIDTH - mappedX;
+      screenY = SCREEN_HEIGHT - mappedY;
+      break;
+    default:  // 270° clockwise (90° counter-clockwise)
+      screenX = mappedY;
+      screenY = SCREEN_WIDTH - mappedX;
+      break;
+  }
+  
+  // Constrain to screen bounds
+  x = constrain(screenX, 0, SCREEN_WIDTH - 1);
+  y = constrain(screenY, 0, SCREEN_HEIGHT - 1);
+  return true;
+}
+
 // Test calibration by showing touch points
 inline void testCalibration() {
   tft.fillScreen(TFT_BLACK);
@@ -265,21 +293,8 @@ inline void testCalibration() {
       }
       
       TS_Point p = ts.getPoint();
-      uint16_t rawX = p.x;
-      uint16_t rawY = p.y;
-      
-      if (calibration.swap_xy) {
-        uint16_t temp = rawX;
-        rawX = rawY;
-        rawY = temp;
-      }
-      
-      int mappedX = map(rawX, calibration.x_min, calibration.x_max, 0, SCREEN_WIDTH);
-      int mappedY = map(rawY, calibration.y_min, calibration.y_max, 0, SCREEN_HEIGHT);
-      
-      // Constrain to screen bounds
-      mappedX = constrain(mappedX, 0, SCREEN_WIDTH - 1);
-      mappedY = constrain(mappedY, 0, SCREEN_HEIGHT - 1);
+      int16_t mappedX, mappedY;
+      if (!mapTouchPoint(p.x, p.y, mappedX, mappedY)) continue;
       
       // Draw crosshair at touch point
       tft.fillCircle(mappedX, mappedY, 3, TFT_RED);
@@ -0,0 +1,22 @@
+#ifndef TOUCH_EVENT_H
+#define TOUCH_EVENT_H
+
+#include <stdint.h>
+
+// One change of touch state, as sampled by the touch task
+// Plain C++ so recordings of these can be replayed on the host.
+
+enum TouchEventType : uint8_t {
+  TOUCH_PRESS,
+  TOUCH_MOVE,
+  TOUCH_RELEASE
+};
+
+struct TouchEvent {
+  uint32_t timestampUs;  // micros() of the sample
+  int16_t x, y;          // Screen coordinates
+  TouchEventType type;
+  uint8_t velocity;      // 1-127 from the press pressure (same for its moves/release)
+};
+
+#endif // TOUCH_EVENT_H
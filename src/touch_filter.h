@@ -0,0 +1,218 @@
+#ifndef TOUCH_FILTER_H
+#define TOUCH_FILTER_H
+
+#include <stdint.h>
+
+// Filter chain for raw XPT2046 samples (panel units, before calibration)
+// 1. Press debounce: a touch counts after pressSamples readings at or above
+//    pressZ, so a single noisy pressure spike never presses
+// 2. Median of the last medianSize readings per axis - drops the odd
+//    reading that lands far off while the finger is still on the panel.
+//    Each reading is first moved on by the finger's estimated velocity times
+//    its age, so on a drag the median does not trail a sample behind.
+// 3. Adaptive IIR: heavy smoothing (alphaSlow) while the finger is still,
+//    light smoothing (alphaFast) once it moves, so resting fingers do not
+//    jitter and drags do not lag. The filtered position is carried forward
+//    by the same velocity before each new reading is blended in.
+// 4. Release hysteresis: once pressed, readings down to releaseZ still hold
+//    the touch, and only releaseSamples weak readings in a row release it
+// The strongest pressure (Z, larger = harder) seen during the press debounce
+// becomes a 1-127 velocity. That window is short, so it measures how quickly
+// the press builds up as much as how hard it ends up.
+//
+// Plain C++ (no Arduino) so it can be replayed against recorded traces on
+// the host - see bench/touch_filter_bench.cpp.
+
+#define TOUCH_FILTER_MAX_MEDIAN 5
+
+enum TouchVelocityCurve : uint8_t {
+  VELOCITY_LINEAR,
+  VELOCITY_SOFT,    // Light touches come out louder
+  VELOCITY_HARD     // Needs a firm press for high velocities
+};
+
+struct TouchFilterConfig {
+  uint8_t medianSize = 3;        // 1 (off), 3 or 5
+  uint16_t alphaSlow = 48;       // IIR weight of a new sample while still (/256)
+  uint16_t alphaFast = 224;      // ... while moving (256 = no smoothing)
+  uint16_t stillRange = 12;      // Raw units of wobble treated as "still"
+  uint16_t moveRange = 40;       // Raw units from which alphaFast applies
+  uint16_t trendAlpha = 24;      // Weight of new movement in the velocity (/256, 0 = off)
+  uint16_t pressZ = 450;         // Pressure needed to start a touch
+  uint16_t releaseZ = 300;       // Pressure that keeps a touch going
+  uint8_t pressSamples = 2;      // Readings above pressZ before the press
+  uint8_t releaseSamples = 2;    // Readings below releaseZ before the release
+  uint16_t velocityZMin = 450;   // Pressure for velocity 1
+  uint16_t velocityZMax = 2000;  // Pressure for velocity 127
+  TouchVelocityCurve velocityCurve = VELOCITY_SOFT;
+};
+
+enum TouchFilterEvent : uint8_t {
+  FILTER_IDLE,      // Not touched
+  FILTER_PRESS,     // Touch started this sample
+  FILTER_DOWN,      // Still touched (position may have moved)
+  FILTER_RELEASE    // Touch ended this sample
+};
+
+class TouchFilter {
+public:
+  TouchFilter() { reset(); }
+  explicit TouchFilter(const TouchFilterConfig& c) { configure(c); }
+
+  void configure(const TouchFilterConfig& c) {
+    config = c;
+    if (config.medianSize < 1) config.medianSize = 1;
+    if (config.medianSize > TOUCH_FILTER_MAX_MEDIAN) config.medianSize = TOUCH_FILTER_MAX_MEDIAN;
+    reset();
+  }
+  const TouchFilterConfig& getConfig() const { return config; }
+
+  void reset() {
+    down = false;
+    count = 0;
+    head = 0;
+    pressCount = 0;
+    weakCount = 0;
+    peakZ = 0;
+    filteredX = filteredY = 0;
+    velocityX = velocityY = 0;
+    vel = 1;
+  }
+
+  // One reading per sample period; z = 0 when the panel reports no touch
+  TouchFilterEvent update(uint16_t rawX, uint16_t rawY, uint16_t z) {
+    if (!down) {
+      if (z < config.pressZ) {
+        pressCount = 0;
+        count = 0;
+        return FILTER_IDLE;
+      }
+      push(rawX, rawY);
+      if (pressCount == 0 || z > peakZ) peakZ = z;
+      if (++pressCount < config.pressSamples) return FILTER_IDLE;
+
+      // Start the smoothing at the first settled position - no lag on press
+      down = true;
+      weakCount = 0;
+      filteredX = (int32_t)medianX() << 4;
+      filteredY = (int32_t)medianY() << 4;
+      velocityX = velocityY = 0;
+      vel = velocityFor(peakZ);
+      return FILTER_PRESS;
+    }
+
+    if (z < config.releaseZ) {
+      // Hold the last position through short pressure dropouts
+      if (++weakCount >= config.releaseSamples) {
+        down = false;
+        pressCount = 0;
+        count = 0;
+        return FILTER_RELEASE;
+      }
+      return FILTER_DOWN;
+    }
+    weakCount = 0;
+
+    push(rawX, rawY);
+    track(filteredX, velocityX, xs);
+    track(filteredY, velocityY, ys);
+    return FILTER_DOWN;
+  }
+
+  bool isDown() const { return down; }
+  uint16_t x() const { return (uint16_t)((filteredX + 8) >> 4); }
+  uint16_t y() const { return (uint16_t)((filteredY + 8) >> 4); }
+  uint8_t velocity() const { return vel; }  // Of the current/last press
+
+  // Pressure to velocity on the configured curve (1-127)
+  uint8_t velocityFor(uint16_t z) const {
+    if (config.velocityZMax <= config.velocityZMin) return 100;
+    int32_t span = config.velocityZMax - config.velocityZMin;
+    int32_t t = ((int32_t)z - config.velocityZMin) * 1024 / span;  // 0-1024
+    if (t < 0) t = 0;
+    if (t > 1024) t = 1024;
+    switch (config.velocityCurve) {
+      case VELOCITY_SOFT: t = 2 * t - (t * t >> 10); break;
+      case VELOCITY_HARD: t = t * t >> 10; break;
+      default: break;
+    }
+    return (uint8_t)(1 + (t * 126 + 512) / 1024);
+  }
+
+private:
+  TouchFilterConfig config;
+  bool down;
+  uint16_t xs[TOUCH_FILTER_MAX_MEDIAN], ys[TOUCH_FILTER_MAX_MEDIAN];
+  uint8_t count;        // Readings in the median window
+  uint8_t head;
+  uint8_t pressCount;   // Strong readings while not yet pressed
+  uint8_t weakCount;    // Weak readings in a row while pressed
+  uint16_t peakZ;       // Strongest reading during the press debounce
+  int32_t filteredX, filteredY;  // Q4 (1/16 raw unit) so slow smoothing still converges
+  int32_t velocityX, velocityY;  // Q4 raw units per reading
+  uint8_t vel;
+
+  void push(uint16_t rawX, uint16_t rawY) {
+    if (count == 0) head = 0;
+    xs[head] = rawX;
+    ys[head] = rawY;
+    head = (head + 1) % config.medianSize;
+    if (count < config.medianSize) count++;
+  }
+
+  static int32_t medianOf(int32_t* values, uint8_t n) {
+    for (uint8_t i = 1; i < n; i++) {
+      int32_t v = values[i];
+      uint8_t j = i;
+      while (j > 0 && values[j - 1] > v) {
+        values[j] = values[j - 1];
+        j--;
+      }
+      values[j] = v;
+    }
+    return values[n / 2];
+  }
+
+  // Median of the window as it stands, without any velocity (Q0)
+  uint16_t median(const uint16_t* values) const {
+    int32_t window[TOUCH_FILTER_MAX_MEDIAN];
+    for (uint8_t i = 0; i < count; i++) window[i] = values[i];
+    return (uint16_t)medianOf(window, count);
+  }
+  uint16_t medianX() const { return median(xs); }
+  uint16_t medianY() const { return median(ys); }
+
+  // Stages 2 and 3 for one axis: the window, each reading moved on by
+  // velocity times its age (newest first), its median, and the IIR
+  void track(int32_t& filtered, int32_t& velocity, const uint16_t* values) {
+    int32_t window[TOUCH_FILTER_MAX_MEDIAN];
+    for (uint8_t age = 0; age < count; age++) {
+      uint8_t i = (head + config.medianSize - 1 - age) % config.medianSize;
+      window[age] = ((int32_t)values[i] << 4) + age * velocity;
+    }
+    int32_t before = filtered;
+    filtered += velocity;
+    smooth(filtered, medianOf(window, count));
+    velocity += ((filtered - before) - velocity) * (int32_t)config.trendAlpha / 256;
+  }
+
+  // The further the new position is from the filtered one, the more it
+  // counts: still fingers average out, moving ones are followed closely.
+  // Both in Q4.
+  void smooth(int32_t& filtered, int32_t target) {
+    int32_t error = target - filtered;
+    int32_t distance = (error < 0 ? -error : error) >> 4;
+    int32_t alpha;
+    if (distance <= config.stillRange) {
+      alpha = config.alphaSlow;
+    } else if (distance >= config.moveRange || config.moveRange <= config.stillRange) {
+      alpha = config.alphaFast;
+    } else {
+      alpha = config.alphaSlow + (int32_t)(config.alphaFast - config.alphaSlow) *
+              (distance - config.stillRange) / (config.moveRange - config.stillRange);
+    }
+    filtered += error * alpha / 256;
+  }
+};
+
+#endif // TOUCH_FILTER_H
@@ -0,0 +1,209 @@
+#include "touch_recorder.h"
+#include "common_definitions.h"
+#include "web_server.h"  // sdSPI, sdCardAvailable, SD_CS
+#include <SD.h>
+
+#define TOUCH_REPLAY_TAIL_US 1000000  // Wait for the replay's last notes to end before saving
+
+TouchEvent* TouchRecorder::touchBuffer = nullptr;
+uint32_t TouchRecorder::touchCount = 0;
+MIDICapture* TouchRecorder::midiBuffer = nullptr;
+uint32_t TouchRecorder::midiCount = 0;
+uint32_t TouchRecorder::originUs = 0;
+uint32_t TouchRecorder::lostEvents = 0;
+bool TouchRecorder::recording = false;
+
+TouchEvent* TouchRecorder::replayBuffer = nullptr;
+TouchReplay TouchRecorder::replay;
+bool TouchRecorder::replaying = false;
+bool TouchRecorder::releasePending = false;
+TouchEvent TouchRecorder::pendingRelease;
+char TouchRecorder::replaySaveAs[32] = "";
+uint32_t TouchRecorder::replayEndUs = 0;
+
+bool TouchRecorder::startRecording() {
+  if (recording) return true;
+
+  touchBuffer = (TouchEvent*)malloc(sizeof(TouchEvent) * TOUCH_RECORD_MAX_EVENTS);
+  midiBuffer = (MIDICapture*)malloc(sizeof(MIDICapture) * TOUCH_RECORD_MAX_MIDI);
+  if (!touchBuffer || !midiBuffer) {
+    Serial.println("[TouchRecorder] Not enough memory to record");
+    freeRecording();
+    return false;
+  }
+
+  touchCount = 0;
+  midiCount = 0;
+  lostEvents = 0;
+  originUs = micros();
+  recording = true;
+  MIDIThread::setCapture(true);
+  Serial.println("[TouchRecorder] Recording");
+  return true;
+}
+
+void TouchRecorder::cancelRecording() {
+  if (!recording) return;
+  MIDIThread::setCapture(false);
+  recording = false;
+  freeRecording();
+}
+
+void TouchRecorder::freeRecording() {
+  free(touchBuffer);
+  free(midiBuffer);
+  touchBuffer = nullptr;
+  midiBuffer = nullptr;
+}
+
+bool TouchRecorder::mount() {
+  if (!sdCardAvailable) return false;
+  SD.end();
+  delay(10);
+  return SD.begin(SD_CS, sdSPI);
+}
+
+bool TouchRecorder::stopRecording(const char* name) {
+  if (!recording) return false;
+  update();  // Last of the MIDI
+  MIDIThread::setCapture(false);
+  recording = false;
+
+  bool saved = false;
+  if (mount()) {
+    if (!SD.exists(TOUCH_RECORDING_DIR)) SD.mkdir(TOUCH_RECORDING_DIR);
+    String path = String(TOUCH_RECORDING_DIR) + "/" + name + ".txt";
+    File file = SD.open(path, FILE_WRITE);
+    if (file) {
+      file.println(TOUCH_RECORDING_HEADER);
+      file.printf("# %lu touch events, %lu MIDI messages, %lu lost\n",
+                  (unsigned long)touchCount, (unsigned long)midiCount, (unsigned long)lostEvents);
+
+      // Both lists are in time order already; merge them
+      char line[TOUCH_RECORDING_LINE];
+      uint32_t t = 0, m = 0;
+      while (t < touchCount || m < midiCount) {
+        bool touchFirst = m >= midiCount ||
+          (t < touchCount && (int32_t)(touchBuffer[t].timestampUs - midiBuffer[m].timestampUs) <= 0);
+        if (touchFirst) {
+          formatTouchLine(line, sizeof(line), touchBuffer[t++], originUs);
+        } else {
+          formatMIDILine(line, sizeof(line), midiBuffer[m++], originUs);
+        }
+        file.println(line);
+      }
+      file.close();
+      saved = true;
+      Serial.printf("[TouchRecorder] Saved %s (%lu touch, %lu MIDI)\n", path.c_str(),
+                    (unsigned long)touchCount, (unsigned long)midiCount);
+    }
+    SD.end();
+  }
+  if (!saved) Serial.println("[TouchRecorder] Could not save the recording");
+
+  freeRecording();
+  return saved;
+}
+
+bool TouchRecorder::startReplay(const char* name, const char* saveAs) {
+  stopReplay();
+  if (!mount()) return false;
+
+  String path = String(TOUCH_RECORDING_DIR) + "/" + name + ".txt";
+  File file = SD.open(path, FILE_READ);
+  if (!file) {
+    Serial.printf("[TouchRecorder] No recording %s\n", path.c_str());
+    SD.end();
+    return false;
+  }
+
+  replayBuffer = (TouchEvent*)malloc(sizeof(TouchEvent) * TOUCH_RECORD_MAX_EVENTS);
+  if (!replayBuffer) {
+    Serial.println("[TouchRecorder] Not enough memory to replay");
+    file.close();
+    SD.end();
+    return false;
+  }
+
+  // Only the touch lines are replayed; the MIDI lines are the expected output
+  uint32_t count = 0;
+  char line[TOUCH_RECORDING_LINE];
+  TouchEvent event;
+  MIDICapture midi;
+  while (file.available() && count < TOUCH_RECORD_MAX_EVENTS) {
+    size_t n = file.readBytesUntil('\n', line, sizeof(line) - 1);
+    line[n] = '\0';
+    if (parseRecordingLine(line, event, midi) == RECORDING_TOUCH) {
+      replayBuffer[count++] = event;
+    }
+  }
+  file.close();
+  SD.end();
+
+  if (count == 0) {
+    free(replayBuffer);
+    replayBuffer = nullptr;
+    return false;
+  }
+
+  strlcpy(replaySaveAs, saveAs ? saveAs : "", sizeof(replaySaveAs));
+  if (replaySaveAs[0] && !startRecording()) replaySaveAs[0] = '\0';
+
+  replay.begin(replayBuffer, count, micros());
+  replaying = true;
+  replayEndUs = 0;
+  Serial.printf("[TouchRecorder] Replaying %s (%lu events)\n", path.c_str(), (unsigned long)count);
+  return true;
+}
+
+void TouchRecorder::stopReplay() {
+  if (!replaying) return;
+  releasePending = replay.stop(micros(), pendingRelease);
+  replaying = false;
+  free(replayBuffer);
+  replayBuffer = nullptr;
+  if (replaySaveAs[0]) {
+    cancelRecording();  // An interrupted run is no reference
+    replaySaveAs[0] = '\0';
+  }
+  Serial.println("[TouchRecorder] Replay stopped");
+}
+
+bool TouchRecorder::popReplay(TouchEvent& event) {
+  if (releasePending) {
+    releasePending = false;
+    event = pendingRelease;
+    return true;
+  }
+  return replaying && replay.next(micros(), event);
+}
+
+void TouchRecorder::record(const TouchEvent& event) {
+  if (!recording) return;
+  if (touchCount < TOUCH_RECORD_MAX_EVENTS) touchBuffer[touchCount++] = event;
+  else lostEvents++;
+}
+
+void TouchRecorder::update() {
+  if (recording) {
+    MIDICapture midi;
+    while (MIDIThread::popCapture(midi)) {
+      if (midiCount < TOUCH_RECORD_MAX_MIDI) midiBuffer[midiCount++] = midi;
+      else lostEvents++;
+    }
+  }
+
+  if (replaying && replay.finished()) {
+    if (replayEndUs == 0) replayEndUs = micros() | 1;
+    if (micros() - replayEndUs < TOUCH_REPLAY_TAIL_US) return;
+
+    Serial.printf("[TouchRecorder] Replay done (%lu events)\n", (unsigned long)replay.total());
+    replaying = false;
+    free(replayBuffer);
+    replayBuffer = nullptr;
+    if (replaySaveAs[0]) {
+      stopRecording(replaySaveAs);
+      replaySaveAs[0] = '\0';
+    }
+  }
+}
@@ -0,0 +1,59 @@
+#ifndef TOUCH_RECORDER_H
+#define TOUCH_RECORDER_H
+
+#include <stdint.h>
+#include "touch_recording.h"
+
+// Records the touch event stream (and the MIDI it produced) to SD, and
+// replays a recording through updateTouch() in place of the touch task
+// - Recording keeps everything in RAM and writes the file on stop, so the
+//   loop never waits for the card mid-performance
+// - A replay can be recorded at the same time; the file written when it
+//   ends holds the replayed touches plus this run's MIDI, ready to compare
+// - A real touch during a replay stops it
+// Files live in TOUCH_RECORDING_DIR (format: touch_recording.h). Loop task only.
+
+#define TOUCH_RECORDING_DIR "/recordings"
+#define TOUCH_RECORD_MAX_EVENTS 2048  // ~2 minutes of steady playing
+#define TOUCH_RECORD_MAX_MIDI 2048
+
+class TouchRecorder {
+public:
+  static bool startRecording();
+  static bool stopRecording(const char* name);  // Writes TOUCH_RECORDING_DIR/<name>.txt
+  static void cancelRecording();
+  
+  // saveAs: record the replayed run under that name when it finishes (nullptr: don't)
+  static bool startReplay(const char* name, const char* saveAs = nullptr);
+  static void stopReplay();
+  
+  static bool isRecording() { return recording; }
+  static bool isReplaying() { return replaying; }
+  
+  // Called by updateTouch()
+  static bool popReplay(TouchEvent& event);  // Next replayed event due now
+  static void record(const TouchEvent& event);
+  static void update();                      // Collects MIDI, finishes replays
+  
+private:
+  static TouchEvent* touchBuffer;
+  static uint32_t touchCount;
+  static MIDICapture* midiBuffer;
+  static uint32_t midiCount;
+  static uint32_t originUs;
+  static uint32_t lostEvents;
+  static bool recording;
+  
+  static TouchEvent* replayBuffer;
+  static TouchReplay replay;
+  static bool replaying;
+  static bool releasePending;  // Lift the finger of a stopped replay
+  static TouchEvent pendingRelease;
+  static char replaySaveAs[32];
+  static uint32_t replayEndUs;         // When the last event was played (0: not yet)
+  
+  static void freeRecording();
+  static bool mount();
+};
+
+#endif // TOUCH_RECORDER_H
@@ -0,0 +1,132 @@
+#ifndef TOUCH_RECORDING_H
+#define TOUCH_RECORDING_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "touch_event.h"
+
+// Text format of touch recordings, one line per event, times in
+// microseconds from the start of the recording:
+//   T <us> <P|M|R> <x> <y> <velocity>   touch event (calibrated screen coordinates)
+//   M <us> <status> [<data1> [<data2>]]  MIDI message that went out (hex bytes)
+//   # ...                                comment
+// Touch lines are what updateTouch() took from the touch task, so replaying
+// them drives the same path (touch state, gestures, modes) as a finger did.
+// MIDI lines are the output of that run; a replay recorded alongside gives
+// the same M lines again if nothing regressed.
+//
+// Plain C++ (no Arduino) so recordings can be read and replayed on the host.
+
+#define TOUCH_RECORDING_HEADER "# CYD-MIDI touch recording v1"
+#define TOUCH_RECORDING_LINE 48   // Longest line, with terminator
+
+// One MIDI message as it went out, stamped with its event time
+struct MIDICapture {
+  uint32_t timestampUs;
+  uint8_t length;
+  uint8_t bytes[3];
+};
+
+enum RecordingLineKind : uint8_t {
+  RECORDING_NONE,   // Blank, comment or unreadable
+  RECORDING_TOUCH,
+  RECORDING_MIDI
+};
+
+inline int formatTouchLine(char* out, size_t size, const TouchEvent& event, uint32_t originUs) {
+  static const char types[] = {'P', 'M', 'R'};
+  return snprintf(out, size, "T %lu %c %d %d %u", (unsigned long)(event.timestampUs - originUs),
+                  types[event.type < 3 ? event.type : TOUCH_MOVE], event.x, event.y, event.velocity);
+}
+
+inline int formatMIDILine(char* out, size_t size, const MIDICapture& midi, uint32_t originUs) {
+  int n = snprintf(out, size, "M %lu", (unsigned long)(midi.timestampUs - originUs));
+  for (uint8_t i = 0; i < midi.length && i < 3 && n > 0 && (size_t)n < size; i++) {
+    n += snprintf(out + n, size - n, " %02X", midi.bytes[i]);
+  }
+  return n;
+}
+
+// Times come back relative to the start of the recording
+inline RecordingLineKind parseRecordingLine(const char* line, TouchEvent& touch, MIDICapture& midi) {
+  unsigned long timeUs;
+  if (line[0] == 'T') {
+    char type;
+    int x, y;
+    unsigned velocity;
+    if (sscanf(line + 1, "%lu %c %d %d %u", &timeUs, &type, &x, &y, &velocity) != 5) return RECORDING_NONE;
+    const char* types = "PMR";
+    const char* found = strchr(types, type);
+    if (type == '\0' || !found) return RECORDING_NONE;
+    touch.timestampUs = (uint32_t)timeUs;
+    touch.type = (TouchEventType)(found - types);
+    touch.x = (int16_t)x;
+    touch.y = (int16_t)y;
+    touch.velocity = (uint8_t)velocity;
+    return RECORDING_TOUCH;
+  }
+  if (line[0] == 'M') {
+    unsigned bytes[3];
+    int n = sscanf(line + 1, "%lu %x %x %x", &timeUs, &bytes[0], &bytes[1], &bytes[2]);
+    if (n < 2) return RECORDING_NONE;
+    midi.timestampUs = (uint32_t)timeUs;
+    midi.length = (uint8_t)(n - 1);
+    for (int i = 0; i < 3; i++) midi.bytes[i] = i < n - 1 ? (uint8_t)bytes[i] : 0;
+    return RECORDING_MIDI;
+  }
+  return RECORDING_NONE;
+}
+
+// Hands recorded touch events out again at their original spacing,
+// restamped onto the clock the replay runs against
+class TouchReplay {
+public:
+  TouchReplay() : events(nullptr), count(0), position(0), startUs(0), pressed(false) {}
+
+  // events[] times are relative to the recording start and must outlive the replay
+  void begin(const TouchEvent* recorded, uint32_t n, uint32_t nowUs) {
+    events = recorded;
+    count = n;
+    position = 0;
+    startUs = nowUs;
+    pressed = false;
+  }
+
+  // Next event due by nowUs, if any
+  bool next(uint32_t nowUs, TouchEvent& out) {
+    if (position >= count) return false;
+    if ((int32_t)(nowUs - (startUs + events[position].timestampUs)) < 0) return false;
+    out = events[position++];
+    out.timestampUs += startUs;
+    if (out.type == TOUCH_PRESS) pressed = true;
+    if (out.type == TOUCH_RELEASE) pressed = false;
+    return true;
+  }
+
+  // Ends the replay early; a finger still down is lifted so nothing sticks
+  bool stop(uint32_t nowUs, TouchEvent& release) {
+    bool lift = pressed && position > 0;
+    if (lift) {
+      release = events[position - 1];  // Where the finger was last
+      release.type = TOUCH_RELEASE;
+      release.timestampUs = nowUs;
+    }
+    position = count;
+    pressed = false;
+    return lift;
+  }
+
+  bool finished() const { return position >= count; }
+  uint32_t played() const { return position; }
+  uint32_t total() const { return count; }
+
+private:
+  const TouchEvent* events;
+  uint32_t count;
+  uint32_t position;
+  uint32_t startUs;
+  bool pressed;
+};
+
+#endif // TOUCH_RECORDING_H
@@ -0,0 +1,102 @@
+#include "transport.h"
+#include "common_definitions.h"
+
+Transport::Subscriber Transport::subscribers[TRANSPORT_MAX_SUBSCRIBERS];
+volatile bool Transport::running = false;
+volatile uint32_t Transport::tickCount = 0;
+volatile uint8_t Transport::swing = 50;
+volatile uint8_t Transport::beatsPerBar = 4;
+uint32_t Transport::lastTickUs = 0;
+uint32_t Transport::tickUs = 0;
+bool Transport::haveLastTick = false;
+
+int8_t Transport::subscribe(TransportStepHandler onStep, uint16_t ticksPerStep,
+                            void* context, TransportEventHandler onEvent) {
+  if (!onStep || ticksPerStep == 0) return -1;
+  
+  int8_t slot = -1;
+  for (int8_t i = 0; i < TRANSPORT_MAX_SUBSCRIBERS; i++) {
+    if (subscribers[i].active && subscribers[i].onStep == onStep) {
+      subscribers[i].active = false;  // Re-subscribe: refill the same slot
+      slot = i;
+      break;
+    }
+    if (slot < 0 && !subscribers[i].active) slot = i;
+  }
+  if (slot < 0) return -1;
+  
+  Subscriber& s = subscribers[slot];
+  s.onStep = onStep;
+  s.onEvent = onEvent;
+  s.context = context;
+  s.ticksPerStep = ticksPerStep;
+  s.active = true;
+  return slot;
+}
+
+void Transport::unsubscribe(int8_t id) {
+  if (id >= 0 && id < TRANSPORT_MAX_SUBSCRIBERS) subscribers[id].active = false;
+}
+
+void Transport::unsubscribeAll() {
+  for (int i = 0; i < TRANSPORT_MAX_SUBSCRIBERS; i++) subscribers[i].active = false;
+}
+
+void Transport::setDivision(int8_t id, uint16_t ticksPerStep) {
+  if (id >= 0 && id < TRANSPORT_MAX_SUBSCRIBERS && ticksPerStep > 0) {
+    subscribers[id].ticksPerStep = ticksPerStep;
+  }
+}
+
+void Transport::setSwing(uint8_t percent) {
+  swing = constrain(percent, 50, 75);
+}
+
+void Transport::setBeatsPerBar(uint8_t beats) {
+  if (beats > 0) beatsPerBar = beats;
+}
+
+void Transport::handleTick(uint32_t timeUs) {
+  if (!running) return;
+  
+  // Tick period from the timer itself; before the second tick, from the tempo
+  if (haveLastTick) {
+    tickUs = timeUs - lastTickUs;
+  } else {
+    tickUs = (uint32_t)(60000000.0f / (globalState.bpm * TRANSPORT_PPQN));
+  }
+  lastTickUs = timeUs;
+  haveLastTick = true;
+  
+  uint32_t tick = tickCount;
+  bool isBar = tick % ((uint32_t)TRANSPORT_PPQN * beatsPerBar) == 0;
+  
+  for (int i = 0; i < TRANSPORT_MAX_SUBSCRIBERS; i++) {
+    Subscriber& s = subscribers[i];
+    if (!s.active) continue;
+    uint16_t division = s.ticksPerStep;
+    if (tick % division != 0) continue;
+    
+    TransportTick t;
+    t.tick = tick;
+    t.step = tick / division;
+    t.stepUs = tickUs * division;
+    t.timeUs = timeUs;
+    if (t.step & 1) t.timeUs += (uint32_t)(swing - 50) * t.stepUs / 50;
+    t.isBar = isBar;
+    s.onStep(t, s.context);
+  }
+  
+  tickCount = tick + 1;
+}
+
+void Transport::handleEvent(TransportEvent event) {
+  if (event == TRANSPORT_START) tickCount = 0;
+  running = event != TRANSPORT_STOP;
+  haveLastTick = false;
+  
+  for (int i = 0; i < TRANSPORT_MAX_SUBSCRIBERS; i++) {
+    Subscriber& s = subscribers[i];
+    if (s.active && s.onEvent) s.onEvent(event, s.context);
+  }
+}
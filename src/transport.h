@@ -0,0 +1,80 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stdint.h>
+#include "clock_phase.h"
+
+// Shared transport for every step-based generator
+// - ClockEngine's timer produces TRANSPORT_PPQN ticks; the MIDI task hands
+//   each one to handleTick(), which calls every subscriber whose step
+//   division falls on that tick
+// - Handlers run on the MIDI task (core 1), at the tick's own time. They may
+//   schedule MIDI (MIDIThread::schedule*, scheduleNote) but must not touch
+//   the display - set a flag and redraw from the loop instead
+// - Swing delays every odd step of a subscriber by (swing - 50)% of two
+//   steps; 50 is straight, 66 is a triplet shuffle
+// - subscribe()/unsubscribe() are for the loop task; a slot is filled in
+//   before it is marked active, so the MIDI task never sees a half-written one
+
+#define TRANSPORT_MAX_SUBSCRIBERS 8
+#define TRANSPORT_16TH (TRANSPORT_PPQN / 4)          // 24 ticks
+#define TRANSPORT_16TH_TRIPLET (TRANSPORT_PPQN / 6)  // 16 ticks
+
+struct TransportTick {
+  uint32_t tick;    // Transport ticks since START
+  uint32_t timeUs;  // micros() time this step should sound, swing included
+  uint32_t step;    // Steps of this subscriber's division since START
+  uint32_t stepUs;  // Length of one step at the current tempo
+  bool isBar;       // Step falls on the first tick of a bar
+};
+
+enum TransportEvent {
+  TRANSPORT_START,     // From the top; the next step is step 0
+  TRANSPORT_STOP,
+  TRANSPORT_CONTINUE   // Resumes from the current position
+};
+
+typedef void (*TransportStepHandler)(const TransportTick& tick, void* context);
+typedef void (*TransportEventHandler)(TransportEvent event, void* context);
+
+class Transport {
+public:
+  // Returns a subscriber id, or -1 when all slots are taken. Subscribing the
+  // same step handler again reuses its slot.
+  static int8_t subscribe(TransportStepHandler onStep, uint16_t ticksPerStep,
+                          void* context = nullptr, TransportEventHandler onEvent = nullptr);
+  static void unsubscribe(int8_t id);
+  static void unsubscribeAll();
+  static void setDivision(int8_t id, uint16_t ticksPerStep);
+  
+  static void setSwing(uint8_t percent);  // 50-75
+  static uint8_t getSwing() { return swing; }
+  static void setBeatsPerBar(uint8_t beats);
+  
+  static bool isRunning() { return running; }
+  static uint32_t position() { return tickCount; }
+  
+  // MIDI task only
+  static void handleTick(uint32_t timeUs);
+  static void handleEvent(TransportEvent event);
+  
+private:
+  struct Subscriber {
+    TransportStepHandler onStep;
+    TransportEventHandler onEvent;
+    void* context;
+    volatile uint16_t ticksPerStep;
+    volatile bool active;
+  };
+  
+  static Subscriber subscribers[TRANSPORT_MAX_SUBSCRIBERS];
+  static volatile bool running;
+  static volatile uint32_t tickCount;
+  static volatile uint8_t swing;
+  static volatile uint8_t beatsPerBar;
+  static uint32_t lastTickUs;
+  static uint32_t tickUs;
+  static bool haveLastTick;  // lastTickUs is from this run
+};
+
+#endif // TRANSPORT_H
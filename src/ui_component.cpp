@@ -1,4 +1,5 @@
 #include "ui_component.h"
+#include "ui_manager.h"
 
 // UIComponent implementation
 UIComponent::UIComponent(int x, int y, int w, int h) 
@@ -17,10 +18,12 @@ void UIComponent::setBounds(int x, int y, int w, int h) {
   bounds.y = y;
   bounds.w = w;
   bounds.h = h;
+  UIManager::invalidateIndex();
 }
 
 void UIComponent::setBounds(const Rect& newBounds) {
   bounds = newBounds;
+  UIManager::invalidateIndex();
 }
 
 void UIComponent::debugDraw() {
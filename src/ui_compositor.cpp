@@ -0,0 +1,58 @@
+#include "ui_compositor.h"
+
+UICompositor::Layer UICompositor::layers[UI_COMPOSITOR_MAX_LAYERS];
+uint8_t UICompositor::layerCount = 0;
+DirtyRegions UICompositor::dirty(SCREEN_WIDTH, SCREEN_HEIGHT);
+uint16_t UICompositor::background = THEME_BG;
+uint32_t UICompositor::frameBudgetUs = 0;
+uint32_t UICompositor::paintedPixels = 0;
+
+void UICompositor::reset(uint16_t bg) {
+  layerCount = 0;
+  dirty.clear();
+  background = bg;
+}
+
+int8_t UICompositor::addLayer(int x, int y, int w, int h, UIPaintFunction paint) {
+  if (layerCount >= UI_COMPOSITOR_MAX_LAYERS || !paint) return -1;
+  layers[layerCount] = {{(int16_t)x, (int16_t)y, (int16_t)w, (int16_t)h}, paint};
+  return layerCount++;
+}
+
+void UICompositor::invalidate(int x, int y, int w, int h) {
+  dirty.add(x, y, w, h);
+}
+
+void UICompositor::invalidateLayer(int8_t layer) {
+  if (layer < 0 || layer >= layerCount) return;
+  const DirtyRect& r = layers[layer].bounds;
+  dirty.add(r.x, r.y, r.w, r.h);
+}
+
+void UICompositor::invalidateAll() {
+  dirty.addAll();
+}
+
+void UICompositor::repaint(const DirtyRect& region) {
+  // Painters draw as if for the whole screen; the viewport drops what
+  // falls outside the region before it reaches the panel
+  tft.setViewport(region.x, region.y, region.w, region.h, false);
+  tft.fillRect(region.x, region.y, region.w, region.h, background);
+  for (uint8_t i = 0; i < layerCount; i++) {
+    if (layers[i].bounds.intersects(region)) layers[i].paint();
+  }
+  tft.resetViewport();
+  paintedPixels += region.area();
+}
+
+void UICompositor::update() {
+  paintedPixels = 0;
+  if (dirty.isEmpty()) return;
+
+  uint32_t start = micros();
+  DirtyRect region;
+  while (dirty.pop(region)) {
+    repaint(region);
+    if (frameBudgetUs && micros() - start >= frameBudgetUs) break;  // The rest next pass
+  }
+}
@@ -0,0 +1,53 @@
+#ifndef UI_COMPOSITOR_H
+#define UI_COMPOSITOR_H
+
+#include "common_definitions.h"
+#include "dirty_regions.h"
+
+// Incremental repaint of the parts of a screen that changed
+// - A screen registers layers: a rectangle and the function that paints it
+//   (the same one its full draw uses), bottom layer first
+// - When state changes, the screen invalidates a layer or a rectangle
+//   instead of drawing the whole screen again
+// - update() runs once per loop() pass. For each merged dirty region it
+//   clips the panel to the region (setViewport), fills the background and
+//   runs the painters of the layers that reach into it, in order
+// - With a frame budget, regions left when it runs out wait for the next pass
+// A screen's full draw calls reset() before adding its layers; drawMenu()
+// resets too, so layers never outlive their screen. Loop task only.
+
+#define UI_COMPOSITOR_MAX_LAYERS 12
+
+typedef void (*UIPaintFunction)();
+
+class UICompositor {
+public:
+  static void reset(uint16_t background = THEME_BG);  // No layers, nothing pending
+  static int8_t addLayer(int x, int y, int w, int h, UIPaintFunction paint);  // -1 when full
+
+  static void invalidate(int x, int y, int w, int h);
+  static void invalidateLayer(int8_t layer);
+  static void invalidateAll();
+
+  static void setFrameBudget(uint32_t us) { frameBudgetUs = us; }  // 0 = no limit
+  static void update();
+  static bool isPending() { return !dirty.isEmpty(); }
+  static uint32_t lastPaintedPixels() { return paintedPixels; }  // By the last update()
+
+private:
+  struct Layer {
+    DirtyRect bounds;
+    UIPaintFunction paint;
+  };
+
+  static Layer layers[UI_COMPOSITOR_MAX_LAYERS];
+  static uint8_t layerCount;
+  static DirtyRegions dirty;
+  static uint16_t background;
+  static uint32_t frameBudgetUs;
+  static uint32_t paintedPixels;
+
+  static void repaint(const DirtyRect& region);
+};
+
+#endif // UI_COMPOSITOR_H
@@ -3,6 +3,8 @@
 
 #include "common_definitions.h"
 #include "touch_calibration.h"
+#include "touch_recorder.h"
+#include "latency_trace.h"
 
 // UI function declarations
 void updateTouch();
@@ -92,66 +94,60 @@ public:
 };
 
 // UI implementations
+
+// Next event from the touch task - or from a replay, which stands in for it
+// until it ends or a real press stops it. Everything taken is recorded.
+inline bool nextTouchEvent(TouchEvent& event) {
+  if (TouchRecorder::isReplaying()) {
+    TouchEvent live;
+    while (TouchThread::popEvent(live)) {
+      if (live.type == TOUCH_PRESS) {
+        TouchRecorder::stopReplay();
+        break;
+      }
+    }
+  }
+  bool got = TouchRecorder::popReplay(event);
+  if (!got && !TouchRecorder::isReplaying() && TouchThread::popEvent(event)) {
+    LatencyTrace::touchTaken(event.timestampUs);  // Live touches only
+    got = true;
+  }
+  if (got) TouchRecorder::record(event);
+  return got;
+}
+
 inline void updateTouch() {
-  extern TouchCalibration calibration;
-  
+  // Fold the touch task's events into the touch state. At most one press or
+  // release is taken per call, so a tap shorter than a frame still gives one
+  // pass with justPressed and the next with justReleased.
   touch.wasPressed = touch.isPressed;
-  touch.isPressed = ts.tirqTouched() && ts.touched();
-  touch.justPressed = touch.isPressed && !touch.wasPressed;
-  touch.justReleased = !touch.isPressed && touch.wasPressed;
+  touch.justPressed = false;
+  touch.justReleased = false;
   
-  if (touch.isPressed) {
-    TS_Point p = ts.getPoint();
-    uint16_t rawX = p.x;
-    uint16_t rawY = p.y;
-    
-    // Debug: print raw values even if calibration invalid
-    static unsigned long lastDebug = 0;
-    if (millis() - lastDebug > 500) {
-      Serial.printf("[TOUCH] Raw: (%d,%d) CalibValid: %d\n", rawX, rawY, calibration.valid);
-      lastDebug = millis();
-    }
-    
-    if (!calibration.valid) return;
-    
-    // Apply XY swap if calibrated that way
-    if (calibration.swap_xy) {
-      uint16_t temp = rawX;
-      rawX = rawY;
-      rawY = temp;
+  // The gesture recognizer sees the same events; its callback runs with
+  // touch already updated
+  TouchRecorder::update();
+  TouchEvent event;
+  while (nextTouchEvent(event)) {
+    touch.x = event.x;
+    touch.y = event.y;
+    touch.timestampUs = event.timestampUs;
+    if (event.type == TOUCH_PRESS) {
+      touch.isPressed = true;
+      touch.justPressed = true;
+      touch.velocity = event.velocity;
+      gestures.press(event.x, event.y, event.timestampUs);
+      break;
     }
-    
-    // Map using calibrated values to screen dimensions
-    int mappedX = map(rawX, calibration.x_min, calibration.x_max, 0, SCREEN_WIDTH);
-    int mappedY = map(rawY, calibration.y_min, calibration.y_max, 0, SCREEN_HEIGHT);
-    
-    // Apply rotation (default to 0 if not set)
-    uint8_t rot = calibration.rotation;
-    if (rot > 3) rot = 0;  // Safety check
-    
-    switch (rot) {
-      case 0:  // No rotation
-        touch.x = mappedX;
-        touch.y = mappedY;
-        break;
-      case 1:  // 90° clockwise
-        touch.x = SCREEN_HEIGHT - mappedY;
-        touch.y = mappedX;
-        break;
-      case 2:  // 180°
-        touch.x = SCREEN_WIDTH - mappedX;
-        touch.y = SCREEN_HEIGHT - mappedY;
-        break;
-      case 3:  // 270° clockwise (90° counter-clockwise)
-        touch.x = mappedY;
-        touch.y = SCREEN_WIDTH - mappedX;
-        break;
+    if (event.type == TOUCH_RELEASE) {
+      touch.isPressed = false;
+      touch.justReleased = true;
+      gestures.release(event.x, event.y, event.timestampUs);
+      break;
     }
-    
-    // Constrain to screen bounds
-    touch.x = constrain(touch.x, 0, SCREEN_WIDTH - 1);
-    touch.y = constrain(touch.y, 0, SCREEN_HEIGHT - 1);
+    gestures.move(event.x, event.y, event.timestampUs);
   }
+  gestures.update(micros());
 }
 
 inline bool isButtonPressed(int x, int y, int w, int h) {
@@ -4,9 +4,15 @@
 std::vector<UIComponent*> UIManager::components;
 TouchState UIManager::lastProcessedTouch;
 bool UIManager::debugMode = false;
+UIComponent* UIManager::activeComponent = nullptr;
+std::vector<uint16_t> UIManager::cellStart;
+std::vector<uint16_t> UIManager::cellItems;
+bool UIManager::indexDirty = true;
 
 void UIManager::init() {
   components.clear();
+  activeComponent = nullptr;
+  indexDirty = true;
   lastProcessedTouch = TouchState();
   debugMode = false;
   Serial.println("[UIManager] Initialized");
@@ -18,12 +24,15 @@ void UIManager::clearMode() {
     delete component;
   }
   components.clear();
+  activeComponent = nullptr;
+  indexDirty = true;
   Serial.println("[UIManager] Cleared all components");
 }
 
 void UIManager::registerComponent(UIComponent* component) {
   if (component) {
     components.push_back(component);
+    indexDirty = true;
   }
 }
 
@@ -38,20 +47,76 @@ void UIManager::registerSlider(UISlider* slider) {
 void UIManager::processEvents() {
   extern TouchState touch; // Access global touch state
   
-  // Process events for all registered components
-  // Check in reverse order (top to bottom in z-order)
-  for (auto it = components.rbegin(); it != components.rend(); ++it) {
-    UIComponent* component = *it;
-    
-    if (component->checkEvent(touch)) {
-      // Component handled the event, stop propagation
-      break;
-    }
+  // Only the component under the finger and the one it just left can change
+  // state; every other component would see "not pressed" again
+  UIComponent* hit = touch.isPressed ? hitTest(touch.x, touch.y) : nullptr;
+  if (activeComponent && activeComponent != hit) {
+    activeComponent->checkEvent(touch);
+  }
+  if (hit) {
+    hit->checkEvent(touch);
   }
+  activeComponent = hit;
   
   lastProcessedTouch = touch;
 }
 
+bool UIManager::cellRange(const Rect& r, int& col0, int& row0, int& col1, int& row1) {
+  // Bounds are inclusive of right()/bottom(), as in Rect::contains
+  col0 = max(r.x, 0) / UI_INDEX_CELL;
+  row0 = max(r.y, 0) / UI_INDEX_CELL;
+  col1 = min(r.right(), SCREEN_WIDTH - 1) / UI_INDEX_CELL;
+  row1 = min(r.bottom(), SCREEN_HEIGHT - 1) / UI_INDEX_CELL;
+  return r.w >= 0 && r.h >= 0 && col0 <= col1 && row0 <= row1;
+}
+
+void UIManager::rebuildIndex() {
+  const int cells = UI_INDEX_COLS * UI_INDEX_ROWS;
+  cellStart.assign(cells + 1, 0);
+  
+  // Count per cell, prefix-sum into start offsets, then fill in z order
+  int col0, row0, col1, row1;
+  for (auto* component : components) {
+    if (!cellRange(component->getBounds(), col0, row0, col1, row1)) continue;
+    for (int row = row0; row <= row1; row++) {
+      for (int col = col0; col <= col1; col++) {
+        cellStart[row * UI_INDEX_COLS + col + 1]++;
+      }
+    }
+  }
+  for (int c = 0; c < cells; c++) {
+    cellStart[c + 1] += cellStart[c];
+  }
+  
+  cellItems.resize(cellStart[cells]);
+  std::vector<uint16_t> fill(cellStart.begin(), cellStart.end() - 1);
+  for (size_t i = 0; i < components.size(); i++) {
+    if (!cellRange(components[i]->getBounds(), col0, row0, col1, row1)) continue;
+    for (int row = row0; row <= row1; row++) {
+      for (int col = col0; col <= col1; col++) {
+        cellItems[fill[row * UI_INDEX_COLS + col]++] = i;
+      }
+    }
+  }
+  
+  indexDirty = false;
+}
+
+UIComponent* UIManager::hitTest(int x, int y) {
+  if (x < 0 || y < 0 || x >= SCREEN_WIDTH || y >= SCREEN_HEIGHT) return nullptr;
+  if (indexDirty) rebuildIndex();
+  
+  // Later registrations draw on top, so walk the cell backwards
+  int cell = (y / UI_INDEX_CELL) * UI_INDEX_COLS + x / UI_INDEX_CELL;
+  for (int i = cellStart[cell + 1] - 1; i >= (int)cellStart[cell]; i--) {
+    UIComponent* component = components[cellItems[i]];
+    if (component->isEnabled() && component->isVisible() && component->contains(x, y)) {
+      return component;
+    }
+  }
+  return nullptr;
+}
+
 void UIManager::drawAll(bool force) {
   for (auto* component : components) {
     component->draw(force);
@@ -64,13 +129,25 @@ void UIManager::drawAll(bool force) {
 
 bool UIManager::checkOverlaps() {
   bool hasOverlaps = false;
+  if (indexDirty) rebuildIndex();
   
-  for (size_t i = 0; i < components.size(); i++) {
-    for (size_t j = i + 1; j < components.size(); j++) {
-      if (components[i]->overlaps(*components[j])) {
-        Serial.printf("[UIManager] WARNING: Overlap detected between components %d and %d\n", i, j);
+  // Only components sharing a cell can overlap. Each pair is reported from
+  // the one cell holding the top-left corner of their intersection.
+  const int cells = UI_INDEX_COLS * UI_INDEX_ROWS;
+  for (int cell = 0; cell < cells; cell++) {
+    for (int a = cellStart[cell]; a < cellStart[cell + 1]; a++) {
+      for (int b = a + 1; b < cellStart[cell + 1]; b++) {
+        size_t i = cellItems[a];
+        size_t j = cellItems[b];
+        if (!components[i]->overlaps(*components[j])) continue;
+        
         Rect bounds1 = components[i]->getBounds();
         Rect bounds2 = components[j]->getBounds();
+        int cornerX = constrain(max(bounds1.x, bounds2.x), 0, SCREEN_WIDTH - 1);
+        int cornerY = constrain(max(bounds1.y, bounds2.y), 0, SCREEN_HEIGHT - 1);
+        if ((cornerY / UI_INDEX_CELL) * UI_INDEX_COLS + cornerX / UI_INDEX_CELL != cell) continue;
+        
+        Serial.printf("[UIManager] WARNING: Overlap detected between components %d and %d\n", i, j);
         Serial.printf("  Component %d: (%d,%d) %dx%d\n", i, bounds1.x, bounds1.y, bounds1.w, bounds1.h);
         Serial.printf("  Component %d: (%d,%d) %dx%d\n", j, bounds2.x, bounds2.y, bounds2.w, bounds2.h);
         hasOverlaps = true;
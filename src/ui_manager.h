@@ -6,6 +6,15 @@
 #include "ui_slider.h"
 #include <vector>
 
+// Hit-test index: the screen is split into UI_INDEX_CELL px square cells and
+// each cell lists the components whose bounds reach into it, in
+// registration (z) order. A touch only looks at the components of its own
+// cell. The index is rebuilt on the first lookup after a component is
+// registered or moved (setBounds), never per touch.
+#define UI_INDEX_CELL 32
+#define UI_INDEX_COLS ((SCREEN_WIDTH + UI_INDEX_CELL - 1) / UI_INDEX_CELL)
+#define UI_INDEX_ROWS ((SCREEN_HEIGHT + UI_INDEX_CELL - 1) / UI_INDEX_CELL)
+
 class UIManager {
 public:
   // Lifecycle
@@ -20,6 +29,12 @@ public:
   // Event processing (called from main loop after updateTouch())
   static void processEvents();
   
+  // Topmost enabled, visible component at (x, y), or nullptr
+  static UIComponent* hitTest(int x, int y);
+  
+  // Called by UIComponent::setBounds
+  static void invalidateIndex() { indexDirty = true; }
+  
   // Drawing (call after mode initialization)
   static void drawAll(bool force = false);
   
@@ -34,6 +49,17 @@ private:
   static std::vector<UIComponent*> components;
   static TouchState lastProcessedTouch;
   static bool debugMode;
+  
+  // Component under the finger on the previous pass; it still gets the
+  // event that moves the finger off it (release, slider leave)
+  static UIComponent* activeComponent;
+  
+  // Cell c holds cellItems[cellStart[c] .. cellStart[c + 1]), component indices
+  static std::vector<uint16_t> cellStart;
+  static std::vector<uint16_t> cellItems;
+  static bool indexDirty;
+  static void rebuildIndex();
+  static bool cellRange(const Rect& r, int& col0, int& row0, int& col1, int& row1);
 };
 
 #endif // UI_MANAGER_H
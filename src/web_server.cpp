@@ -4,6 +4,10 @@
 
 #include "web_server.h"
 #include "common_definitions.h"
+#include "touch_recorder.h"
+#include "generator_bench.h"
+#include "latency_trace.h"
+#include "ui_elements.h"  // exitToMenu
 
 WebServer server(WEB_SERVER_PORT);
 bool wifiEnabled = false;
@@ -187,6 +191,9 @@ void initializeWebServer() {
   server.on("/screenshots", HTTP_GET, handleScreenshots);
   server.on("/wifi", HTTP_GET, handleWiFiGet);
   server.on("/wifi", HTTP_POST, handleWiFiPost);
+  server.on("/touch", HTTP_GET, handleTouchRecording);
+  server.on("/bench", HTTP_GET, handleBench);
+  server.on("/latency", HTTP_GET, handleLatency);
   server.onNotFound(handleNotFound);
   
   server.begin();
@@ -526,6 +533,68 @@ void handleWiFiPost() {
   }
 }
 
+// Recording names become file names in /recordings, so no path characters
+static bool isRecordingName(const String &name) {
+  for (size_t i = 0; i < name.length(); i++) {
+    char c = name[i];
+    if (!isalnum(c) && c != '_' && c != '-') return false;
+  }
+  return true;
+}
+
+// /touch?action=record                  start recording touches and MIDI
+// /touch?action=stop&name=N              save it as /recordings/N.txt
+// /touch?action=replay&name=N[&save=M]   replay N (recording the run as M)
+// /touch?action=cancel                   drop a recording / stop a replay
+void handleTouchRecording() {
+  String action = server.arg("action");
+  String name = server.hasArg("name") ? server.arg("name") : "touch";
+  String save = server.arg("save");
+  
+  if (!isRecordingName(name) || !isRecordingName(save)) {
+    server.send(400, "text/plain", "Names may only use letters, digits, _ and -");
+    return;
+  }
+  
+  if (action == "record") {
+    if (TouchRecorder::startRecording()) server.send(200, "text/plain", "Recording");
+    else server.send(500, "text/plain", "Not enough memory to record");
+  } else if (action == "stop") {
+    if (TouchRecorder::stopRecording(name.c_str())) server.send(200, "text/plain", "Saved " + name);
+    else server.send(500, "text/plain", "Not recording, or SD card write failed");
+  } else if (action == "replay") {
+    if (TouchRecorder::startReplay(name.c_str(), save.length() ? save.c_str() : nullptr)) {
+      server.send(200, "text/plain", "Replaying " + name);
+    } else {
+      server.send(404, "text/plain", "Could not load " + name);
+    }
+  } else if (action == "cancel") {
+    TouchRecorder::stopReplay();
+    TouchRecorder::cancelRecording();
+    server.send(200, "text/plain", "Stopped");
+  } else {
+    server.send(400, "text/plain", "action must be record, stop, replay or cancel");
+  }
+}
+
+void handleBench() {
+  // The drawing routines draw over the current screen; ?draw=0 skips them
+  bool draw = server.arg("draw") != "0";
+  if (!GeneratorBench::run(draw)) {
+    server.send(409, "text/plain", "Stop playback first");
+    return;
+  }
+  server.send(200, "application/json", GeneratorBench::toJSON());
+  if (draw) exitToMenu();
+}
+
+void handleLatency() {
+  // Also printed over serial; ?reset=1 starts the histograms over afterwards
+  LatencyTrace::printReport();
+  server.send(200, "application/json", LatencyTrace::toJSON());
+  if (server.arg("reset") == "1") LatencyTrace::reset();
+}
+
 void handleNotFound() {
   server.send(404, "text/plain", "404: Not Found");
 }
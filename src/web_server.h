@@ -41,6 +41,9 @@ void handleScreenshot();
 void handleScreenshots();
 void handleWiFiGet();
 void handleWiFiPost();
+void handleTouchRecording();
+void handleBench();
+void handleLatency();
 void handleNotFound();
 
 // WiFi config helpers